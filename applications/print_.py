@@ -19,9 +19,11 @@ def add_subparser(subparsers):
     return parser
 
 def print_(inputs, print_header, decode_uids):
-    for input in inputs:
+    # Read the files in the background, print them in order
+    reader = odil.BatchReader(ordered=True)
+    reader.start(inputs)
+    for input, header, data_set in reader:
         logging.info("Printing {}".format(input))
-        header, data_set = odil.read(input)
 
         max_length = find_max_name_length(data_set)
         if print_header:
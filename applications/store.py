@@ -56,8 +56,10 @@ def store(host, port, calling_ae_title, called_ae_title, filenames):
     
     store = odil.StoreSCU(association)
     
-    for filename in filenames:
-        _, data_set = odil.read(filename)
+    # Read the next files in the background while storing
+    reader = odil.BatchReader(ordered=True)
+    reader.start(filenames)
+    for filename, _, data_set in reader:
         
         try:
             store.set_affected_sop_class(data_set)
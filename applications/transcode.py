@@ -45,6 +45,19 @@ def transcode(input, output, format, transfer_syntax, pretty_print):
     globals()["as_{}".format(format)](input, output, **kwargs)
 
 def as_binary(input, output, transfer_syntax):
+    if transfer_syntax and odil.is_transcodable(transfer_syntax):
+        # Only read the meta-information to get the input transfer syntax
+        header, _ = odil.read(input, halt_condition=lambda tag: True)
+        input_transfer_syntax = header.as_string(
+            odil.registry.TransferSyntaxUID)[0]
+        if odil.is_transcodable(input_transfer_syntax):
+            # Stream the elements, without reading the whole data set
+            logging.debug(
+                "Transcoding from {} to {}".format(
+                    input_transfer_syntax, transfer_syntax))
+            odil.transcode(input, output, transfer_syntax)
+            return
+
     _, data_set = odil.read(input)
     odil.write(data_set, output, transfer_syntax=transfer_syntax)
 
@@ -11,12 +11,16 @@
 #include <algorithm>
 #include <functional>
 #include <map>
+#include <memory>
+#include <ostream>
+#include <streambuf>
 #include <string>
 #include <vector>
 
 #include "odil/AssociationParameters.h"
 #include "odil/DataSet.h"
 #include "odil/Exception.h"
+#include "odil/IncrementalReader.h"
 #include "odil/uid.h"
 #include "odil/dul/StateMachine.h"
 #include "odil/message/Message.h"
@@ -33,9 +37,66 @@
 #include "odil/pdu/RoleSelection.h"
 #include "odil/pdu/UserIdentityRQ.h"
 #include "odil/pdu/UserInformation.h"
-#include "odil/Reader.h"
 #include "odil/Writer.h"
 
+namespace
+{
+
+/// @brief Stream buffer appending to a string.
+class StringSink: public std::streambuf
+{
+public:
+    StringSink(std::string & string)
+    : _string(string)
+    {
+        // Nothing else
+    }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if(c != traits_type::eof())
+        {
+            this->_string.push_back(traits_type::to_char_type(c));
+        }
+        return c;
+    }
+
+    std::streamsize xsputn(char const * data, std::streamsize size) override
+    {
+        this->_string.append(data, size);
+        return size;
+    }
+
+private:
+    std::string & _string;
+};
+
+/**
+ * @brief Encode a data set in a string whose size is known beforehand, so
+ * that the encoded data set is neither reallocated nor copied.
+ */
+std::string encode(
+    odil::DataSet const & data_set, std::string const & transfer_syntax,
+    bool use_group_length)
+{
+    std::string buffer;
+    StringSink sink(buffer);
+    std::ostream stream(&sink);
+    odil::Writer const writer(
+        stream, transfer_syntax, odil::Writer::ItemEncoding::ExplicitLength,
+        use_group_length);
+
+    // Compute the lengths once, to allocate the buffer and to write.
+    auto const lengths = writer.get_lengths(data_set);
+    buffer.reserve(lengths.size);
+    writer.write_data_set(data_set, lengths);
+
+    return buffer;
+}
+
+}
+
 namespace odil
 {
 
@@ -367,13 +428,15 @@ Association
 ::receive_message()
 {
     bool done = false;
-    int presentation_context_id;
     bool command_set_received=false;
     bool has_data_set=true;
     bool data_set_received=false;
 
     DataSet command_set;
-    std::stringstream command_stream, data_stream;
+
+    // Data sets are parsed as their fragments are received
+    IncrementalReader command_reader(registry::ImplicitVRLittleEndian);
+    std::unique_ptr<IncrementalReader> data_reader;
 
     while(!done)
     {
@@ -404,21 +467,33 @@ Association
 
         for(auto const & pdv: p_data_tf->get_pdv_items())
         {
-            presentation_context_id = pdv.get_presentation_context_id();
+            auto const presentation_context_id =
+                pdv.get_presentation_context_id();
             bool & received =
                 pdv.is_command()?command_set_received:data_set_received;
             received |= pdv.is_last_fragment();
 
             auto const & fragment_data = pdv.get_fragment();
 
-            std::stringstream  & stream =
-                pdv.is_command()?command_stream:data_stream;
-            stream.write(&fragment_data[0], fragment_data.size());
+            if(!pdv.is_command() && data_reader == nullptr)
+            {
+                auto const transfer_syntax_it =
+                    this->_transfer_syntaxes_by_id.find(presentation_context_id);
+                if(transfer_syntax_it == this->_transfer_syntaxes_by_id.end())
+                {
+                    throw Exception("No such Presentation Context ID");
+                }
+                data_reader.reset(
+                    new IncrementalReader(transfer_syntax_it->second));
+            }
+
+            IncrementalReader & reader =
+                pdv.is_command()?command_reader:*data_reader;
+            reader.feed(fragment_data.data(), fragment_data.size());
 
             if(command_set_received && command_set.empty())
             {
-                Reader reader(command_stream, registry::ImplicitVRLittleEndian);
-                command_set = reader.read_data_set();
+                command_set = command_reader.finish();
                 auto const value =
                     command_set.as_int(registry::CommandDataSetType, 0);
 
@@ -434,15 +509,7 @@ Association
 
     if(has_data_set)
     {
-        auto const transfer_syntax_it =
-            this->_transfer_syntaxes_by_id.find(presentation_context_id);
-        if(transfer_syntax_it == this->_transfer_syntaxes_by_id.end())
-        {
-            throw Exception("No such Presentation Context ID");
-        }
-
-        Reader reader(data_stream, transfer_syntax_it->second);
-        auto data_set = reader.read_data_set();
+        auto data_set = data_reader->finish();
 
         return message::Message(std::move(command_set), std::move(data_set));
     }
@@ -474,22 +541,16 @@ Association
 
     std::vector<pdu::PDataTF::PresentationDataValueItem> pdv_items;
 
-    std::ostringstream command_stream;
-    Writer command_writer(
-        command_stream, registry::ImplicitVRLittleEndian, // implicit vr for command
-        Writer::ItemEncoding::ExplicitLength, true); // true for Command
-    command_writer.write_data_set(message.get_command_set());
-    auto const command_buffer = command_stream.str();
+    auto const command_buffer = encode(
+        message.get_command_set(),
+        registry::ImplicitVRLittleEndian, // implicit vr for command
+        true); // true for Command
     pdv_items.emplace_back(id, 3, command_buffer);
 
     if (message.has_data_set())
     {
-        std::ostringstream data_stream;
-        Writer data_writer(
-            data_stream, transfer_syntax,
-            Writer::ItemEncoding::ExplicitLength, false);
-        data_writer.write_data_set(message.get_data_set());
-        auto const data_buffer = data_stream.str();
+        auto const data_buffer = encode(
+            message.get_data_set(), transfer_syntax, false);
 
         auto const max_length = this->_negotiated_parameters.get_maximum_length();
         auto current_length = command_buffer.size() + 12; // 12 is the size of all that is added on top of the fragment
@@ -511,7 +572,7 @@ Association
             if (available > 0) // Send some data with the command set
             {
                 remaining -= available;
-                pdv_items.emplace_back(transfer_syntax_it->second.first, (remaining > 0 ? 0 : 2), data_buffer.substr(0, available));
+                pdv_items.emplace_back(transfer_syntax_it->second.first, (remaining > 0 ? 0 : 2), data_buffer, 0, available);
                 offset += available;
             }
 
@@ -525,7 +586,7 @@ Association
             {
                 remaining -= available;
                 pdv_items.clear();
-                pdv_items.emplace_back(transfer_syntax_it->second.first, (remaining > 0 ? 0 : 2), data_buffer.substr(offset, available));
+                pdv_items.emplace_back(transfer_syntax_it->second.first, (remaining > 0 ? 0 : 2), data_buffer, offset, available);
                 offset += available;
                 pdu->set_pdv_items(pdv_items);
                 this->_state_machine.send_pdu(data);
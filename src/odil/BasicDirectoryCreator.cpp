@@ -9,6 +9,7 @@
 #include "odil/BasicDirectoryCreator.h"
 
 #include <algorithm>
+#include <exception>
 #include <fstream>
 #include <iterator>
 #include <map>
@@ -22,9 +23,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 
+#include "odil/BatchReader.h"
 #include "odil/DataSet.h"
 #include "odil/Exception.h"
-#include "odil/Reader.h"
 #include "odil/registry.h"
 #include "odil/Tag.h"
 #include "odil/uid.h"
@@ -84,18 +85,32 @@ BasicDirectoryCreator
 {
     RecordMap patients;
 
-    for(auto const & file: files)
+    std::vector<std::string> absolute_paths;
+    absolute_paths.reserve(this->files.size());
+    for(auto const & file: this->files)
     {
         auto const absolute_path = boost::filesystem::path(this->root)/file;
         if(!boost::filesystem::is_regular_file(absolute_path))
         {
             throw Exception("No such file: "+absolute_path.string());
         }
+        absolute_paths.push_back(absolute_path.string());
+    }
+
+    // Parse the files in parallel, but build the records in the order of
+    // the files. The values of the records are copied from the files, which
+    // may be modified while the records exist.
+    BatchReader reader(0, true);
+    reader.share_memory = false;
+    reader.read(absolute_paths, [&](BatchReader::Result & result)
+    {
+        if(result.error)
+        {
+            std::rethrow_exception(result.error);
+        }
 
-        boost::filesystem::ifstream stream(
-            absolute_path, std::ifstream::in | std::ifstream::binary);
-        auto const meta_info_and_data_set = Reader::read_file(stream);
-        auto const & data_set = meta_info_and_data_set.second;
+        auto const & file = this->files[result.index];
+        auto const & data_set = result.data_set;
 
         auto const & patient_id = data_set.as_string(
             registry::PatientID)[0];
@@ -156,12 +171,12 @@ BasicDirectoryCreator
                 registry::ReferencedSOPInstanceUIDInFile,
                 data_set[registry::SOPInstanceUID]);
 
-            auto const & meta_info = meta_info_and_data_set.first;
+            auto const & meta_info = result.header;
             image.data_set.add(
                 registry::ReferencedTransferSyntaxUIDInFile,
                 meta_info[registry::TransferSyntaxUID]);
         }
-    }
+    });
 
     return patients;
 }
@@ -395,7 +410,7 @@ BasicDirectoryCreator
 
     std::ostringstream buffer;
     Writer buffer_writer(
-        buffer, meta_information.as_string(registry::TransferSyntaxUID)[0],
+        buffer, meta_information.as_string(registry::TransferSyntaxUID, 0),
         this->item_encoding);
     buffer_writer.write_data_set(meta_information);
     buffer_writer.write_data_set(basic_directory);
@@ -0,0 +1,228 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/BatchReader.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "odil/DataSet.h"
+#include "odil/Reader.h"
+#include "odil/Tag.h"
+
+namespace odil
+{
+
+BatchReader::Result
+::Result()
+: path(), index(0), header(), data_set(), error()
+{
+    // Nothing else.
+}
+
+BatchReader
+::BatchReader(unsigned int threads_count, bool ordered)
+: threads_count(threads_count), queue_size(0), ordered(ordered),
+    keep_group_length(false),
+    halt_condition([](Tag const &) { return false; }),
+    deferred_threshold(0), share_memory(false), projection(nullptr),
+    _stopped(true), _queue_size(0), _next_path(0), _delivered(0),
+    _waiting(0)
+{
+    // Nothing else.
+}
+
+BatchReader
+::~BatchReader()
+{
+    this->stop();
+}
+
+void
+BatchReader
+::read(std::vector<std::string> const & paths, Callback const & callback)
+{
+    this->start(paths);
+
+    Result result;
+    try
+    {
+        while(this->next(result))
+        {
+            callback(result);
+        }
+    }
+    catch(...)
+    {
+        this->stop();
+        throw;
+    }
+}
+
+void
+BatchReader
+::start(std::vector<std::string> const & paths)
+{
+    this->stop();
+
+    unsigned int threads_count = this->threads_count;
+    if(threads_count == 0)
+    {
+        threads_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads_count = std::min<std::size_t>(threads_count, paths.size());
+
+    {
+        // Calls to next in other threads read the state
+        std::lock_guard<std::mutex> lock(this->_mutex);
+
+        this->_paths = paths;
+        this->_next_path = 0;
+        this->_delivered = 0;
+        this->_results.clear();
+        this->_stopped = false;
+
+        // Default queue size: enough to keep all the threads busy
+        this->_queue_size =
+            (this->queue_size != 0)?this->queue_size:(2*threads_count);
+    }
+
+    for(unsigned int i=0; i<threads_count; ++i)
+    {
+        this->_workers.emplace_back(&BatchReader::_work, this);
+    }
+}
+
+bool
+BatchReader
+::next(Result & result)
+{
+    std::unique_lock<std::mutex> lock(this->_mutex);
+
+    if(this->_stopped || this->_delivered == this->_paths.size())
+    {
+        return false;
+    }
+
+    auto const is_available = [this]() {
+        return this->ordered
+            ?(this->_results.find(this->_delivered) != this->_results.end())
+            :!this->_results.empty();
+    };
+    ++this->_waiting;
+    this->_result_available.wait(
+        lock, [&]() { return this->_stopped || is_available(); });
+    --this->_waiting;
+    if(this->_stopped)
+    {
+        // Let stop return once no call is waiting
+        this->_result_available.notify_all();
+        return false;
+    }
+
+    auto const iterator = this->ordered
+        ?this->_results.find(this->_delivered):this->_results.begin();
+    result = std::move(iterator->second);
+    this->_results.erase(iterator);
+    ++this->_delivered;
+
+    lock.unlock();
+    this->_slot_available.notify_one();
+
+    return true;
+}
+
+void
+BatchReader
+::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_stopped = true;
+        this->_slot_available.notify_all();
+        this->_result_available.notify_all();
+
+        // Wake the calls to next waiting in other threads, so that the reader
+        // may be destroyed as soon as this returns
+        this->_result_available.wait(
+            lock, [this]() { return this->_waiting == 0; });
+    }
+
+    for(auto & worker: this->_workers)
+    {
+        worker.join();
+    }
+    this->_workers.clear();
+
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_results.clear();
+}
+
+void
+BatchReader
+::_work()
+{
+    while(true)
+    {
+        std::size_t index;
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            // In ordered mode, this also bounds the number of results
+            // waiting for an earlier one.
+            this->_slot_available.wait(
+                lock, [this]() {
+                    return
+                        this->_stopped
+                        || this->_next_path == this->_paths.size()
+                        || this->_next_path < this->_delivered+this->_queue_size; });
+            if(this->_stopped || this->_next_path == this->_paths.size())
+            {
+                break;
+            }
+            index = this->_next_path;
+            ++this->_next_path;
+        }
+
+        Result result;
+        result.path = this->_paths[index];
+        result.index = index;
+        try
+        {
+            auto header_and_data_set = (this->projection != nullptr)
+                ?Reader::read_file(
+                    result.path, *this->projection, this->keep_group_length,
+                    this->halt_condition, this->deferred_threshold,
+                    this->share_memory)
+                :Reader::read_file(
+                    result.path, this->keep_group_length,
+                    this->halt_condition, this->deferred_threshold,
+                    this->share_memory);
+            result.header = std::move(header_and_data_set.first);
+            result.data_set = std::move(header_and_data_set.second);
+        }
+        catch(...)
+        {
+            result.error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_results.insert(std::make_pair(index, std::move(result)));
+        }
+        this->_result_available.notify_all();
+    }
+}
+
+}
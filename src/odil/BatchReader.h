@@ -0,0 +1,159 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _70d1c7ca_8196_41c2_884d_0afb2feb78f1
+#define _70d1c7ca_8196_41c2_884d_0afb2feb78f1
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "odil/DataSet.h"
+#include "odil/odil.h"
+#include "odil/Projection.h"
+#include "odil/Tag.h"
+
+namespace odil
+{
+
+/**
+ * @brief Read DICOM files on a pool of threads.
+ *
+ * The results are delivered to the calling thread, either through a callback
+ * (read) or one by one (start and next). At most queue_size files are read
+ * and not yet delivered at any time.
+ */
+class ODIL_API BatchReader
+{
+public:
+    /// @brief Content of a file, or error raised while reading it.
+    struct Result
+    {
+        /// @brief Path to the file.
+        std::string path;
+
+        /// @brief Position of the file in the list of paths.
+        std::size_t index;
+
+        /// @brief Meta-information header of the file.
+        DataSet header;
+
+        /// @brief Data set of the file.
+        DataSet data_set;
+
+        /// @brief Exception raised while reading the file, null on success.
+        std::exception_ptr error;
+
+        /// @brief Create an empty result.
+        Result();
+    };
+
+    /// @brief Function called for each result.
+    typedef std::function<void(Result &)> Callback;
+
+    /// @brief Number of reading threads, 0 to use all the cores.
+    unsigned int threads_count;
+
+    /// @brief Maximum number of files read and not yet delivered.
+    std::size_t queue_size;
+
+    /// @brief Deliver the results in the order of the paths.
+    bool ordered;
+
+    /// @brief Flag to keep or discard group length tags.
+    bool keep_group_length;
+
+    /**
+     * @brief Condition to stop reading each file, cf. Reader::read_file. It
+     * is called concurrently by the reading threads.
+     */
+    std::function<bool(Tag const &)> halt_condition;
+
+    /// @brief Minimal length of deferred binary values, cf. Reader::read_file.
+    std::size_t deferred_threshold;
+
+    /**
+     * @brief Whether values share the memory of the mapped files, cf.
+     * Reader::read_file.
+     */
+    bool share_memory;
+
+    /// @brief Elements to read, null to read all elements.
+    std::shared_ptr<Projection const> projection;
+
+    /**
+     * @brief Constructor, results are delivered in completion order by
+     * default.
+     */
+    BatchReader(unsigned int threads_count=0, bool ordered=false);
+
+    /**
+     * @brief Destructor, stop the reading threads. A call to next waiting in
+     * another thread returns false before the destruction.
+     */
+    ~BatchReader();
+
+    BatchReader(BatchReader const &) =delete;
+    BatchReader & operator=(BatchReader const &) =delete;
+
+    /// @brief Read the files and call the callback for each result.
+    void read(std::vector<std::string> const & paths, Callback const & callback);
+
+    /// @brief Start reading files, stopping any previous reading.
+    void start(std::vector<std::string> const & paths);
+
+    /**
+     * @brief Wait for the next result: return false if all results have
+     * already been delivered or if the reading is stopped.
+     */
+    bool next(Result & result);
+
+    /**
+     * @brief Stop reading files, discarding the results not yet delivered.
+     * Calls to next waiting in other threads return false.
+     */
+    void stop();
+
+private:
+    std::vector<std::string> _paths;
+    std::vector<std::thread> _workers;
+
+    std::mutex _mutex;
+    /**
+     * @brief Signaled when a result is available, when stopping, and when a
+     * call to next returns after stopping.
+     */
+    std::condition_variable _result_available;
+    /// @brief Signaled when a result has been delivered or when stopping.
+    std::condition_variable _slot_available;
+
+    bool _stopped;
+    /// @brief Effective value of queue_size.
+    std::size_t _queue_size;
+    /// @brief Index of the next path to read.
+    std::size_t _next_path;
+    /// @brief Number of delivered results.
+    std::size_t _delivered;
+    /// @brief Number of calls to next waiting for a result.
+    std::size_t _waiting;
+    /// @brief Results not yet delivered, by index.
+    std::map<std::size_t, Result> _results;
+
+    void _work();
+};
+
+}
+
+#endif // _70d1c7ca_8196_41c2_884d_0afb2feb78f1
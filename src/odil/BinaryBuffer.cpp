@@ -0,0 +1,263 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/BinaryBuffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "odil/Exception.h"
+
+namespace odil
+{
+
+std::size_t const BinaryBuffer::alignment;
+
+BinaryBuffer
+::BinaryBuffer()
+: _data(), _size(0), _capacity(0), _offsets()
+{
+    // Nothing else
+}
+
+BinaryBuffer
+::BinaryBuffer(std::size_t size)
+: BinaryBuffer()
+{
+    this->add_fragment(size);
+}
+
+BinaryBuffer
+::BinaryBuffer(Fragments const & fragments)
+: BinaryBuffer()
+{
+    std::size_t size = 0;
+    for(auto const & fragment: fragments)
+    {
+        size += fragment.size();
+    }
+    this->_reallocate(size);
+
+    for(auto const & fragment: fragments)
+    {
+        auto const data = this->add_fragment(fragment.size());
+        if(!fragment.empty())
+        {
+            std::memcpy(data, &fragment[0], fragment.size());
+        }
+    }
+}
+
+BinaryBuffer
+::BinaryBuffer(
+    std::shared_ptr<uint8_t const> const & data, std::size_t size,
+    std::vector<std::size_t> const & offsets)
+: _data(data), _size(size), _capacity(0), _offsets(offsets)
+{
+    if(!std::is_sorted(this->_offsets.begin(), this->_offsets.end())
+        || (!this->_offsets.empty() && this->_offsets.back() > size))
+    {
+        throw Exception("Invalid fragment offsets");
+    }
+}
+
+BinaryBuffer
+::BinaryBuffer(BinaryBuffer && other)
+: _data(std::move(other._data)), _size(other._size),
+    _capacity(other._capacity), _offsets(std::move(other._offsets))
+{
+    other._size = 0;
+    other._capacity = 0;
+    other._offsets.clear();
+}
+
+BinaryBuffer &
+BinaryBuffer
+::operator=(BinaryBuffer && other)
+{
+    if(this != &other)
+    {
+        this->_data = std::move(other._data);
+        this->_size = other._size;
+        this->_capacity = other._capacity;
+        this->_offsets = std::move(other._offsets);
+
+        other._size = 0;
+        other._capacity = 0;
+        other._offsets.clear();
+    }
+    return *this;
+}
+
+bool
+BinaryBuffer
+::empty() const
+{
+    return this->_offsets.empty();
+}
+
+std::size_t
+BinaryBuffer
+::get_fragments_count() const
+{
+    return this->_offsets.size();
+}
+
+std::vector<std::size_t> const &
+BinaryBuffer
+::get_offsets() const
+{
+    return this->_offsets;
+}
+
+std::size_t
+BinaryBuffer
+::size() const
+{
+    return this->_size;
+}
+
+uint8_t const *
+BinaryBuffer
+::data() const
+{
+    return this->_data.get();
+}
+
+uint8_t *
+BinaryBuffer
+::data()
+{
+    if(this->is_shared())
+    {
+        this->_reallocate(this->_size);
+    }
+    // The memory has been allocated by this object and is not shared.
+    return const_cast<uint8_t *>(this->_data.get());
+}
+
+uint8_t const *
+BinaryBuffer
+::get_fragment(std::size_t index) const
+{
+    if(index >= this->_offsets.size())
+    {
+        throw Exception("No such fragment");
+    }
+    return this->_data.get()+this->_offsets[index];
+}
+
+std::size_t
+BinaryBuffer
+::get_fragment_size(std::size_t index) const
+{
+    if(index >= this->_offsets.size())
+    {
+        throw Exception("No such fragment");
+    }
+    auto const end =
+        (index+1 < this->_offsets.size())?this->_offsets[index+1]:this->_size;
+    return end-this->_offsets[index];
+}
+
+uint8_t *
+BinaryBuffer
+::add_fragment(std::size_t size)
+{
+    if(this->is_shared() || this->_size+size > this->_capacity)
+    {
+        // Grow geometrically, so that adding fragments is amortized O(1)
+        this->_reallocate(
+            std::max(this->_size+size, std::max(this->_size, this->_capacity)*2));
+    }
+
+    this->_offsets.push_back(this->_size);
+    this->_size += size;
+
+    return const_cast<uint8_t *>(this->_data.get())+this->_offsets.back();
+}
+
+bool
+BinaryBuffer
+::is_shared() const
+{
+    return (
+        this->_data != nullptr
+        && (this->_capacity == 0 || this->_data.use_count() > 1));
+}
+
+std::shared_ptr<uint8_t const>
+BinaryBuffer
+::get_shared_data() const
+{
+    return this->_data;
+}
+
+BinaryBuffer::Fragments
+BinaryBuffer
+::to_fragments() const
+{
+    Fragments fragments(this->_offsets.size());
+    for(std::size_t i=0; i<this->_offsets.size(); ++i)
+    {
+        auto const begin = this->get_fragment(i);
+        fragments[i].assign(begin, begin+this->get_fragment_size(i));
+    }
+    return fragments;
+}
+
+bool
+BinaryBuffer
+::operator==(BinaryBuffer const & other) const
+{
+    return (
+        this->_offsets == other._offsets && this->_size == other._size
+        && (
+            this->_data == other._data || this->_size == 0
+            || std::memcmp(this->data(), other.data(), this->_size) == 0));
+}
+
+bool
+BinaryBuffer
+::operator!=(BinaryBuffer const & other) const
+{
+    return !(*this == other);
+}
+
+void
+BinaryBuffer
+::_reallocate(std::size_t capacity)
+{
+    if(capacity == 0)
+    {
+        this->_data.reset();
+        this->_capacity = 0;
+        return;
+    }
+
+    // Over-allocate, and point to the aligned part of the block.
+    std::shared_ptr<uint8_t> block(
+        new uint8_t[capacity+alignment-1], std::default_delete<uint8_t[]>());
+    auto const address = reinterpret_cast<std::uintptr_t>(block.get());
+    auto const aligned = reinterpret_cast<uint8_t *>(
+        (address+alignment-1) / alignment * alignment);
+
+    if(this->_size > 0)
+    {
+        std::memcpy(aligned, this->_data.get(), this->_size);
+    }
+
+    this->_data = std::shared_ptr<uint8_t const>(block, aligned);
+    this->_capacity = capacity;
+}
+
+}
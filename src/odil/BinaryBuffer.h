@@ -0,0 +1,137 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _861d434a_ecbb_4e59_8e28_9880ff9de474
+#define _861d434a_ecbb_4e59_8e28_9880ff9de474
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "odil/odil.h"
+
+namespace odil
+{
+
+/**
+ * @brief Binary data stored in a single contiguous buffer, split in
+ * fragments (e.g. the items of encapsulated pixel data) given by their
+ * offsets.
+ *
+ * Copies of a buffer share their data: the data is only copied when a shared
+ * buffer is modified. Memory allocated by the buffer is aligned on
+ * BinaryBuffer::alignment bytes; memory wrapped by the buffer is not copied,
+ * and is never modified.
+ */
+class ODIL_API BinaryBuffer
+{
+public:
+    /// @brief Alignment of the memory allocated by the buffer.
+    static std::size_t const alignment = 64;
+
+    /// @brief Fragments container, as in Value::Binary.
+    typedef std::vector<std::vector<uint8_t>> Fragments;
+
+    /// @brief Create an empty buffer, without fragments.
+    BinaryBuffer();
+
+    /// @brief Create a buffer with a single, uninitialized, fragment.
+    explicit BinaryBuffer(std::size_t size);
+
+    /// @brief Create a buffer from a copy of the fragments.
+    explicit BinaryBuffer(Fragments const & fragments);
+
+    /**
+     * @brief Wrap existing memory: the data is kept alive by the shared
+     * pointer, and is copied if the buffer is modified.
+     */
+    BinaryBuffer(
+        std::shared_ptr<uint8_t const> const & data, std::size_t size,
+        std::vector<std::size_t> const & offsets={0});
+
+    /** @addtogroup default_operations Default class operations
+     * @{
+     */
+    ~BinaryBuffer() =default;
+    BinaryBuffer(BinaryBuffer const &) =default;
+    BinaryBuffer & operator=(BinaryBuffer const &) =default;
+    /// @}
+
+    /// @brief Move the data of other, leave it empty.
+    BinaryBuffer(BinaryBuffer && other);
+
+    /// @brief Move the data of other, leave it empty.
+    BinaryBuffer & operator=(BinaryBuffer && other);
+
+    /// @brief Test whether the buffer has no fragments.
+    bool empty() const;
+
+    /// @brief Return the number of fragments.
+    std::size_t get_fragments_count() const;
+
+    /// @brief Return the offsets of the fragments.
+    std::vector<std::size_t> const & get_offsets() const;
+
+    /// @brief Return the total size of the fragments, in bytes.
+    std::size_t size() const;
+
+    /// @brief Return the data.
+    uint8_t const * data() const;
+
+    /// @brief Return the data, copy it first if it is shared.
+    uint8_t * data();
+
+    /// @brief Return the data of a fragment.
+    uint8_t const * get_fragment(std::size_t index) const;
+
+    /// @brief Return the size of a fragment, in bytes.
+    std::size_t get_fragment_size(std::size_t index) const;
+
+    /**
+     * @brief Add an uninitialized fragment at the end of the buffer and
+     * return its data, which is valid until the buffer is modified.
+     */
+    uint8_t * add_fragment(std::size_t size);
+
+    /// @brief Test whether the data is shared with other buffers or owners.
+    bool is_shared() const;
+
+    /**
+     * @brief Return the data, kept alive by the returned pointer: the buffer
+     * then copies it before modifying it.
+     */
+    std::shared_ptr<uint8_t const> get_shared_data() const;
+
+    /// @brief Return a copy of the fragments.
+    Fragments to_fragments() const;
+
+    /// @brief Equality test.
+    bool operator==(BinaryBuffer const & other) const;
+
+    /// @brief Difference test.
+    bool operator!=(BinaryBuffer const & other) const;
+
+private:
+    std::shared_ptr<uint8_t const> _data;
+
+    /// @brief Total size of the fragments.
+    std::size_t _size;
+
+    /// @brief Size of the allocated memory, 0 if the memory is wrapped.
+    std::size_t _capacity;
+
+    std::vector<std::size_t> _offsets;
+
+    /// @brief Copy the data to a new, unshared, memory block.
+    void _reallocate(std::size_t capacity);
+};
+
+}
+
+#endif // _861d434a_ecbb_4e59_8e28_9880ff9de474
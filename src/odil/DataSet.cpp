@@ -8,42 +8,144 @@
 
 #include "odil/DataSet.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <map>
+#include <memory>
+#include <new>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "odil/Exception.h"
+#include "odil/hash.h"
 #include "odil/Tag.h"
 #include "odil/VR.h"
 
 namespace odil
 {
 
+/// @brief Make sure that one more item can be added without reallocation.
+template<typename T>
+void reserve_one(std::vector<T> & container)
+{
+    if(container.size() == container.capacity())
+    {
+        container.reserve(std::max<std::size_t>(8, 2*container.size()));
+    }
+}
+
 DataSet
 ::DataSet(std::string const & transfer_syntax)
-: _transfer_syntax(transfer_syntax)
+: _tags(), _items(), _chunks(), _chunk_size(0), _chunk_capacity(0),
+    _free_slots(), _transfer_syntax(transfer_syntax), _exposed(false),
+    _has_hash(false), _hash(0)
 {
     // Nothing else.
 }
 
+DataSet
+::~DataSet()
+{
+    this->_destroy();
+}
+
+DataSet
+::DataSet(DataSet && other) noexcept
+: _tags(std::move(other._tags)), _items(std::move(other._items)),
+    _chunks(std::move(other._chunks)), _chunk_size(other._chunk_size),
+    _chunk_capacity(other._chunk_capacity),
+    _free_slots(std::move(other._free_slots)),
+    _transfer_syntax(std::move(other._transfer_syntax)),
+    _exposed(other._exposed), _has_hash(other._has_hash.load()),
+    _hash(other._hash.load())
+{
+    // The elements are owned by the chunks, which keep their addresses.
+    other._tags.clear();
+    other._items.clear();
+    other._chunks.clear();
+    other._chunk_size = 0;
+    other._chunk_capacity = 0;
+    other._free_slots.clear();
+    other._exposed = false;
+    other._has_hash = false;
+}
+
+DataSet
+::DataSet(DataSet const & other)
+: DataSet(other._transfer_syntax)
+{
+    // Store all the elements in a single chunk
+    this->_tags.reserve(other._tags.size());
+    this->_items.reserve(other._items.size());
+    for(auto const item: other._items)
+    {
+        this->_insert(this->_items.size(), item->first, item->second);
+    }
+
+    // The copied elements have the same hash
+    this->_hash = other._hash.load();
+    this->_has_hash = other._has_hash.load();
+}
+
+DataSet &
+DataSet
+::operator=(DataSet && other) noexcept
+{
+    if(this != &other)
+    {
+        this->_destroy();
+
+        this->_tags = std::move(other._tags);
+        this->_items = std::move(other._items);
+        this->_chunks = std::move(other._chunks);
+        this->_chunk_size = other._chunk_size;
+        this->_chunk_capacity = other._chunk_capacity;
+        this->_free_slots = std::move(other._free_slots);
+        this->_transfer_syntax = std::move(other._transfer_syntax);
+        this->_exposed = other._exposed;
+        this->_has_hash = other._has_hash.load();
+        this->_hash = other._hash.load();
+
+        other._tags.clear();
+        other._items.clear();
+        other._chunks.clear();
+        other._chunk_size = 0;
+        other._chunk_capacity = 0;
+        other._free_slots.clear();
+        other._exposed = false;
+        other._has_hash = false;
+    }
+    return *this;
+}
+
+DataSet &
+DataSet
+::operator=(DataSet const & other)
+{
+    if(this != &other)
+    {
+        // Copy first, so that the data set is unchanged if the copy fails
+        DataSet copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
 void
 DataSet
 ::add(Tag const & tag, Element const & element)
 {
-    auto const iterator = this->_elements.find(tag);
-    if(iterator == this->_elements.end())
+    this->_has_hash = false;
+    auto const position = this->_lower_bound(tag);
+    if(position == this->_tags.size() || this->_tags[position] != tag)
     {
-        // WARNING: std::map<K,V>::emplace does not exist on old compilers.
-        // This is however a case of non-mandatory copy elision, so the copy
-        // constructor of element should only be called once.
-        this->_elements.insert(std::make_pair(tag, element));
-        //this->_elements.emplace(tag, element);
+        this->_insert(position, tag, element);
     }
     else
     {
-        iterator->second = element;
+        this->_items[position]->second = element;
     }
 }
 
@@ -51,16 +153,15 @@ void
 DataSet
 ::add(Tag const & tag, Element && element)
 {
-    auto const iterator = this->_elements.find(tag);
-    if(iterator == this->_elements.end())
+    this->_has_hash = false;
+    auto const position = this->_lower_bound(tag);
+    if(position == this->_tags.size() || this->_tags[position] != tag)
     {
-        // WARNING: std::map<K,V>::emplace does not exist on old compilers.
-        this->_elements.insert(std::make_pair(tag, std::move(element)));
-        //this->_elements.emplace(tag, std::move(element));
+        this->_insert(position, tag, std::move(element));
     }
     else
     {
-        iterator->second = element;
+        this->_items[position]->second = std::move(element);
     }
 }
 
@@ -151,52 +252,52 @@ void
 DataSet
 ::remove(Tag const & tag)
 {
-    if(!this->has(tag))
+    auto const position = this->_lower_bound(tag);
+    if(position == this->_tags.size() || this->_tags[position] != tag)
     {
         throw Exception("No such element " + std::string( tag ));
     }
 
-    this->_elements.erase(tag);
+    auto const item = this->_items[position];
+    // Reserve first, so that the data set is unchanged if this fails
+    reserve_one(this->_free_slots);
+    this->_has_hash = false;
+    this->_tags.erase(this->_tags.begin()+position);
+    this->_items.erase(this->_items.begin()+position);
+    item->~Item();
+    this->_free_slots.push_back(item);
 }
 
 bool
 DataSet
 ::empty() const
 {
-    return this->_elements.empty();
+    return this->_tags.empty();
 }
 
 std::size_t
 DataSet
 ::size() const
 {
-    return this->_elements.size();
+    return this->_tags.size();
 }
 
 Element const &
 DataSet
 ::operator[](Tag const & tag) const
 {
-    ElementMap::const_iterator const it = this->_elements.find(tag);
-    if(it == this->_elements.end())
-    {
-        throw Exception("No such element " + std::string( tag ));
-    }
-
-    return it->second;
+    return this->_get(tag).second;
 }
 
 Element &
 DataSet
 ::operator[](Tag const & tag)
 {
-    ElementMap::iterator it = this->_elements.find(tag);
-    if(it == this->_elements.end())
-    {
-        throw Exception("No such element " + std::string( tag ));
-    }
-
-    return it->second;
+    auto & element = this->_get(tag).second;
+    // The element may be modified through the returned reference
+    this->_exposed = true;
+    this->_has_hash = false;
+    return element;
 }
 
 template<typename TContainer>
@@ -350,71 +451,107 @@ DataSet
     return at_pos(as_binary(tag), position);
 }
 
+BinaryBuffer const &
+DataSet
+::as_binary_buffer(Tag const & tag) const
+{
+    return (*this)[tag].as_binary_buffer();
+}
+
+BinaryBuffer &
+DataSet
+::as_binary_buffer(Tag const & tag)
+{
+    return (*this)[tag].as_binary_buffer();
+}
+
 bool
 DataSet
 ::has(Tag const & tag) const
 {
-    return (this->_elements.find(tag) != this->_elements.end());
+    return (this->_find(tag) != nullptr);
 }
 
 VR
 DataSet
 ::get_vr(Tag const & tag) const
 {
-    ElementMap::const_iterator const it = this->_elements.find(tag);
-    if(it == this->_elements.end())
-    {
-        throw Exception("No such element "+  std::string(tag) );
-    }
-
-    return it->second.vr;
+    return this->_get(tag).second.vr;
 }
 
 bool
 DataSet
 ::empty(Tag const & tag) const
 {
-    ElementMap::const_iterator const it = this->_elements.find(tag);
-    if(it == this->_elements.end())
-    {
-        throw Exception("No such element " + std::string( tag ) );
-    }
-
-    return it->second.empty();
+    return this->_get(tag).second.empty();
 }
 
 std::size_t
 DataSet
 ::size(Tag const & tag) const
 {
-    ElementMap::const_iterator const it = this->_elements.find(tag);
-    if(it == this->_elements.end())
-    {
-        throw Exception("No such element " + std::string( tag ));
-    }
-
-    return it->second.size();
+    return this->_get(tag).second.size();
 }
 
 DataSet::const_iterator
 DataSet
 ::begin() const
 {
-    return this->_elements.begin();
+    return const_iterator(this->_items.begin());
 }
 
 DataSet::const_iterator
 DataSet
 ::end() const
 {
-    return this->_elements.end();
+    return const_iterator(this->_items.end());
+}
+
+uint64_t
+DataSet
+::get_hash() const
+{
+    if(this->_has_hash.load(std::memory_order_acquire))
+    {
+        return this->_hash.load(std::memory_order_relaxed);
+    }
+
+    auto hash = hash_seed;
+    for(auto const item: this->_items)
+    {
+        auto const & tag = item->first;
+        hash = hash_combine(
+            hash, (static_cast<uint64_t>(tag.group) << 16) | tag.element);
+        hash = hash_combine(hash, item->second.get_hash());
+    }
+
+    // The elements cannot change behind our back unless exposed
+    if(!this->_exposed)
+    {
+        this->_hash.store(hash, std::memory_order_relaxed);
+        this->_has_hash.store(true, std::memory_order_release);
+    }
+
+    return hash;
 }
 
 bool
 DataSet
 ::operator==(DataSet const & other) const
 {
-    return (this->_elements == other._elements);
+    if(
+        this->_has_hash && other._has_hash && this->_hash != other._hash)
+    {
+        // Different hashes: no need to compare the elements
+        return false;
+    }
+
+    return (
+        this->_tags == other._tags
+        && std::equal(
+            this->_items.begin(), this->_items.end(), other._items.begin(),
+            [](Item const * x, Item const * y) {
+                return x->second == y->second; }));
 }
 
 bool
@@ -428,13 +565,8 @@ void
 DataSet
 ::clear(Tag const & tag)
 {
-    ElementMap::iterator const it = this->_elements.find(tag);
-    if(it == this->_elements.end())
-    {
-        throw Exception("No such element: "+std::string(tag));
-    }
-
-    it->second.clear();
+    this->_get(tag).second.clear();
+    this->_has_hash = false;
 }
 
 std::string const &
@@ -451,4 +583,104 @@ DataSet
     this->_transfer_syntax = transfer_syntax;
 }
 
+std::size_t
+DataSet
+::_lower_bound(Tag const & tag) const
+{
+    // Fast path: elements are usually added in ascending order.
+    if(this->_tags.empty() || this->_tags.back() < tag)
+    {
+        return this->_tags.size();
+    }
+
+    return
+        std::lower_bound(this->_tags.begin(), this->_tags.end(), tag)
+        - this->_tags.begin();
+}
+
+DataSet::Item *
+DataSet
+::_find(Tag const & tag) const
+{
+    auto const position = this->_lower_bound(tag);
+    if(position != this->_tags.size() && this->_tags[position] == tag)
+    {
+        return this->_items[position];
+    }
+    else
+    {
+        return nullptr;
+    }
+}
+
+DataSet::Item &
+DataSet
+::_get(Tag const & tag) const
+{
+    auto const item = this->_find(tag);
+    if(item == nullptr)
+    {
+        throw Exception("No such element " + std::string(tag));
+    }
+    return *item;
+}
+
+template<typename ... Args>
+void
+DataSet
+::_insert(std::size_t position, Tag const & tag, Args && ... args)
+{
+    // Reserve first, so that the insertions cannot fail
+    reserve_one(this->_tags);
+    reserve_one(this->_items);
+
+    Item * item;
+    if(!this->_free_slots.empty())
+    {
+        item = new(this->_free_slots.back()) Item(
+            std::piecewise_construct, std::forward_as_tuple(tag),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+        this->_free_slots.pop_back();
+    }
+    else
+    {
+        if(this->_chunk_size == this->_chunk_capacity)
+        {
+            // Grow geometrically, starting with the reserved capacity
+            auto const capacity = std::max<std::size_t>(
+                {8, this->_tags.capacity()-this->_tags.size(),
+                    this->_tags.size()});
+            std::unique_ptr<Slot[]> chunk(new Slot[capacity]);
+            this->_chunks.push_back(std::move(chunk));
+            this->_chunk_size = 0;
+            this->_chunk_capacity = capacity;
+        }
+        item = new(&this->_chunks.back()[this->_chunk_size]) Item(
+            std::piecewise_construct, std::forward_as_tuple(tag),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+        ++this->_chunk_size;
+    }
+
+    this->_tags.insert(this->_tags.begin()+position, tag);
+    this->_items.insert(this->_items.begin()+position, item);
+}
+
+void
+DataSet
+::_destroy() noexcept
+{
+    for(auto const item: this->_items)
+    {
+        item->~Item();
+    }
+    this->_tags.clear();
+    this->_items.clear();
+    this->_chunks.clear();
+    this->_chunk_size = 0;
+    this->_chunk_capacity = 0;
+    this->_free_slots.clear();
+    this->_exposed = false;
+    this->_has_hash = false;
+}
+
 }
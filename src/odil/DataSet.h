@@ -9,13 +9,20 @@
 #ifndef _8424446e_1153_4acc_9f57_e86faa7246e3
 #define _8424446e_1153_4acc_9f57_e86faa7246e3
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <initializer_list>
-#include <map>
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include <boost/iterator/indirect_iterator.hpp>
+
+#include "odil/BinaryBuffer.h"
 #include "odil/Element.h"
 #include "odil/odil.h"
 #include "odil/Value.h"
@@ -25,6 +32,15 @@ namespace odil
 
 /**
  * @brief DICOM Data set.
+ *
+ * The tags are stored in a contiguous array sorted by tag, searched by
+ * bisection; adding elements in ascending order only appends to it. The
+ * elements are stored in chunks, each holding many elements, and never move.
+ *
+ * Unlike a std::map, adding an element which is not yet in the data set or
+ * removing an element invalidates all the iterators. Replacing the value of
+ * an existing element (e.g. add with an existing tag) does not. The
+ * references to the elements remain valid until they are removed.
  */
 class ODIL_API DataSet
 {
@@ -35,13 +51,17 @@ public:
     /** @addtogroup default_operations Default class operations
      * @{
      */
-    ~DataSet() =default;
-    DataSet(DataSet const &) =default;
-    DataSet(DataSet &&) =default;
-    DataSet & operator=(DataSet const &) =default;
-    DataSet & operator=(DataSet &&) =default;
+    ~DataSet();
+    DataSet(DataSet && other) noexcept;
+    DataSet & operator=(DataSet && other) noexcept;
     /// @}
 
+    /// @brief Copy the elements of other.
+    DataSet(DataSet const & other);
+
+    /// @brief Copy the elements of other.
+    DataSet & operator=(DataSet const & other);
+
     /// @brief Add an element to the dataset.
     void add(Tag const & tag, Element const & element);
 
@@ -195,8 +215,28 @@ public:
     Value::Binary::value_type const &
     as_binary(Tag const & tag, unsigned int position) const;
 
-    /// @brief Iterator to the elements.
-    typedef std::map<Tag, Element>::const_iterator const_iterator;
+    /**
+     * @brief Return the binary data contained in an existing element, as a
+     * contiguous buffer (read-only).
+     */
+    BinaryBuffer const & as_binary_buffer(Tag const & tag) const;
+
+    /**
+     * @brief Return the binary data contained in an existing element, as a
+     * contiguous buffer (read-write).
+     */
+    BinaryBuffer & as_binary_buffer(Tag const & tag);
+
+    /// @brief Element and its tag.
+    typedef std::pair<Tag const, Element> Item;
+
+    /**
+     * @brief Iterator to the elements, as (tag, element) pairs, sorted by
+     * tag.
+     */
+    typedef boost::indirect_iterator<
+            std::vector<Item *>::const_iterator, Item const
+        > const_iterator;
 
     /// @brief Return an iterator to the start of the elements.
     const_iterator begin() const;
@@ -204,6 +244,16 @@ public:
     /// @brief Return an iterator to the end of the elements.
     const_iterator end() const;
 
+    /**
+     * @brief Return a hash of the elements: equal data sets have equal
+     * hashes. The transfer syntax is not part of the hash.
+     *
+     * The hash is computed from the memoized hashes of the values, cf.
+     * Value::get_hash. It is itself memoized until the data set is modified,
+     * unless a non-const reference to one of its elements has been returned.
+     */
+    uint64_t get_hash() const;
+
     /// @brief Equality test.
     bool operator==(DataSet const & other) const;
 
@@ -220,12 +270,75 @@ public:
     void set_transfer_syntax(std::string const & transfer_syntax);
 
 private:
-    typedef std::map<Tag, Element> ElementMap;
+    /// @brief Uninitialized storage for one element.
+    typedef std::aligned_storage<sizeof(Item), alignof(Item)>::type Slot;
+
+    /// @brief Tags of the elements, sorted.
+    std::vector<Tag> _tags;
+
+    /// @brief Elements, in the same order as the tags.
+    std::vector<Item *> _items;
+
+    /// @brief Storage of the elements.
+    std::vector<std::unique_ptr<Slot[]>> _chunks;
+
+    /// @brief Number of slots used in the last chunk.
+    std::size_t _chunk_size;
 
-    ElementMap _elements;
+    /// @brief Number of slots in the last chunk.
+    std::size_t _chunk_capacity;
+
+    /// @brief Slots of the removed elements, reused by the next additions.
+    std::vector<Item *> _free_slots;
 
     /// @brief Current transfer syntax.
     std::string _transfer_syntax;
+
+    /**
+     * @brief Whether a non-const reference to an element has been returned:
+     * the hash of the elements may not be memoized anymore.
+     */
+    bool _exposed;
+
+    /// @brief Whether the hash of the elements is memoized.
+    mutable std::atomic<bool> _has_hash;
+
+    /// @brief Memoized hash of the elements.
+    mutable std::atomic<uint64_t> _hash;
+
+    /// @brief Return the position of the first tag not before tag.
+    std::size_t _lower_bound(Tag const & tag) const;
+
+    /// @brief Return the element matching tag, or null.
+    Item * _find(Tag const & tag) const;
+
+    /// @brief Return the element matching tag, throw an exception if missing.
+    Item & _get(Tag const & tag) const;
+
+    /**
+     * @brief Add a new element at the given position, constructed from the
+     * arguments.
+     */
+    template<typename ... Args>
+    void _insert(std::size_t position, Tag const & tag, Args && ... args);
+
+    /// @brief Destroy all the elements and release their storage.
+    void _destroy() noexcept;
+};
+
+}
+
+namespace std
+{
+
+/// @brief Hash of data sets, to use them as keys of unordered containers.
+template<>
+struct hash<odil::DataSet>
+{
+    std::size_t operator()(odil::DataSet const & data_set) const
+    {
+        return static_cast<std::size_t>(data_set.get_hash());
+    }
 };
 
 }
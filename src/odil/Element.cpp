@@ -8,10 +8,12 @@
 
 #include "odil/Element.h"
 
+#include <cstdint>
 #include <initializer_list>
 #include <utility>
 
 #include "odil/Exception.h"
+#include "odil/hash.h"
 #include "odil/Value.h"
 #include "odil/DataSet.h"
 
@@ -234,6 +236,29 @@ Element::as_binary()
     return this->_value.as_binary();
 }
 
+BinaryBuffer const &
+Element
+::as_binary_buffer() const
+{
+    return this->_value.as_binary_buffer();
+}
+
+BinaryBuffer &
+Element
+::as_binary_buffer()
+{
+    return this->_value.as_binary_buffer();
+}
+
+uint64_t
+Element
+::get_hash() const
+{
+    return hash_combine(
+        hash_combine(hash_seed, static_cast<uint64_t>(this->vr)),
+        this->_value.get_hash());
+}
+
 bool
 Element
 ::operator==(Element const & other) const
@@ -10,8 +10,11 @@
 #define _9c3d8f32_0310_4e3a_b5d2_6d69f229a2cf
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <initializer_list>
 
+#include "odil/BinaryBuffer.h"
 #include "odil/odil.h"
 #include "odil/Tag.h"
 #include "odil/Value.h"
@@ -168,6 +171,25 @@ public:
      */
     Value::Binary & as_binary();
 
+    /**
+     * @brief Return the binary data contained in the element, as a contiguous
+     * buffer.
+     *
+     * If the element does not contain binary data, a odil::Exception is raised.
+     */
+    BinaryBuffer const & as_binary_buffer() const;
+
+    /**
+     * @brief Return the binary data contained in the element, as a contiguous
+     * buffer.
+     *
+     * If the element does not contain binary data, a odil::Exception is raised.
+     */
+    BinaryBuffer & as_binary_buffer();
+
+    /// @brief Return a hash of the element: equal elements have equal hashes.
+    uint64_t get_hash() const;
+
     /// @brief Equality test
     bool operator==(Element const & other) const;
 
@@ -189,6 +211,21 @@ typename TVisitor::result_type
 apply_visitor(TVisitor const & visitor, Element const & element);
 
 
+}
+
+namespace std
+{
+
+/// @brief Hash of elements, to use them as keys of unordered containers.
+template<>
+struct hash<odil::Element>
+{
+    std::size_t operator()(odil::Element const & element) const
+    {
+        return static_cast<std::size_t>(element.get_hash());
+    }
+};
+
 }
 
 #include "odil/Element.txx"
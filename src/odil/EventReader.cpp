@@ -0,0 +1,472 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/EventReader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "odil/DataSet.h"
+#include "odil/Exception.h"
+#include "odil/Reader.h"
+#include "odil/registry.h"
+#include "odil/Tag.h"
+#include "odil/VR.h"
+#include "odil/VRFinder.h"
+
+namespace
+{
+
+uint32_t const undefined_length = 0xffffffff;
+
+/// @brief Parse a stream and report its content to a handler.
+class Parser
+{
+public:
+    Parser(
+        odil::EventReader const & reader, odil::EventReader::Handler & handler)
+    : _reader(reader), _handler(handler),
+        _tag_reader(reader.stream, reader.transfer_syntax),
+        // Small values must fit in one chunk, cf. _update_context
+        _buffer(std::max<std::size_t>(reader.chunk_size, 8)),
+        _context()
+    {
+        // The encoding of the tag reader is the current encoding, cf.
+        // undefined-length UN.
+        this->_tag_reader.byte_ordering = reader.byte_ordering;
+        this->_tag_reader.explicit_vr = reader.explicit_vr;
+    }
+
+    /// @brief Read an element of the data set whose tag has been read.
+    void read_element(odil::Tag const & tag)
+    {
+        this->_read_element(tag, this->_context);
+    }
+
+private:
+    odil::EventReader const & _reader;
+    odil::EventReader::Handler & _handler;
+    odil::Reader _tag_reader;
+    std::vector<char> _buffer;
+
+    /// @brief Elements of the data set used to find implicit VRs.
+    odil::DataSet _context;
+
+    /// @brief Read an element whose tag has been read, return its size.
+    uint64_t _read_element(odil::Tag const & tag, odil::DataSet & context)
+    {
+        uint64_t size = 0;
+
+        odil::VR vr;
+        if(this->_tag_reader.explicit_vr)
+        {
+            this->_read(2);
+            vr = odil::as_vr(std::string(this->_buffer.data(), 2));
+            size += 2;
+        }
+        else
+        {
+            odil::VRFinder const vr_finder;
+            vr = vr_finder(tag, context, this->_tag_reader.transfer_syntax);
+        }
+
+        auto const length = this->_tag_reader.read_length(vr);
+        if(!this->_tag_reader.explicit_vr)
+        {
+            size += 4;
+        }
+        else if(odil::is_binary(vr) || vr == odil::VR::SQ
+            || vr == odil::VR::UC || vr == odil::VR::UR || vr == odil::VR::UT)
+        {
+            // PS 3.5, 7.1.2
+            size += 6;
+        }
+        else
+        {
+            size += 2;
+        }
+
+        if(!this->_reader.keep_group_length && tag.element == 0)
+        {
+            odil::Reader::ignore(this->_reader.stream, length);
+            size += length;
+        }
+        else if(vr == odil::VR::SQ)
+        {
+            this->_handler.begin_sequence(tag, length);
+            size += this->_read_sequence(length);
+            this->_handler.end_sequence(tag);
+        }
+        else if(vr == odil::VR::UN && length == undefined_length)
+        {
+            // UN with undefined length is a sequence whose items and
+            // delimiters are encoded in Implicit VR Little Endian, PS3.5,
+            // 6.2.2
+            auto const transfer_syntax = this->_tag_reader.transfer_syntax;
+            auto const byte_ordering = this->_tag_reader.byte_ordering;
+            auto const explicit_vr = this->_tag_reader.explicit_vr;
+
+            this->_tag_reader.transfer_syntax =
+                odil::registry::ImplicitVRLittleEndian;
+            this->_tag_reader.byte_ordering = odil::ByteOrdering::LittleEndian;
+            this->_tag_reader.explicit_vr = false;
+
+            this->_handler.begin_sequence(tag, length);
+            size += this->_read_sequence(length);
+            this->_handler.end_sequence(tag);
+
+            this->_tag_reader.transfer_syntax = transfer_syntax;
+            this->_tag_reader.byte_ordering = byte_ordering;
+            this->_tag_reader.explicit_vr = explicit_vr;
+        }
+        else if(length == undefined_length)
+        {
+            this->_handler.begin_element(tag, vr, length);
+            size += this->_read_fragments();
+            this->_handler.end_element(tag);
+        }
+        else
+        {
+            this->_handler.begin_element(tag, vr, length);
+            this->_read_value(length);
+            this->_update_context(tag, vr, length, context);
+            this->_handler.end_element(tag);
+            size += length;
+        }
+
+        return size;
+    }
+
+    /// @brief Read the items of a sequence, return their size.
+    uint64_t _read_sequence(uint32_t length)
+    {
+        uint64_t size = 0;
+        while(length == undefined_length || size < length)
+        {
+            auto const tag = this->_tag_reader.read_tag();
+            auto const item_length = odil::Reader::read_binary<uint32_t>(
+                this->_reader.stream, this->_tag_reader.byte_ordering);
+            size += 8;
+
+            if(tag == odil::registry::Item)
+            {
+                this->_handler.begin_item(item_length);
+                size += this->_read_item(item_length);
+                this->_handler.end_item();
+            }
+            else if(
+                length == undefined_length
+                && tag == odil::registry::SequenceDelimitationItem)
+            {
+                break;
+            }
+            else
+            {
+                throw odil::Exception("Expected Item, got: "+std::string(tag));
+            }
+        }
+
+        return size;
+    }
+
+    /// @brief Read the elements of an item, return their size.
+    uint64_t _read_item(uint32_t length)
+    {
+        odil::DataSet context;
+
+        uint64_t size = 0;
+        while(length == undefined_length || size < length)
+        {
+            auto const tag = this->_tag_reader.read_tag();
+            size += 4;
+            if(length == undefined_length
+                && tag == odil::registry::ItemDelimitationItem)
+            {
+                odil::Reader::ignore(this->_reader.stream, 4);
+                size += 4;
+                break;
+            }
+            size += this->_read_element(tag, context);
+        }
+
+        return size;
+    }
+
+    /// @brief Read the fragments of encapsulated pixel data, return their size.
+    uint64_t _read_fragments()
+    {
+        uint64_t size = 0;
+        while(true)
+        {
+            auto const tag = this->_tag_reader.read_tag();
+            auto const item_length = odil::Reader::read_binary<uint32_t>(
+                this->_reader.stream, this->_tag_reader.byte_ordering);
+            size += 8;
+
+            if(tag == odil::registry::Item)
+            {
+                this->_handler.begin_item(item_length);
+                this->_read_value(item_length);
+                this->_handler.end_item();
+                size += item_length;
+            }
+            else if(tag == odil::registry::SequenceDelimitationItem)
+            {
+                break;
+            }
+            else
+            {
+                throw odil::Exception(
+                    "Expected SequenceDelimitationItem, got: "
+                    +std::string(tag));
+            }
+        }
+
+        return size;
+    }
+
+    /// @brief Report a value by chunks.
+    void _read_value(uint32_t length)
+    {
+        uint32_t remaining = length;
+        while(remaining > 0)
+        {
+            auto const size = std::min<std::size_t>(
+                remaining, this->_buffer.size());
+            this->_read(size);
+            this->_handler.value(this->_buffer.data(), size);
+            remaining -= size;
+        }
+    }
+
+    /// @brief Read data in the buffer.
+    void _read(std::size_t size)
+    {
+        this->_reader.stream.read(this->_buffer.data(), size);
+        if(!this->_reader.stream)
+        {
+            throw odil::Exception("Could not read from stream");
+        }
+    }
+
+    /**
+     * @brief Keep the small integer elements which are required to find the
+     * VR of other elements in implicit VR transfer syntaxes (e.g. Bits
+     * Allocated for Pixel Data).
+     */
+    void _update_context(
+        odil::Tag const & tag, odil::VR vr, uint32_t length,
+        odil::DataSet & context) const
+    {
+        if(this->_tag_reader.explicit_vr || length > 8
+            || (vr != odil::VR::US && vr != odil::VR::SS
+                && vr != odil::VR::UL && vr != odil::VR::SL))
+        {
+            return;
+        }
+
+        // The whole value is still in the buffer
+        auto const item_size =
+            (vr == odil::VR::US || vr == odil::VR::SS)?2:4;
+        odil::Value::Integers value;
+        for(std::size_t i=0; i+item_size<=length; i+=item_size)
+        {
+            auto const data = this->_buffer.data()+i;
+            if(vr == odil::VR::US)
+            {
+                value.push_back(this->_decode<uint16_t>(data));
+            }
+            else if(vr == odil::VR::SS)
+            {
+                value.push_back(this->_decode<int16_t>(data));
+            }
+            else if(vr == odil::VR::UL)
+            {
+                value.push_back(this->_decode<uint32_t>(data));
+            }
+            else
+            {
+                value.push_back(this->_decode<int32_t>(data));
+            }
+        }
+        context.add(tag, std::move(value), vr);
+    }
+
+    /**
+     * @brief Decode an integer from a buffer which may not be suitably
+     * aligned for T.
+     */
+    template<typename T>
+    T _decode(char const * data) const
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return (this->_tag_reader.byte_ordering == odil::ByteOrdering::LittleEndian)
+            ?odil::little_endian_to_host(value)
+            :odil::big_endian_to_host(value);
+    }
+};
+
+}
+
+namespace odil
+{
+
+EventReader::Handler
+::~Handler()
+{
+    // Nothing to do.
+}
+
+void
+EventReader::Handler
+::begin_element(Tag const &, VR, uint32_t)
+{
+    // Nothing to do.
+}
+
+void
+EventReader::Handler
+::value(char const *, std::size_t)
+{
+    // Nothing to do.
+}
+
+void
+EventReader::Handler
+::end_element(Tag const &)
+{
+    // Nothing to do.
+}
+
+void
+EventReader::Handler
+::begin_sequence(Tag const &, uint32_t)
+{
+    // Nothing to do.
+}
+
+void
+EventReader::Handler
+::end_sequence(Tag const &)
+{
+    // Nothing to do.
+}
+
+void
+EventReader::Handler
+::begin_item(uint32_t)
+{
+    // Nothing to do.
+}
+
+void
+EventReader::Handler
+::end_item()
+{
+    // Nothing to do.
+}
+
+EventReader
+::EventReader(
+    std::istream & stream, std::string const & transfer_syntax,
+    bool keep_group_length, std::size_t chunk_size)
+: stream(stream), transfer_syntax(transfer_syntax),
+    byte_ordering(
+        (transfer_syntax==registry::ExplicitVRBigEndian_Retired)?
+        ByteOrdering::BigEndian:ByteOrdering::LittleEndian),
+    explicit_vr(transfer_syntax!=registry::ImplicitVRLittleEndian),
+    keep_group_length(keep_group_length), chunk_size(chunk_size),
+    _has_look_ahead(false)
+{
+    // Nothing else
+}
+
+void
+EventReader
+::read_data_set(
+    Handler & handler, std::function<bool(Tag const &)> halt_condition) const
+{
+    Parser parser(*this, handler);
+
+    bool done = this->_at_end();
+    while(!done)
+    {
+        auto const tag = this->read_tag();
+        if(halt_condition(tag))
+        {
+            this->_unread_tag(tag);
+            break;
+        }
+        parser.read_element(tag);
+        done = this->_at_end();
+    }
+}
+
+Tag
+EventReader
+::read_tag() const
+{
+    if(this->_has_look_ahead)
+    {
+        this->_has_look_ahead = false;
+        return this->_look_ahead;
+    }
+
+    auto const group = Reader::read_binary<uint16_t>(
+        this->stream, this->byte_ordering);
+    auto const element = Reader::read_binary<uint16_t>(
+        this->stream, this->byte_ordering);
+    return Tag(group, element);
+}
+
+DataSet
+EventReader
+::read_file(
+    std::istream & stream, Handler & handler, bool keep_group_length,
+    std::function<bool(Tag const &)> halt_condition, std::size_t chunk_size)
+{
+    auto meta_information = Reader::read_meta_information(
+        stream, keep_group_length);
+
+    EventReader const reader(
+        stream, meta_information.as_string(registry::TransferSyntaxUID, 0),
+        keep_group_length, chunk_size);
+    reader.read_data_set(handler, halt_condition);
+
+    return meta_information;
+}
+
+bool
+EventReader
+::_at_end() const
+{
+    return !this->_has_look_ahead && this->stream.peek() == EOF;
+}
+
+void
+EventReader
+::_unread_tag(Tag const & tag) const
+{
+    this->stream.seekg(-4, std::ios::cur);
+    if(!this->stream)
+    {
+        // Non-seekable stream: keep the tag for the next read.
+        this->stream.clear();
+        this->_look_ahead = tag;
+        this->_has_look_ahead = true;
+    }
+}
+
+}
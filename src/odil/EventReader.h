@@ -0,0 +1,140 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _58a7726c_05a8_4805_bbbe_3a18c54d54ca
+#define _58a7726c_05a8_4805_bbbe_3a18c54d54ca
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+
+#include "odil/DataSet.h"
+#include "odil/endian.h"
+#include "odil/odil.h"
+#include "odil/Tag.h"
+#include "odil/VR.h"
+
+namespace odil
+{
+
+/**
+ * @brief Read DICOM objects from a stream and report their content to a
+ * handler, without building a data set.
+ *
+ * Values are reported as their encoded bytes, in chunks of at most
+ * chunk_size bytes, so that objects of any size are read in constant memory.
+ */
+class ODIL_API EventReader
+{
+public:
+    /**
+     * @brief Receiver of the events, all functions do nothing by default.
+     *
+     * Sequences are reported as begin_sequence, then begin_item and end_item
+     * around the elements of each item, then end_sequence. The fragments of
+     * encapsulated pixel data are reported as items containing values,
+     * between begin_element and end_element.
+     */
+    class ODIL_API Handler
+    {
+    public:
+        virtual ~Handler();
+
+        /**
+         * @brief Start of a non-sequence element; length is 0xffffffff for
+         * encapsulated pixel data.
+         */
+        virtual void begin_element(Tag const & tag, VR vr, uint32_t length);
+
+        /// @brief Chunk of the encoded value of the current element.
+        virtual void value(char const * data, std::size_t size);
+
+        /// @brief End of a non-sequence element.
+        virtual void end_element(Tag const & tag);
+
+        /// @brief Start of a sequence, length may be 0xffffffff.
+        virtual void begin_sequence(Tag const & tag, uint32_t length);
+
+        /// @brief End of a sequence.
+        virtual void end_sequence(Tag const & tag);
+
+        /// @brief Start of an item or fragment, length may be 0xffffffff.
+        virtual void begin_item(uint32_t length);
+
+        /// @brief End of an item or fragment.
+        virtual void end_item();
+    };
+
+    /// @brief Input stream.
+    std::istream & stream;
+
+    /// @brief Transfer syntax used to read the stream.
+    std::string transfer_syntax;
+
+    /// @brief Endianness.
+    ByteOrdering byte_ordering;
+
+    /// @brief Explicit-ness of the Value Representations.
+    bool explicit_vr;
+
+    /// @brief Flag to report or discard group length tags.
+    bool keep_group_length;
+
+    /// @brief Maximum size of the value chunks.
+    std::size_t chunk_size;
+
+    /**
+     * @brief Build a reader, derive byte ordering and explicit-ness of VR
+     * from transfer syntax.
+     */
+    EventReader(
+        std::istream & stream, std::string const & transfer_syntax,
+        bool keep_group_length=false, std::size_t chunk_size=65536);
+
+    /**
+     * @brief Read a data set, until the end of the stream or the halt
+     * condition. The tag which matches the halt condition is put back in
+     * the stream if it is seekable; otherwise it is kept by the reader and
+     * returned by the next call to read_tag, or by the next data set read.
+     */
+    void read_data_set(
+        Handler & handler,
+        std::function<bool(Tag const &)> halt_condition = [](Tag const &) { return false;}) const;
+
+    /// @brief Read a tag, or return the tag kept by the reader.
+    Tag read_tag() const;
+
+    /**
+     * @brief Return the meta-data header stored in the stream, and report
+     * the data set to the handler.
+     */
+    static DataSet read_file(
+        std::istream & stream, Handler & handler,
+        bool keep_group_length=false,
+        std::function<bool(Tag const &)> halt_condition = [](Tag const &) { return false;},
+        std::size_t chunk_size=65536);
+
+private:
+    /// @brief Whether a tag has been read but not consumed.
+    mutable bool _has_look_ahead;
+
+    /// @brief Tag read but not consumed, for non-seekable streams.
+    mutable Tag _look_ahead;
+
+    /// @brief Test whether there is nothing left to read.
+    bool _at_end() const;
+
+    /// @brief Put a tag back in the stream, or keep it for the next read.
+    void _unread_tag(Tag const & tag) const;
+};
+
+}
+
+#endif // _58a7726c_05a8_4805_bbbe_3a18c54d54ca
@@ -0,0 +1,479 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/IncrementalReader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+#include "odil/DataSet.h"
+#include "odil/Element.h"
+#include "odil/endian.h"
+#include "odil/Exception.h"
+#include "odil/Reader.h"
+#include "odil/registry.h"
+#include "odil/Tag.h"
+#include "odil/Value.h"
+#include "odil/VR.h"
+#include "odil/VRFinder.h"
+
+namespace
+{
+
+uint32_t const undefined_length = 0xffffffff;
+
+/// @brief Read-only stream buffer on a string.
+class StringBuffer: public std::streambuf
+{
+public:
+    StringBuffer(std::string const & string)
+    {
+        // The get area is never written to.
+        auto const data = const_cast<char *>(string.data());
+        this->setg(data, data, data+string.size());
+    }
+};
+
+}
+
+namespace odil
+{
+
+IncrementalReader::Frame
+::Frame(
+    Type type, Tag const & tag, VR vr, uint32_t length,
+    std::string const & transfer_syntax)
+: type(type), tag(tag), vr(vr), length(length), consumed(0),
+    data_set(transfer_syntax), items(), fragments()
+{
+    // Nothing else
+}
+
+IncrementalReader
+::IncrementalReader(
+    std::string const & transfer_syntax, bool keep_group_length)
+: transfer_syntax(transfer_syntax),
+    byte_ordering(
+        (transfer_syntax==registry::ExplicitVRBigEndian_Retired)?
+        ByteOrdering::BigEndian:ByteOrdering::LittleEndian),
+    explicit_vr(transfer_syntax!=registry::ImplicitVRLittleEndian),
+    keep_group_length(keep_group_length), keep_encoded_values(false),
+    string_pool(), _frames(), _state(State::Tag), _header(), _tag(),
+    _vr(VR::UNKNOWN), _length(0), _remaining(0), _value(), _binary(), _target(nullptr)
+{
+    this->_frames.emplace_back(
+        Frame::Type::DataSet, Tag(), VR::UNKNOWN, undefined_length,
+        this->transfer_syntax);
+}
+
+void
+IncrementalReader
+::feed(char const * data, std::size_t size)
+{
+    while(size > 0)
+    {
+        std::size_t count;
+        if(this->_state == State::Value || this->_state == State::Fragment)
+        {
+            count = std::min<std::size_t>(size, this->_remaining);
+            if(this->_state == State::Fragment || is_binary(this->_vr))
+            {
+                auto const offset = this->_length-this->_remaining;
+                std::memcpy(this->_target+offset, data, count);
+            }
+            else
+            {
+                this->_value.append(data, count);
+            }
+            this->_remaining -= count;
+        }
+        else
+        {
+            count = std::min(
+                size, this->_header_size()-this->_header.size());
+            this->_header.append(data, count);
+        }
+
+        for(auto & frame: this->_frames)
+        {
+            frame.consumed += count;
+        }
+        data += count;
+        size -= count;
+
+        if(this->_state == State::Value || this->_state == State::Fragment)
+        {
+            if(this->_remaining == 0)
+            {
+                this->_end_value();
+            }
+        }
+        else if(this->_header.size() == this->_header_size())
+        {
+            this->_parse_header();
+        }
+    }
+}
+
+bool
+IncrementalReader
+::is_complete() const
+{
+    return (
+        this->_frames.size() == 1 && this->_state == State::Tag
+        && this->_header.empty());
+}
+
+DataSet const &
+IncrementalReader
+::get_data_set() const
+{
+    return this->_frames[0].data_set;
+}
+
+DataSet
+IncrementalReader
+::finish()
+{
+    if(!this->is_complete())
+    {
+        throw Exception("Incomplete data set");
+    }
+
+    DataSet data_set = std::move(this->_frames[0].data_set);
+    this->_frames[0].data_set = DataSet(this->transfer_syntax);
+    this->_frames[0].consumed = 0;
+
+    return data_set;
+}
+
+std::size_t
+IncrementalReader
+::_header_size() const
+{
+    if(this->_state == State::Tag || this->_state == State::ItemDelimitation)
+    {
+        return 4;
+    }
+    else if(this->_state == State::ItemHeader)
+    {
+        return 8;
+    }
+    else if(!this->explicit_vr)
+    {
+        return 4;
+    }
+    else if(this->_header.size() < 2)
+    {
+        // VR must be read before the size of the length is known
+        return 2;
+    }
+    else
+    {
+        // PS 3.5, 7.1.2
+        auto const vr = as_vr(this->_header.substr(0, 2));
+        return (
+            is_binary(vr)
+            || vr == VR::SQ || vr == VR::UC || vr == VR::UR || vr == VR::UT)
+            ?8:4;
+    }
+}
+
+void
+IncrementalReader
+::_parse_header()
+{
+    auto const header = this->_header.data();
+
+    if(this->_state == State::Tag)
+    {
+        this->_tag = Tag(
+            this->_decode<uint16_t>(header),
+            this->_decode<uint16_t>(header+2));
+
+        auto const & frame = this->_frames.back();
+        if(this->_tag == registry::ItemDelimitationItem
+            && frame.type == Frame::Type::Item
+            && frame.length == undefined_length)
+        {
+            this->_state = State::ItemDelimitation;
+        }
+        else
+        {
+            if(!this->explicit_vr)
+            {
+                VRFinder const vr_finder;
+                this->_vr = vr_finder(
+                    this->_tag, frame.data_set, this->transfer_syntax);
+            }
+            this->_state = State::Header;
+        }
+        this->_header.clear();
+    }
+    else if(this->_state == State::Header)
+    {
+        if(this->explicit_vr)
+        {
+            this->_vr = as_vr(this->_header.substr(0, 2));
+            this->_length =
+                (this->_header.size() == 8)
+                ?this->_decode<uint32_t>(header+4)
+                :this->_decode<uint16_t>(header+2);
+        }
+        else
+        {
+            this->_length = this->_decode<uint32_t>(header);
+        }
+        this->_header.clear();
+
+        this->_begin_element();
+    }
+    else if(this->_state == State::ItemHeader)
+    {
+        Tag const tag(
+            this->_decode<uint16_t>(header),
+            this->_decode<uint16_t>(header+2));
+        auto const length = this->_decode<uint32_t>(header+4);
+        this->_header.clear();
+
+        auto const & frame = this->_frames.back();
+        if(tag == registry::Item)
+        {
+            if(frame.type == Frame::Type::Sequence)
+            {
+                this->_frames.emplace_back(
+                    Frame::Type::Item, tag, VR::UNKNOWN, length,
+                    this->transfer_syntax);
+                this->_close_frames();
+            }
+            else
+            {
+                // Fragments are read directly after the previous ones
+                this->_target =
+                    this->_frames.back().fragments.add_fragment(length);
+                if(length > 0)
+                {
+                    this->_length = length;
+                    this->_remaining = length;
+                    this->_state = State::Fragment;
+                }
+            }
+        }
+        else if(
+            tag == registry::SequenceDelimitationItem
+            && frame.length == undefined_length)
+        {
+            this->_pop_frame();
+            this->_close_frames();
+        }
+        else
+        {
+            throw Exception("Expected Item, got: "+std::string(tag));
+        }
+    }
+    else if(this->_state == State::ItemDelimitation)
+    {
+        this->_header.clear();
+        this->_pop_frame();
+        this->_close_frames();
+    }
+    else
+    {
+        throw Exception("Invalid state");
+    }
+}
+
+void
+IncrementalReader
+::_begin_element()
+{
+    if(this->_vr == VR::SQ)
+    {
+        this->_frames.emplace_back(
+            Frame::Type::Sequence, this->_tag, this->_vr, this->_length,
+            this->transfer_syntax);
+        this->_close_frames();
+    }
+    else if(this->_length == undefined_length)
+    {
+        if(!is_binary(this->_vr))
+        {
+            throw Exception(
+                "Undefined length for VR " + as_string(this->_vr));
+        }
+
+        // Encapsulated pixel data, PS 3.5, A.4
+        this->_frames.emplace_back(
+            Frame::Type::Fragments, this->_tag, this->_vr, this->_length,
+            this->transfer_syntax);
+        this->_close_frames();
+    }
+    else
+    {
+        if(is_binary(this->_vr))
+        {
+            this->_binary = BinaryBuffer(this->_length);
+            this->_target = this->_binary.data();
+        }
+        else
+        {
+            this->_value.clear();
+            this->_value.reserve(this->_length);
+        }
+        this->_remaining = this->_length;
+        this->_state = State::Value;
+
+        if(this->_length == 0)
+        {
+            this->_end_value();
+        }
+    }
+}
+
+void
+IncrementalReader
+::_end_value()
+{
+    if(this->_state == State::Fragment)
+    {
+        // Nothing to do: the fragment has been read in place
+    }
+    else if(is_binary(this->_vr))
+    {
+        BinaryBuffer value;
+        if(this->_length > 0)
+        {
+            if(this->byte_ordering != host_byte_ordering)
+            {
+                std::size_t item_size = 1;
+                if(this->_vr == VR::OW)
+                {
+                    item_size = 2;
+                }
+                else if(this->_vr == VR::OF || this->_vr == VR::OL)
+                {
+                    item_size = 4;
+                }
+                else if(this->_vr == VR::OD)
+                {
+                    item_size = 8;
+                }
+
+                if(item_size > 1)
+                {
+                    auto const data = reinterpret_cast<char *>(this->_target);
+                    swap_bytes(data, data, this->_binary.size(), item_size);
+                }
+            }
+
+            value = std::move(this->_binary);
+        }
+        this->_target = nullptr;
+
+        this->_add_element(this->_tag, Element(std::move(value), this->_vr));
+    }
+    else
+    {
+        // Decode the other values as the stream-based reader does
+        StringBuffer buffer(this->_value);
+        std::istream stream(&buffer);
+        Reader reader(stream, this->transfer_syntax);
+        reader.keep_encoded_values = this->keep_encoded_values;
+        reader.string_pool = this->string_pool;
+        auto element = reader.read_element(this->_tag, this->_vr, this->_length);
+        this->_add_element(this->_tag, std::move(element));
+    }
+
+    this->_close_frames();
+}
+
+void
+IncrementalReader
+::_add_element(Tag const & tag, Element && element)
+{
+    if(this->keep_group_length || tag.element != 0)
+    {
+        this->_frames.back().data_set.add(tag, std::move(element));
+    }
+}
+
+void
+IncrementalReader
+::_pop_frame()
+{
+    Frame frame = std::move(this->_frames.back());
+    this->_frames.pop_back();
+
+    if(frame.type == Frame::Type::Item)
+    {
+        this->_frames.back().items.push_back(std::move(frame.data_set));
+    }
+    else if(frame.type == Frame::Type::Sequence)
+    {
+        this->_add_element(
+            frame.tag, Element(std::move(frame.items), frame.vr));
+    }
+    else if(frame.type == Frame::Type::Fragments)
+    {
+        this->_add_element(
+            frame.tag, Element(std::move(frame.fragments), frame.vr));
+    }
+    else
+    {
+        throw Exception("Cannot close the top-level data set");
+    }
+}
+
+void
+IncrementalReader
+::_close_frames()
+{
+    while(this->_frames.size() > 1)
+    {
+        auto const & frame = this->_frames.back();
+        if(frame.length == undefined_length || frame.consumed < frame.length)
+        {
+            break;
+        }
+        else if(frame.consumed > frame.length)
+        {
+            throw Exception("Content is larger than its container");
+        }
+        this->_pop_frame();
+    }
+
+    auto const type = this->_frames.back().type;
+    if(type == Frame::Type::Sequence || type == Frame::Type::Fragments)
+    {
+        this->_state = State::ItemHeader;
+    }
+    else
+    {
+        this->_state = State::Tag;
+    }
+}
+
+template<typename T>
+T
+IncrementalReader
+::_decode(char const * data) const
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return (this->byte_ordering == ByteOrdering::LittleEndian)
+        ?little_endian_to_host(value)
+        :big_endian_to_host(value);
+}
+
+}
@@ -0,0 +1,188 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _a4f7189b_3952_49ce_ab19_809f18fb9c5e
+#define _a4f7189b_3952_49ce_ab19_809f18fb9c5e
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "odil/BinaryBuffer.h"
+#include "odil/DataSet.h"
+#include "odil/endian.h"
+#include "odil/odil.h"
+#include "odil/StringPool.h"
+#include "odil/Tag.h"
+#include "odil/Value.h"
+#include "odil/VR.h"
+
+namespace odil
+{
+
+/**
+ * @brief Read a data set from chunks of data of arbitrary size, e.g. as they
+ * are received from the network.
+ *
+ * The state of the parser is kept between the chunks, so that a chunk may end
+ * anywhere in an element. Elements are added to the data set as soon as they
+ * are complete; binary values are read directly in their final storage.
+ */
+class ODIL_API IncrementalReader
+{
+public:
+    /// @brief Transfer syntax used to read the data.
+    std::string transfer_syntax;
+
+    /// @brief Endianness.
+    ByteOrdering byte_ordering;
+
+    /// @brief Explicit-ness of the Value Representations.
+    bool explicit_vr;
+
+    /// @brief Flag to keep or discard group length tags.
+    bool keep_group_length;
+
+    /**
+     * @brief Flag to keep integer, real and string values in their encoded
+     * form, cf. Reader::keep_encoded_values.
+     */
+    bool keep_encoded_values;
+
+    /// @brief Pool in which the string values are interned, if not null.
+    std::shared_ptr<StringPool> string_pool;
+
+    /**
+     * @brief Build a reader, derive byte ordering and explicit-ness of VR
+     * from transfer syntax.
+     */
+    IncrementalReader(
+        std::string const & transfer_syntax, bool keep_group_length=false);
+
+    /// @brief Parse a chunk of data.
+    void feed(char const * data, std::size_t size);
+
+    /**
+     * @brief Test whether the data parsed so far form a complete data set,
+     * i.e. whether they end between two top-level elements.
+     */
+    bool is_complete() const;
+
+    /// @brief Return the top-level elements which have been completely read.
+    DataSet const & get_data_set() const;
+
+    /**
+     * @brief Return the data set and reset the reader, throw an exception if
+     * the data set is not complete.
+     */
+    DataSet finish();
+
+private:
+    /// @brief Bytes expected by the parser.
+    enum class State
+    {
+        Tag,
+        Header,
+        Value,
+        ItemHeader,
+        Fragment,
+        ItemDelimitation
+    };
+
+    /// @brief Container (data set, sequence, item or fragments) being read.
+    struct Frame
+    {
+        enum class Type
+        {
+            DataSet,
+            Sequence,
+            Item,
+            Fragments
+        };
+
+        Type type;
+        Tag tag;
+        VR vr;
+
+        /// @brief Length of the content, 0xffffffff if undefined.
+        uint32_t length;
+
+        /// @brief Number of bytes of the content read so far.
+        uint64_t consumed;
+
+        DataSet data_set;
+        Value::DataSets items;
+        BinaryBuffer fragments;
+
+        Frame(
+            Type type, Tag const & tag, VR vr, uint32_t length,
+            std::string const & transfer_syntax);
+    };
+
+    /// @brief Open containers, the first one being the top-level data set.
+    std::vector<Frame> _frames;
+
+    State _state;
+
+    /// @brief Partial tag, VR and length.
+    std::string _header;
+
+    /// @brief Tag of the current element.
+    Tag _tag;
+
+    /// @brief VR of the current element.
+    VR _vr;
+
+    /// @brief Length of the current element or fragment.
+    uint32_t _length;
+
+    /// @brief Number of bytes of the current value which are still expected.
+    uint32_t _remaining;
+
+    /// @brief Encoded value of the current non-binary element.
+    std::string _value;
+
+    /// @brief Value of the current binary element.
+    BinaryBuffer _binary;
+
+    /// @brief Storage of the current binary element or fragment.
+    uint8_t * _target;
+
+    /// @brief Return the number of bytes of the header in the current state.
+    std::size_t _header_size() const;
+
+    /// @brief Handle a complete header.
+    void _parse_header();
+
+    /// @brief Handle the tag, VR and length of an element.
+    void _begin_element();
+
+    /// @brief Handle a complete value.
+    void _end_value();
+
+    /// @brief Add an element to the innermost data set.
+    void _add_element(Tag const & tag, Element && element);
+
+    /// @brief Close the innermost container.
+    void _pop_frame();
+
+    /**
+     * @brief Close the explicit-length containers whose content has been
+     * read and update the state.
+     */
+    void _close_frames();
+
+    template<typename T>
+    T _decode(char const * data) const;
+};
+
+}
+
+#endif // _a4f7189b_3952_49ce_ab19_809f18fb9c5e
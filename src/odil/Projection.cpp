@@ -0,0 +1,102 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/Projection.h"
+
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+#include "odil/Exception.h"
+#include "odil/Tag.h"
+
+namespace odil
+{
+
+Projection
+::Projection()
+{
+    // Nothing to do.
+}
+
+Projection
+::Projection(std::initializer_list<Tag> const & tags)
+{
+    for(auto const & tag: tags)
+    {
+        this->add(tag);
+    }
+}
+
+void
+Projection
+::add(Tag const & tag)
+{
+    this->_elements[tag] = nullptr;
+}
+
+void
+Projection
+::add(Path const & path)
+{
+    if(path.empty())
+    {
+        throw Exception("Empty path");
+    }
+
+    Projection * projection = this;
+    for(auto it=path.begin(); it+1 != path.end(); ++it)
+    {
+        auto const iterator = projection->_elements.find(*it);
+        if(iterator == projection->_elements.end())
+        {
+            auto const nested = std::make_shared<Projection>();
+            projection->_elements[*it] = nested;
+            projection = nested.get();
+        }
+        else if(iterator->second == nullptr)
+        {
+            // Whole sequence is already in the projection
+            return;
+        }
+        else
+        {
+            projection = iterator->second.get();
+        }
+    }
+    projection->add(path.back());
+}
+
+bool
+Projection
+::empty() const
+{
+    return this->_elements.empty();
+}
+
+bool
+Projection
+::has(Tag const & tag) const
+{
+    return (this->_elements.find(tag) != this->_elements.end());
+}
+
+Projection const *
+Projection
+::get_nested(Tag const & tag) const
+{
+    auto const iterator = this->_elements.find(tag);
+    if(iterator == this->_elements.end())
+    {
+        throw Exception("No such element " + std::string(tag));
+    }
+
+    return iterator->second.get();
+}
+
+}
@@ -0,0 +1,73 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _9f6daecc_fa8f_4221_83d8_4713057887f2
+#define _9f6daecc_fa8f_4221_83d8_4713057887f2
+
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "odil/odil.h"
+#include "odil/Tag.h"
+
+namespace odil
+{
+
+/**
+ * @brief Set of elements to read from a data set, possibly restricted to
+ * some elements in the items of sequences.
+ */
+class ODIL_API Projection
+{
+public:
+    /// @brief Path to an element nested in sequences.
+    typedef std::vector<Tag> Path;
+
+    /// @brief Create an empty projection.
+    Projection();
+
+    /// @brief Create a projection containing the whole given elements.
+    Projection(std::initializer_list<Tag> const & tags);
+
+    /// @brief Add a whole element to the projection.
+    void add(Tag const & tag);
+
+    /**
+     * @brief Add an element nested in sequences to the projection: all but
+     * the last tag of the path are sequences, of which only the selected
+     * elements are kept, in every item.
+     *
+     * If a sequence of the path is already wholly in the projection, this
+     * has no effect. If the path is empty, a odil::Exception is raised.
+     */
+    void add(Path const & path);
+
+    /// @brief Test whether the projection is empty.
+    bool empty() const;
+
+    /// @brief Test whether an element is (wholly or partially) in the projection.
+    bool has(Tag const & tag) const;
+
+    /**
+     * @brief Return the projection applied to the items of a sequence, or
+     * nullptr if the whole element is in the projection.
+     *
+     * If the element is not in the projection, a odil::Exception is raised.
+     */
+    Projection const * get_nested(Tag const & tag) const;
+
+private:
+    /// @brief Selected elements, with a null projection for whole elements.
+    std::map<Tag, std::shared_ptr<Projection>> _elements;
+};
+
+}
+
+#endif // _9f6daecc_fa8f_4221_83d8_4713057887f2
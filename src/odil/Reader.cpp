@@ -9,18 +9,22 @@
 #include "odil/Reader.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <istream>
 #include <memory>
-#include <sstream>
 #include <string>
 #include <utility>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 #include "odil/DataSet.h"
 #include "odil/Element.h"
 #include "odil/endian.h"
 #include "odil/Exception.h"
+#include "odil/read_ds.h"
 #include "odil/registry.h"
 #include "odil/Tag.h"
 #include "odil/Value.h"
@@ -42,6 +46,188 @@ std::string read_string(std::istream & stream, unsigned int size)
     return value;
 }
 
+namespace
+{
+
+/**
+ * @brief Skip data from a stream, by seeking if possible, ensure stream is
+ * still good.
+ */
+void skip(std::istream & stream, std::streamsize size)
+{
+    auto const position = stream.rdbuf()->pubseekoff(
+        size, std::ios_base::cur, std::ios_base::in);
+    if(position == std::streambuf::pos_type(std::streambuf::off_type(-1)))
+    {
+        odil::Reader::ignore(stream, size);
+    }
+}
+
+/// @brief Read-only, seekable stream buffer on a memory area.
+class MemoryBuffer: public std::streambuf
+{
+public:
+    MemoryBuffer(char const * begin, char const * end)
+    {
+        // The get area is never written to.
+        auto const data = const_cast<char *>(begin);
+        this->setg(data, data, data+(end-begin));
+    }
+
+protected:
+    virtual pos_type seekoff(
+        off_type offset, std::ios_base::seekdir direction,
+        std::ios_base::openmode which)
+    {
+        char * base;
+        if(direction == std::ios_base::beg)
+        {
+            base = this->eback();
+        }
+        else if(direction == std::ios_base::cur)
+        {
+            base = this->gptr();
+        }
+        else
+        {
+            base = this->egptr();
+        }
+
+        return this->seekpos((base-this->eback())+offset, which);
+    }
+
+    virtual pos_type seekpos(pos_type position, std::ios_base::openmode which)
+    {
+        off_type const offset = position;
+        if(!(which & std::ios_base::in)
+            || offset < 0 || offset > this->egptr()-this->eback())
+        {
+            return pos_type(off_type(-1));
+        }
+
+        this->setg(this->eback(), this->eback()+offset, this->egptr());
+        return position;
+    }
+};
+
+/**
+ * @brief Read-only stream buffer on a fixed-size part of another stream
+ * buffer, starting at its current position.
+ *
+ * No data is buffered: all operations are forwarded to the other stream
+ * buffer, and the positions are those of the other stream buffer.
+ */
+class WindowBuffer: public std::streambuf
+{
+public:
+    WindowBuffer(std::streambuf * parent, std::streamsize size)
+    : _parent(parent), _size(size), _position(0)
+    {
+        // Nothing else
+    }
+
+protected:
+    virtual int_type underflow()
+    {
+        if(this->_position >= this->_size)
+        {
+            return traits_type::eof();
+        }
+        return this->_parent->sgetc();
+    }
+
+    virtual int_type uflow()
+    {
+        if(this->_position >= this->_size)
+        {
+            return traits_type::eof();
+        }
+        auto const c = this->_parent->sbumpc();
+        if(!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            ++this->_position;
+        }
+        return c;
+    }
+
+    virtual std::streamsize xsgetn(char * data, std::streamsize size)
+    {
+        auto const read = this->_parent->sgetn(
+            data, std::min(size, this->_size-this->_position));
+        this->_position += read;
+        return read;
+    }
+
+    virtual std::streamsize showmanyc()
+    {
+        return (this->_position < this->_size)?0:-1;
+    }
+
+    virtual pos_type seekoff(
+        off_type offset, std::ios_base::seekdir direction,
+        std::ios_base::openmode which)
+    {
+        // Only relative moves inside the window are allowed.
+        if(direction != std::ios_base::cur || !(which & std::ios_base::in)
+            || this->_position+offset < 0
+            || this->_position+offset > this->_size)
+        {
+            return pos_type(off_type(-1));
+        }
+
+        auto const position = this->_parent->pubseekoff(
+            offset, std::ios_base::cur, std::ios_base::in);
+        if(position != pos_type(off_type(-1)))
+        {
+            this->_position += offset;
+        }
+        return position;
+    }
+
+private:
+    std::streambuf * _parent;
+    std::streamsize _size;
+    std::streamsize _position;
+};
+
+/// @brief Read-only memory mapping of a whole file.
+class MappedFile
+{
+public:
+    MappedFile(std::string const & path)
+    {
+        try
+        {
+            this->_file = boost::interprocess::file_mapping(
+                path.c_str(), boost::interprocess::read_only);
+            this->_region = boost::interprocess::mapped_region(
+                this->_file, boost::interprocess::read_only);
+        }
+        catch(boost::interprocess::interprocess_exception const & e)
+        {
+            throw odil::Exception("Cannot map "+path+": "+e.what());
+        }
+        this->_region.advise(
+            boost::interprocess::mapped_region::advice_sequential);
+    }
+
+    char const * begin() const
+    {
+        return static_cast<char const *>(this->_region.get_address());
+    }
+
+    char const * end() const
+    {
+        return this->begin()+this->_region.get_size();
+    }
+
+private:
+    boost::interprocess::file_mapping _file;
+    boost::interprocess::mapped_region _region;
+};
+
+}
+
 namespace odil
 {
 
@@ -114,7 +300,24 @@ Reader
         (transfer_syntax==registry::ExplicitVRBigEndian_Retired)?
         ByteOrdering::BigEndian:ByteOrdering::LittleEndian),
     explicit_vr(transfer_syntax!=registry::ImplicitVRLittleEndian),
-    keep_group_length(keep_group_length)
+    keep_group_length(keep_group_length), keep_encoded_values(false),
+    string_pool(), _mapped_data(), _share_memory(false),
+    _deferred_threshold(0),
+    _projection(nullptr), _has_look_ahead(false)
+{
+    // Nothing else
+}
+
+Reader
+::Reader(std::istream & stream, Reader const & other)
+: stream(stream), transfer_syntax(other.transfer_syntax),
+    byte_ordering(other.byte_ordering), explicit_vr(other.explicit_vr),
+    keep_group_length(other.keep_group_length),
+    keep_encoded_values(other.keep_encoded_values),
+    string_pool(other.string_pool), _mapped_data(other._mapped_data),
+    _share_memory(other._share_memory),
+    _deferred_threshold(other._deferred_threshold),
+    _projection(other._projection), _has_look_ahead(false)
 {
     // Nothing else
 }
@@ -125,7 +328,7 @@ Reader
 {
     DataSet data_set(transfer_syntax);
 
-    bool done = (this->stream.peek() == EOF);
+    bool done = this->_at_end();
     while(!done)
     {
         Tag const tag = this->read_tag();
@@ -133,9 +336,13 @@ Reader
         if(halt_condition(tag))
         {
             done = true;
-            this->stream.seekg(-4, std::ios::cur);
+            this->_unread_tag(tag);
             break;
         }
+        else if(this->_projection && !this->_projection->has(tag))
+        {
+            this->_skip_element();
+        }
         else
         {
             Element element = this->read_element(tag, data_set);
@@ -146,16 +353,43 @@ Reader
             }
         }
 
-        done = (this->stream.peek() == EOF);
+        done = this->_at_end();
     }
 
     return data_set;
 }
 
+DataSet
+Reader
+::read_data_set(
+    Projection const & projection,
+    std::function<bool(Tag const &)> halt_condition) const
+{
+    Reader reader(this->stream, *this);
+    reader._projection = &projection;
+
+    // Both readers share the stream: hand the tag kept for the next read over
+    // to the temporary reader, and take back the tag which it keeps.
+    reader._has_look_ahead = this->_has_look_ahead;
+    reader._look_ahead = this->_look_ahead;
+    this->_has_look_ahead = false;
+    auto data_set = reader.read_data_set(halt_condition);
+    this->_has_look_ahead = reader._has_look_ahead;
+    this->_look_ahead = reader._look_ahead;
+
+    return data_set;
+}
+
 Tag
 Reader
 ::read_tag() const
 {
+    if(this->_has_look_ahead)
+    {
+        this->_has_look_ahead = false;
+        return this->_look_ahead;
+    }
+
     auto const group = this->read_binary<uint16_t>(
         this->stream, this->byte_ordering);
     auto const element = this->read_binary<uint16_t>(
@@ -211,43 +445,80 @@ Reader
         vr = vr_finder(tag, data_set, this->transfer_syntax);
     }
 
-    std::shared_ptr<Value> value;
-
     auto const vl = this->read_length(vr);
-    if(is_int(vr))
+
+    return this->read_element(tag, vr, vl);
+}
+
+Element
+Reader
+::read_element(Tag const & tag, VR vr, uint32_t vl) const
+{
+    // Values are built in place and moved into the element: large values
+    // are never copied.
+    // Encapsulated values have an undefined length: their size is checked
+    // while deferring them.
+    bool const deferred = (
+        is_binary(vr) && this->_mapped_data && this->_deferred_threshold != 0
+        && vl >= this->_deferred_threshold);
+    bool const encoded = (
+        this->keep_encoded_values && vl != 0 && vl != 0xffffffff
+        && (is_int(vr) || is_real(vr) || is_string(vr)));
+    Value::IntegerFormat format;
+    bool const native = (
+        Value::get_integer_format(vr, format) && vl != 0 && vl != 0xffffffff);
+    Value::BinaryLoader loader;
+    if(deferred)
+    {
+        loader = this->_defer_binary(vr, vl);
+    }
+
+    if(loader)
+    {
+        return Element(Value(loader), vr);
+    }
+    else if(encoded)
     {
-        value = std::make_shared<Value>(Value::Integers());
+        // Keep the encoded bytes, they are decoded on demand
+        return Element(
+            Value(this->_read_binary(VR::OB, vl), vr, this->byte_ordering),
+            vr);
+    }
+    else if(native)
+    {
+        // Integers are read as an array, and are widened on demand
+        return Element(Value(this->_read_binary(vr, vl), format), vr);
+    }
+    else if(is_int(vr))
+    {
+        return Element(this->_read_value<Value::Integers>(tag, vr, vl), vr);
     }
     else if(is_real(vr))
     {
-        value = std::make_shared<Value>(Value::Reals());
+        return Element(this->_read_value<Value::Reals>(tag, vr, vl), vr);
     }
     else if(is_string(vr))
     {
-        value = std::make_shared<Value>(Value::Strings());
+        auto strings = this->_read_value<Value::Strings>(tag, vr, vl);
+        if(this->string_pool)
+        {
+            return Element(this->string_pool->intern(std::move(strings)), vr);
+        }
+        return Element(std::move(strings), vr);
     }
     else if(vr == VR::SQ)
     {
-        value = std::make_shared<Value>(Value::DataSets());
+        return Element(this->_read_value<Value::DataSets>(tag, vr, vl), vr);
     }
     else if(is_binary(vr))
     {
-        value = std::make_shared<Value>(Value::Binary());
+        // Binary data is read directly in a contiguous buffer
+        return Element(Value(this->_read_binary(vr, vl)), vr);
     }
     else
     {
         throw Exception("Cannot create value for VR " + as_string(vr));
     }
-
-    if(vl > 0)
-    {
-        Visitor visitor(
-            this->stream, vr, vl, this->transfer_syntax, this->byte_ordering,
-            this->explicit_vr, this->keep_group_length);
-        apply_visitor(visitor, *value);
-    }
-
-    return Element(*value, vr);
 }
 
 std::pair<DataSet, DataSet>
@@ -255,6 +526,61 @@ Reader
 ::read_file(
     std::istream & stream, bool keep_group_length,
     std::function<bool(Tag const &)> halt_condition)
+{
+    return Reader::_read_file(
+        stream, keep_group_length, halt_condition, nullptr, false, 0,
+        nullptr);
+}
+
+std::pair<DataSet, DataSet>
+Reader
+::read_file(
+    std::istream & stream, Projection const & projection,
+    bool keep_group_length, std::function<bool(Tag const &)> halt_condition)
+{
+    return Reader::_read_file(
+        stream, keep_group_length, halt_condition, nullptr, false, 0,
+        &projection);
+}
+
+std::pair<DataSet, DataSet>
+Reader
+::read_file(
+    std::string const & path, bool keep_group_length,
+    std::function<bool(Tag const &)> halt_condition,
+    std::size_t deferred_threshold, bool share_memory)
+{
+    auto const file = std::make_shared<MappedFile>(path);
+    // Share the ownership of the mapping with the deferred values
+    std::shared_ptr<char const> const mapped_data(file, file->begin());
+
+    MemoryBuffer buffer(file->begin(), file->end());
+    std::istream stream(&buffer);
+    return Reader::_read_file(
+        stream, keep_group_length, halt_condition,
+        mapped_data, share_memory, deferred_threshold, nullptr);
+}
+
+std::pair<DataSet, DataSet>
+Reader
+::read_file(
+    std::string const & path, Projection const & projection,
+    bool keep_group_length, std::function<bool(Tag const &)> halt_condition,
+    std::size_t deferred_threshold, bool share_memory)
+{
+    auto const file = std::make_shared<MappedFile>(path);
+    std::shared_ptr<char const> const mapped_data(file, file->begin());
+
+    MemoryBuffer buffer(file->begin(), file->end());
+    std::istream stream(&buffer);
+    return Reader::_read_file(
+        stream, keep_group_length, halt_condition,
+        mapped_data, share_memory, deferred_threshold, &projection);
+}
+
+DataSet
+Reader
+::read_meta_information(std::istream & stream, bool keep_group_length)
 {
     // File preamble
     stream.ignore(128);
@@ -271,10 +597,48 @@ Reader
     }
 
     // Read meta information
-    Reader meta_information_reader(
-        stream, registry::ExplicitVRLittleEndian, keep_group_length);
-    auto meta_information = meta_information_reader.read_data_set(
-        [](Tag const & tag) { return (tag.group != 0x0002); });
+    DataSet meta_information;
+    if(stream.tellg() != std::streampos(-1))
+    {
+        // Stop at the first tag of the data set, and put it back.
+        Reader meta_information_reader(
+            stream, registry::ExplicitVRLittleEndian, keep_group_length);
+        meta_information = meta_information_reader.read_data_set(
+            [](Tag const & tag) { return (tag.group != 0x0002); });
+    }
+    else
+    {
+        // The first tag of the data set cannot be put back in a
+        // non-seekable stream: use the group length to stop before it.
+        Reader const group_length_reader(
+            stream, registry::ExplicitVRLittleEndian);
+        auto const tag = group_length_reader.read_tag();
+        if(tag != registry::FileMetaInformationGroupLength)
+        {
+            throw Exception(
+                "Cannot read meta information without group length "
+                "from a non-seekable stream");
+        }
+        auto const group_length = group_length_reader.read_element(tag);
+        if(!group_length.is_int() || group_length.size() != 1)
+        {
+            throw Exception("Invalid File Meta Information Group Length");
+        }
+
+        WindowBuffer buffer(stream.rdbuf(), group_length.as_int()[0]);
+        std::istream group_stream(&buffer);
+        Reader const meta_information_reader(
+            group_stream, registry::ExplicitVRLittleEndian, keep_group_length);
+        meta_information = meta_information_reader.read_data_set();
+        if(!stream)
+        {
+            throw Exception("Could not read from stream");
+        }
+        if(keep_group_length)
+        {
+            meta_information.add(tag, group_length);
+        }
+    }
 
     if(!meta_information.has(registry::TransferSyntaxUID))
     {
@@ -284,27 +648,357 @@ Reader
     {
         throw Exception("Transfer Syntax UID is not a string");
     }
-    if(meta_information.as_string(registry::TransferSyntaxUID).size()<1)
+    if(meta_information.size(registry::TransferSyntaxUID)<1)
     {
         throw Exception("Empty Transfer Syntax UID");
     }
 
+    return meta_information;
+}
+
+std::pair<DataSet, DataSet>
+Reader
+::_read_file(
+    std::istream & stream, bool keep_group_length,
+    std::function<bool(Tag const &)> halt_condition,
+    std::shared_ptr<char const> const & mapped_data, bool share_memory,
+    std::size_t deferred_threshold, Projection const * projection)
+{
+    auto meta_information = Reader::read_meta_information(
+        stream, keep_group_length);
+
     Reader data_set_reader(
-        stream, meta_information.as_string(registry::TransferSyntaxUID)[0],
+        stream, meta_information.as_string(registry::TransferSyntaxUID, 0),
         keep_group_length);
+    data_set_reader._mapped_data = mapped_data;
+    data_set_reader._share_memory = share_memory;
+    data_set_reader._deferred_threshold = deferred_threshold;
+    data_set_reader._projection = projection;
     auto data_set = data_set_reader.read_data_set(halt_condition);
 
     return std::make_pair(std::move(meta_information), std::move(data_set));
 }
 
+bool
+Reader
+::_at_end() const
+{
+    return !this->_has_look_ahead && this->stream.peek() == EOF;
+}
+
+void
+Reader
+::_unread_tag(Tag const & tag) const
+{
+    this->stream.seekg(-4, std::ios::cur);
+    if(!this->stream)
+    {
+        // Non-seekable stream: keep the tag for the next read.
+        this->stream.clear();
+        this->_look_ahead = tag;
+        this->_has_look_ahead = true;
+    }
+}
+
+void
+Reader
+::_skip_element() const
+{
+    uint32_t vl;
+    if(this->explicit_vr)
+    {
+        auto const vr = as_vr(read_string(this->stream, 2));
+        vl = this->read_length(vr);
+    }
+    else
+    {
+        // The VR is not required to skip the element
+        vl = Reader::read_binary<uint32_t>(this->stream, this->byte_ordering);
+    }
+
+    if(vl == 0xffffffff)
+    {
+        // Sequence or encapsulated pixel data
+        this->_skip_sequence();
+    }
+    else
+    {
+        skip(this->stream, vl);
+    }
+}
+
+void
+Reader
+::_skip_sequence() const
+{
+    bool done = false;
+    while(!done)
+    {
+        auto const tag = this->read_tag();
+        auto const length = Reader::read_binary<uint32_t>(
+            this->stream, this->byte_ordering);
+        if(tag == registry::Item)
+        {
+            if(length == 0xffffffff)
+            {
+                this->_skip_item();
+            }
+            else
+            {
+                skip(this->stream, length);
+            }
+        }
+        else if(tag == registry::SequenceDelimitationItem)
+        {
+            done = true;
+        }
+        else
+        {
+            throw Exception(
+                "Expected SequenceDelimitationItem, got: "+std::string(tag));
+        }
+    }
+}
+
+void
+Reader
+::_skip_item() const
+{
+    bool done = false;
+    while(!done)
+    {
+        auto const tag = this->read_tag();
+        if(tag == registry::ItemDelimitationItem)
+        {
+            Reader::ignore(this->stream, 4);
+            done = true;
+        }
+        else
+        {
+            this->_skip_element();
+        }
+    }
+}
+
+Value::BinaryLoader
+Reader
+::_defer_binary(VR vr, uint32_t vl) const
+{
+    std::streamoff const offset = this->stream.tellg();
+    if(offset < 0)
+    {
+        throw Exception("Cannot get position in stream");
+    }
+    // The stream is memory-mapped, hence seekable: skip the value without
+    // reading it.
+    std::size_t size;
+    if(vl == 0xffffffff)
+    {
+        // Encapsulated pixel data: skip the fragments to get their size, and
+        // read them now if they are too small to be deferred.
+        this->_skip_sequence();
+        std::streamoff const end = this->stream.tellg();
+        if(end < 0)
+        {
+            throw Exception("Cannot get position in stream");
+        }
+        size = end-offset;
+        if(size < this->_deferred_threshold)
+        {
+            this->stream.seekg(offset);
+            if(!this->stream)
+            {
+                throw Exception("Could not read from stream");
+            }
+            return Value::BinaryLoader();
+        }
+    }
+    else
+    {
+        this->stream.seekg(vl, std::ios::cur);
+        if(!this->stream)
+        {
+            throw Exception("Could not read from stream");
+        }
+        size = vl;
+    }
+
+    auto const data = this->_mapped_data;
+    auto const transfer_syntax = this->transfer_syntax;
+    auto const keep_group_length = this->keep_group_length;
+    auto const share_memory = this->_share_memory;
+    return [
+        data, offset, size, vr, vl, transfer_syntax, keep_group_length,
+        share_memory]()
+    {
+        MemoryBuffer buffer(data.get()+offset, data.get()+offset+size);
+        std::istream stream(&buffer);
+        Reader reader(stream, transfer_syntax, keep_group_length);
+        // Positions in the stream are relative to the start of the value
+        reader._mapped_data = std::shared_ptr<char const>(data, data.get()+offset);
+        reader._share_memory = share_memory;
+        if(vl == 0xffffffff)
+        {
+            return reader._read_encapsulated_pixel_data();
+        }
+        else
+        {
+            return reader._read_binary(vr, vl);
+        }
+    };
+}
+
+template<typename T>
+T
+Reader
+::_read_value(Tag const & tag, VR vr, uint32_t vl) const
+{
+    T value;
+    if(vl > 0)
+    {
+        if(this->_projection == nullptr)
+        {
+            Visitor const visitor(this->stream, vr, vl, *this);
+            visitor(value);
+        }
+        else
+        {
+            // Items of sequences are restricted by the nested projection
+            Reader value_reader(this->stream, *this);
+            value_reader._projection = this->_projection->get_nested(tag);
+            Visitor const visitor(this->stream, vr, vl, value_reader);
+            visitor(value);
+        }
+    }
+    return value;
+}
+
+BinaryBuffer
+Reader
+::_read_binary(VR vr, uint32_t vl) const
+{
+    if(vl == 0)
+    {
+        return BinaryBuffer();
+    }
+    else if(vl == 0xffffffff)
+    {
+        return this->_read_encapsulated_pixel_data();
+    }
+
+    std::size_t item_size;
+    if(vr == VR::OB || vr == VR::UN)
+    {
+        item_size = 1;
+    }
+    else if(vr == VR::OW || vr == VR::SS || vr == VR::US)
+    {
+        item_size = 2;
+    }
+    else if(vr == VR::OF || vr == VR::OL || vr == VR::SL || vr == VR::UL)
+    {
+        item_size = 4;
+    }
+    else if(vr == VR::OD)
+    {
+        item_size = 8;
+    }
+    else
+    {
+        throw Exception("Cannot read "+as_string(vr)+" as binary");
+    }
+
+    if(vl%item_size != 0)
+    {
+        throw Exception("Cannot read "+as_string(vr)+" for odd-sized array");
+    }
+
+    bool const swap = (
+        item_size > 1 && this->byte_ordering != host_byte_ordering);
+
+    if(this->_mapped_data && this->_share_memory && !swap)
+    {
+        // Share the memory-mapped data instead of copying it.
+        std::streamoff const offset = this->stream.tellg();
+        if(offset < 0)
+        {
+            throw Exception("Cannot get position in stream");
+        }
+        this->stream.seekg(vl, std::ios::cur);
+        if(!this->stream)
+        {
+            throw Exception("Could not read from stream");
+        }
+
+        auto const data = reinterpret_cast<uint8_t const *>(
+            this->_mapped_data.get()+offset);
+        return BinaryBuffer(
+            std::shared_ptr<uint8_t const>(this->_mapped_data, data), vl);
+    }
+    else
+    {
+        // Read the whole array at once, and convert it in place
+        BinaryBuffer buffer(vl);
+        auto const data = reinterpret_cast<char*>(buffer.data());
+        this->stream.read(data, vl);
+        if(!this->stream)
+        {
+            throw Exception("Could not read from stream");
+        }
+        if(swap)
+        {
+            swap_bytes(data, data, vl, item_size);
+        }
+        return buffer;
+    }
+}
+
+BinaryBuffer
+Reader
+::_read_encapsulated_pixel_data() const
+{
+    BinaryBuffer buffer;
+
+    // PS 3.5, A.4
+    bool done = false;
+    while(!done)
+    {
+        auto const tag = this->read_tag();
+        auto const item_length = Reader::read_binary<uint32_t>(
+            this->stream, this->byte_ordering);
+
+        if(tag == registry::Item)
+        {
+            // Fragments are stored one after the other.
+            auto const data = buffer.add_fragment(item_length);
+            if(item_length > 0)
+            {
+                this->stream.read(reinterpret_cast<char*>(data), item_length);
+                if(!this->stream)
+                {
+                    throw Exception("Could not read from stream");
+                }
+            }
+        }
+        else if(tag == registry::SequenceDelimitationItem)
+        {
+            // No value for Sequence Delimitation Item
+            done = true;
+        }
+        else
+        {
+            throw Exception(
+                "Expected SequenceDelimitationItem, got: "+std::string(tag));
+        }
+    }
+
+    return buffer;
+}
+
 Reader::Visitor
 ::Visitor(
-    std::istream & stream, VR vr, uint32_t vl,
-    std::string const & transfer_syntax, ByteOrdering byte_ordering,
-    bool explicit_vr, bool keep_group_length)
-: stream(stream), vr(vr), vl(vl), transfer_syntax(transfer_syntax),
-    byte_ordering(byte_ordering), explicit_vr(explicit_vr),
-    keep_group_length(keep_group_length)
+    std::istream & stream, VR vr, uint32_t vl, Reader const & reader)
+: stream(stream), vr(vr), vl(vl), reader(reader)
 {
     // Nothing else
 }
@@ -318,12 +1012,7 @@ Reader::Visitor
         auto const string = read_string(this->stream, this->vl);
         if(!string.empty())
         {
-            auto const strings = this->split_strings(string);
-
-            value.resize(strings.size());
-            std::transform(
-                strings.begin(), strings.end(), value.begin(),
-                [](std::string const & s) { return std::stoll(s); });
+            read_is(string.data(), string.data()+string.size(), value);
         }
     }
     else
@@ -348,25 +1037,25 @@ Reader::Visitor
             if(this->vr == VR::SL)
             {
                 auto const item = Reader::read_binary<int32_t>(
-                    this->stream, this->byte_ordering);
+                    this->stream, this->reader.byte_ordering);
                 value[i] = item;
             }
             else if(this->vr == VR::SS)
             {
                 auto const item = Reader::read_binary<int16_t>(
-                    this->stream, this->byte_ordering);
+                    this->stream, this->reader.byte_ordering);
                 value[i] = item;
             }
             else if(this->vr == VR::UL)
             {
                 auto const item = Reader::read_binary<uint32_t>(
-                    this->stream, this->byte_ordering);
+                    this->stream, this->reader.byte_ordering);
                 value[i] = item;
             }
             else if(this->vr == VR::AT || this->vr == VR::US)
             {
                 auto const item = Reader::read_binary<uint16_t>(
-                    this->stream, this->byte_ordering);
+                    this->stream, this->reader.byte_ordering);
                 value[i] = item;
             }
         }
@@ -382,15 +1071,7 @@ Reader::Visitor
         auto const string = read_string(this->stream, this->vl);
         if(!string.empty())
         {
-            auto const strings = this->split_strings(string);
-            value.resize(strings.size());
-            std::transform(
-                strings.begin(), strings.end(), value.begin(),
-                [](std::string const & s)
-                {
-                    return static_cast<Value::Real>(std::stold(s));
-                }
-            );
+            read_ds(string.data(), string.data()+string.size(), value);
         }
     }
     else
@@ -415,13 +1096,13 @@ Reader::Visitor
             if(this->vr == VR::FD)
             {
                 auto const item = Reader::read_binary<double>(
-                    this->stream, this->byte_ordering);
+                    this->stream, this->reader.byte_ordering);
                 value[i] = item;
             }
             else if(this->vr == VR::FL)
             {
                 auto const item = Reader::read_binary<float>(
-                    this->stream, this->byte_ordering);
+                    this->stream, this->reader.byte_ordering);
                 value[i] = item;
             }
         }
@@ -449,10 +1130,11 @@ Reader::Visitor
     }
     else
     {
-        auto const string = read_string(this->stream, this->vl);
+        auto string = read_string(this->stream, this->vl);
         if(this->vr == VR::LT || this->vr == VR::ST || this->vr == VR::UT)
         {
-            value = { string };
+            value.clear();
+            value.push_back(std::move(string));
         }
         else
         {
@@ -467,7 +1149,7 @@ Reader::Visitor
             auto const last_char = item.find_last_not_of(padding);
             if(last_char != std::string::npos)
             {
-                item = item.substr(0, last_char+1);
+                item.erase(last_char+1);
             }
         }
     }
@@ -479,11 +1161,10 @@ Reader::Visitor
 {
     if(this->vl != 0xffffffff)
     {
-        // Explicit length sequence
-        std::string const data = read_string(this->stream, this->vl);
-        std::istringstream sequence_stream(data);
-        Reader const sequence_reader(
-            sequence_stream, this->transfer_syntax, this->keep_group_length);
+        // Explicit length sequence: parse it in place
+        WindowBuffer buffer(this->stream.rdbuf(), this->vl);
+        std::istream sequence_stream(&buffer);
+        Reader const sequence_reader(sequence_stream, this->reader);
 
         bool done = (sequence_stream.peek() == EOF);
         while(!done)
@@ -500,12 +1181,15 @@ Reader::Visitor
 
             done = (sequence_stream.peek() == EOF);
         }
+        if(!this->stream)
+        {
+            throw Exception("Could not read from stream");
+        }
     }
     else
     {
         // Undefined length sequence
-        Reader const sequence_reader(
-            this->stream, this->transfer_syntax, this->keep_group_length);
+        Reader const sequence_reader(this->stream, this->reader);
 
         bool done = false;
         while(!done)
@@ -532,90 +1216,7 @@ Reader::Visitor::result_type
 Reader::Visitor
 ::operator()(Value::Binary & value) const
 {
-    if(this->vl == 0)
-    {
-        return;
-    }
-    else if(this->vl == 0xffffffff)
-    {
-        value = Reader::read_encapsulated_pixel_data(
-            this->stream, this->byte_ordering, this->transfer_syntax,
-            this->keep_group_length);
-    }
-    else
-    {
-        value.resize(1);
-        if(this->vr == VR::OB || this->vr == VR::UN)
-        {
-            value[0].resize(this->vl);
-            this->stream.read(
-                reinterpret_cast<char*>(&value[0][0]), value[0].size());
-        }
-        else if(this->vr == VR::OD)
-        {
-            if(this->vl%8 != 0)
-            {
-                throw Exception("Cannot read OD for odd-sized array");
-            }
-
-            value[0].resize(this->vl);
-            for(unsigned int i=0; i<value[0].size(); i+=8)
-            {
-                auto const item = Reader::read_binary<double>(
-                    this->stream, this->byte_ordering);
-                *reinterpret_cast<double*>(&value[0][i]) = item;
-            }
-        }
-        else if(this->vr == VR::OF)
-        {
-            if(this->vl%4 != 0)
-            {
-                throw Exception("Cannot read OF for odd-sized array");
-            }
-
-            value[0].resize(this->vl);
-            for(unsigned int i=0; i<value[0].size(); i+=4)
-            {
-                auto const item = Reader::read_binary<float>(
-                    this->stream, this->byte_ordering);
-                *reinterpret_cast<float*>(&value[0][i]) = item;
-            }
-        }
-        else if(this->vr == VR::OL)
-        {
-            if(this->vl%4 != 0)
-            {
-                throw Exception("Cannot read OL for odd-sized array");
-            }
-
-            value[0].resize(this->vl);
-            for(unsigned int i=0; i<value[0].size(); i+=4)
-            {
-                auto const item = Reader::read_binary<uint32_t>(
-                    this->stream, this->byte_ordering);
-                *reinterpret_cast<uint32_t*>(&value[0][i]) = item;
-            }
-        }
-        else if(this->vr == VR::OW)
-        {
-            if(this->vl%2 != 0)
-            {
-                throw Exception("Cannot read OW for odd-sized array");
-            }
-
-            value[0].resize(this->vl);
-            for(unsigned int i=0; i<value[0].size(); i+=2)
-            {
-                auto const item = Reader::read_binary<uint16_t>(
-                    this->stream, this->byte_ordering);
-                *reinterpret_cast<uint16_t*>(&value[0][i]) = item;
-            }
-        }
-        else
-        {
-            throw Exception("Cannot read "+as_string(this->vr)+" as binary");
-        }
-    }
+    value = this->reader._read_binary(this->vr, this->vl).to_fragments();
 }
 
 Value::Strings
@@ -631,10 +1232,8 @@ Reader::Visitor
     while(begin != string.size())
     {
         auto const end = string.find('\\', begin);
-        auto const item = string.substr(
+        value[index] = string.substr(
             begin, (end==std::string::npos)?end:(end-begin));
-
-        value[index] = item;
         ++index;
 
         begin = (end==std::string::npos)?string.size():(end+1);
@@ -648,23 +1247,25 @@ Reader::Visitor
 ::read_item(std::istream & specific_stream) const
 {
     auto const item_length = Reader::read_binary<uint32_t>(
-        specific_stream, this->byte_ordering);
+        specific_stream, this->reader.byte_ordering);
 
     DataSet item;
     if(item_length != 0xffffffff)
     {
-        // Explicit length item
-        std::string const data = read_string(specific_stream, item_length);
-        std::istringstream item_stream(data);
-        Reader const item_reader(
-            item_stream, this->transfer_syntax, this->keep_group_length);
+        // Explicit length item: parse it in place
+        WindowBuffer buffer(specific_stream.rdbuf(), item_length);
+        std::istream item_stream(&buffer);
+        Reader const item_reader(item_stream, this->reader);
         item = item_reader.read_data_set();
+        if(!specific_stream)
+        {
+            throw Exception("Could not read from stream");
+        }
     }
     else
     {
         // Undefined length item
-        Reader const item_reader(
-            specific_stream, this->transfer_syntax, this->keep_group_length);
+        Reader const item_reader(specific_stream, this->reader);
         item = item_reader.read_data_set(
             [](Tag const & tag) { return tag == registry::ItemDelimitationItem; });
 
@@ -9,15 +9,20 @@
 #ifndef _aa2965aa_e891_4713_9c90_e8eacd2944ea
 #define _aa2965aa_e891_4713_9c90_e8eacd2944ea
 
+#include <cstddef>
 #include <functional>
 #include <istream>
+#include <memory>
 #include <string>
 #include <utility>
 
+#include "odil/BinaryBuffer.h"
 #include "odil/DataSet.h"
 #include "odil/Element.h"
 #include "odil/endian.h"
 #include "odil/odil.h"
+#include "odil/Projection.h"
+#include "odil/StringPool.h"
 #include "odil/Tag.h"
 #include "odil/Value.h"
 #include "odil/VR.h"
@@ -44,6 +49,15 @@ public:
     /// @brief Flag to keep or discard group length tags.
     bool keep_group_length;
 
+    /**
+     * @brief Flag to keep integer, real and string values in their encoded
+     * form, decoded when they are first accessed.
+     */
+    bool keep_encoded_values;
+
+    /// @brief Pool in which the string values are interned, if not null.
+    std::shared_ptr<StringPool> string_pool;
+
     /**
      * @brief Read binary data from an stream encoded with the given endianness,
      * ensure stream is still good.
@@ -67,10 +81,27 @@ public:
         std::istream & stream, std::string const & transfer_syntax,
         bool keep_group_length=false);
 
-    /// @brief Read a data set.
+    /**
+     * @brief Read a data set.
+     *
+     * The tag which matches the halt condition is put back in the stream if
+     * it is seekable; otherwise it is kept by the reader and returned by the
+     * next call to read_tag.
+     */
     DataSet read_data_set(
         std::function<bool(Tag const &)> halt_condition = [](Tag const &) { return false;}) const;
 
+    /**
+     * @brief Read only the elements of a data set which are in the projection:
+     * other elements are skipped without being decoded.
+     *
+     * The tag which matches the halt condition is handled as in the other
+     * overload.
+     */
+    DataSet read_data_set(
+        Projection const & projection,
+        std::function<bool(Tag const &)> halt_condition = [](Tag const &) { return false;}) const;
+
     /// @brief Read a tag.
     Tag read_tag() const;
 
@@ -86,13 +117,153 @@ public:
         Tag const & tag=Tag(0xffff,0xffff),
         DataSet const & data_set=DataSet()) const;
 
+    /**
+     * @brief Read the value of an element whose VR and length have already
+     * been read.
+     */
+    Element read_element(Tag const & tag, VR vr, uint32_t length) const;
+
+    /**
+     * @brief Read the preamble, prefix and meta-data header of a file,
+     * leaving the stream at the start of the data set.
+     *
+     * If the stream is not seekable, the header must start with its group
+     * length.
+     */
+    static DataSet read_meta_information(
+        std::istream & stream, bool keep_group_length=false);
+
     /// @brief Return the meta-data header and data set stored in the stream.
     static std::pair<DataSet, DataSet> read_file(
         std::istream & stream,
         bool keep_group_length=false,
         std::function<bool(Tag const &)> halt_condition = [](Tag const &) { return false;});
 
+    /**
+     * @brief Return the meta-data header and the elements of the data set
+     * stored in the stream which are in the projection.
+     */
+    static std::pair<DataSet, DataSet> read_file(
+        std::istream & stream,
+        Projection const & projection,
+        bool keep_group_length=false,
+        std::function<bool(Tag const &)> halt_condition = [](Tag const &) { return false;});
+
+    /**
+     * @brief Return the meta-data header and data set stored in a file.
+     *
+     * The file is memory-mapped and parsed in place: no intermediate buffer
+     * is used between the file and the values of the data set, which are
+     * copied from the mapping.
+     *
+     * If deferred_threshold is not 0, binary values (e.g. Pixel Data) whose
+     * length is at least deferred_threshold are not read (the length of
+     * encapsulated values includes their item headers): only their
+     * position in the file is recorded, and they are loaded when they are
+     * first accessed. The file must not be modified as long as these values
+     * are not loaded.
+     *
+     * If share_memory is true, the values which do not require byte
+     * swapping (binary values, fixed-width integers and encoded values) are
+     * not copied: they share the memory of the mapping. The file must then
+     * not be modified, truncated or replaced in place as long as these values
+     * exist, and in particular the data set cannot be written back to the
+     * same file: its values would be silently corrupted, or the process
+     * would crash when accessing them (e.g. SIGBUS on POSIX systems). On
+     * Windows, the file cannot be modified or deleted as long as these values
+     * exist.
+     */
+    static std::pair<DataSet, DataSet> read_file(
+        std::string const & path,
+        bool keep_group_length=false,
+        std::function<bool(Tag const &)> halt_condition = [](Tag const &) { return false;},
+        std::size_t deferred_threshold=0, bool share_memory=false);
+
+    /**
+     * @brief Return the meta-data header and the elements of the data set
+     * stored in a file which are in the projection.
+     *
+     * The file is memory-mapped, cf. the other read_file function for the
+     * meaning of deferred_threshold and share_memory.
+     */
+    static std::pair<DataSet, DataSet> read_file(
+        std::string const & path,
+        Projection const & projection,
+        bool keep_group_length=false,
+        std::function<bool(Tag const &)> halt_condition = [](Tag const &) { return false;},
+        std::size_t deferred_threshold=0, bool share_memory=false);
+
 private:
+    /// @brief Memory-mapped content of the stream, if any.
+    std::shared_ptr<char const> _mapped_data;
+
+    /// @brief Whether values may share the memory-mapped content.
+    bool _share_memory;
+
+    /// @brief Minimal length of deferred binary values, 0 to disable.
+    std::size_t _deferred_threshold;
+
+    /// @brief Elements to read, nullptr to read all elements.
+    Projection const * _projection;
+
+    /// @brief Whether a tag has been read but not consumed.
+    mutable bool _has_look_ahead;
+
+    /// @brief Tag read but not consumed, for non-seekable streams.
+    mutable Tag _look_ahead;
+
+    /**
+     * @brief Build a reader on another stream, with the same options. The
+     * stream must be the same as the one of the other reader or a window on
+     * it, so that both streams report the same positions.
+     */
+    Reader(std::istream & stream, Reader const & other);
+
+    /// @brief Read the meta-data header and data set stored in the stream.
+    static std::pair<DataSet, DataSet> _read_file(
+        std::istream & stream, bool keep_group_length,
+        std::function<bool(Tag const &)> halt_condition,
+        std::shared_ptr<char const> const & mapped_data, bool share_memory,
+        std::size_t deferred_threshold, Projection const * projection);
+
+    /// @brief Test whether there is nothing left to read.
+    bool _at_end() const;
+
+    /// @brief Put a tag back in the stream, or keep it for the next read.
+    void _unread_tag(Tag const & tag) const;
+
+    /// @brief Skip an element whose tag has already been read.
+    void _skip_element() const;
+
+    /// @brief Skip the content of an undefined-length sequence.
+    void _skip_sequence() const;
+
+    /// @brief Skip the content of an undefined-length item.
+    void _skip_item() const;
+
+    /**
+     * @brief Skip a binary value in the memory-mapped stream and return the
+     * function which will read it.
+     *
+     * Encapsulated values smaller than the threshold are not skipped, and an
+     * empty function is returned.
+     */
+    Value::BinaryLoader _defer_binary(VR vr, uint32_t vl) const;
+
+    /// @brief Read a value in a container which is then moved to its element.
+    template<typename T>
+    T _read_value(Tag const & tag, VR vr, uint32_t vl) const;
+
+    /**
+     * @brief Read a binary value or an array of fixed-width integers in a
+     * contiguous buffer, which shares the memory-mapped data when allowed
+     * and possible.
+     */
+    BinaryBuffer _read_binary(VR vr, uint32_t vl) const;
+
+    /// @brief Read the fragments of encapsulated pixel data.
+    BinaryBuffer _read_encapsulated_pixel_data() const;
+
     struct Visitor
     {
         typedef void result_type;
@@ -101,15 +272,10 @@ private:
         VR vr;
         uint32_t vl;
 
-        std::string transfer_syntax;
-        ByteOrdering byte_ordering;
-        bool explicit_vr;
-        bool keep_group_length;
+        Reader const & reader;
 
         Visitor(
-            std::istream & stream, VR vr, uint32_t vl,
-            std::string const & transfer_syntax, ByteOrdering byte_ordering,
-            bool explicit_vr, bool keep_group_length);
+            std::istream & stream, VR vr, uint32_t vl, Reader const & reader);
 
         result_type operator()(Value::Integers & value) const;
         result_type operator()(Value::Reals & value) const;
@@ -0,0 +1,140 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/SegmentList.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+namespace odil
+{
+
+std::size_t const SegmentList::default_threshold;
+
+SegmentList::Buffer
+::Buffer(SegmentList & segments)
+: _segments(segments)
+{
+    // Nothing else
+}
+
+SegmentList::Buffer::int_type
+SegmentList::Buffer
+::overflow(int_type c)
+{
+    if(c != traits_type::eof())
+    {
+        char const data = traits_type::to_char_type(c);
+        this->_segments._store(&data, 1);
+    }
+    return c;
+}
+
+std::streamsize
+SegmentList::Buffer
+::xsputn(char const * data, std::streamsize size)
+{
+    this->_segments._store(data, size);
+    return size;
+}
+
+SegmentList
+::SegmentList(std::size_t threshold)
+: _threshold(threshold), _data(), _entries(), _buffer(*this),
+    _stream(&this->_buffer)
+{
+    // Nothing else
+}
+
+std::size_t
+SegmentList
+::get_threshold() const
+{
+    return this->_threshold;
+}
+
+std::ostream &
+SegmentList
+::get_stream()
+{
+    return this->_stream;
+}
+
+void
+SegmentList
+::append_reference(
+    std::shared_ptr<uint8_t const> const & data, std::size_t size)
+{
+    if(size > 0)
+    {
+        this->_entries.push_back({data, 0, size});
+    }
+}
+
+std::vector<SegmentList::Segment>
+SegmentList
+::get_segments() const
+{
+    // Stored data may have been reallocated: resolve the offsets now.
+    std::vector<Segment> segments;
+    segments.reserve(this->_entries.size());
+    for(auto const & entry: this->_entries)
+    {
+        auto const data =
+            entry.data?entry.data.get():(&this->_data[0]+entry.offset);
+        segments.push_back({data, entry.size});
+    }
+    return segments;
+}
+
+std::size_t
+SegmentList
+::size() const
+{
+    std::size_t size = 0;
+    for(auto const & entry: this->_entries)
+    {
+        size += entry.size;
+    }
+    return size;
+}
+
+void
+SegmentList
+::clear()
+{
+    this->_data.clear();
+    this->_entries.clear();
+    this->_stream.clear();
+}
+
+void
+SegmentList
+::_store(char const * data, std::size_t size)
+{
+    if(size == 0)
+    {
+        return;
+    }
+
+    if(this->_entries.empty() || this->_entries.back().data != nullptr)
+    {
+        // Start a new stored segment after a referenced one
+        this->_entries.push_back({nullptr, this->_data.size(), 0});
+    }
+
+    auto const begin = reinterpret_cast<uint8_t const *>(data);
+    this->_data.insert(this->_data.end(), begin, begin+size);
+    this->_entries.back().size += size;
+}
+
+}
@@ -0,0 +1,125 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _8a8aed6f_d06b_415f_ae90_5a6bd490daa6
+#define _8a8aed6f_d06b_415f_ae90_5a6bd490daa6
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+#include "odil/odil.h"
+
+namespace odil
+{
+
+/**
+ * @brief Encoded data stored as a list of segments, for vectored I/O: the
+ * bytes written to the stream of the list are stored in the list, while
+ * large binary values are only referenced, cf. dul::Transport::write.
+ *
+ * Referenced data (e.g. the pixel data of a data set) is kept alive by the
+ * list, so that the segments remain valid even if the values they come from
+ * are modified or destroyed.
+ */
+class ODIL_API SegmentList
+{
+public:
+    /// @brief Default size from which binary values are referenced.
+    static std::size_t const default_threshold = 4096;
+
+    /// @brief Contiguous part of the encoded data.
+    struct Segment
+    {
+        uint8_t const * data;
+        std::size_t size;
+    };
+
+    /**
+     * @brief Create an empty list, where binary values of at least threshold
+     * bytes are referenced.
+     */
+    explicit SegmentList(std::size_t threshold=default_threshold);
+
+    SegmentList(SegmentList const &) =delete;
+    SegmentList & operator=(SegmentList const &) =delete;
+
+    /// @brief Return the size from which binary values are referenced.
+    std::size_t get_threshold() const;
+
+    /// @brief Return the stream whose content is stored in the list.
+    std::ostream & get_stream();
+
+    /**
+     * @brief Append a reference to data, which is kept alive by the list
+     * (e.g. a fragment of a BinaryBuffer, through the aliasing constructor of
+     * std::shared_ptr).
+     */
+    void append_reference(
+        std::shared_ptr<uint8_t const> const & data, std::size_t size);
+
+    /**
+     * @brief Return the segments, in order. They are valid until the list is
+     * modified.
+     */
+    std::vector<Segment> get_segments() const;
+
+    /// @brief Return the total size of the segments.
+    std::size_t size() const;
+
+    /// @brief Remove all the segments.
+    void clear();
+
+private:
+    /// @brief Stream buffer appending to the stored data.
+    class Buffer: public std::streambuf
+    {
+    public:
+        Buffer(SegmentList & segments);
+
+    protected:
+        int_type overflow(int_type c) override;
+        std::streamsize xsputn(char const * data, std::streamsize size) override;
+
+    private:
+        SegmentList & _segments;
+    };
+
+    /// @brief Stored or referenced part of the data.
+    struct Entry
+    {
+        /// @brief Referenced data, or null for stored data.
+        std::shared_ptr<uint8_t const> data;
+
+        /// @brief Offset of the stored data.
+        std::size_t offset;
+
+        std::size_t size;
+    };
+
+    std::size_t _threshold;
+
+    /// @brief Data written to the stream.
+    std::vector<uint8_t> _data;
+
+    std::vector<Entry> _entries;
+
+    Buffer _buffer;
+
+    std::ostream _stream;
+
+    /// @brief Store data written to the stream.
+    void _store(char const * data, std::size_t size);
+};
+
+}
+
+#endif // _8a8aed6f_d06b_415f_ae90_5a6bd490daa6
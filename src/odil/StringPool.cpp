@@ -0,0 +1,117 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/StringPool.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "odil/DataSet.h"
+#include "odil/Element.h"
+#include "odil/Value.h"
+
+namespace odil
+{
+
+std::size_t const StringPool::default_max_length;
+
+StringPool
+::StringPool(std::size_t max_length)
+: _max_length(max_length), _values()
+{
+    // Nothing else
+}
+
+std::size_t
+StringPool
+::get_max_length() const
+{
+    return this->_max_length;
+}
+
+Value
+StringPool
+::intern(Value::Strings strings)
+{
+    std::size_t length = 0;
+    for(auto const & string: strings)
+    {
+        length += string.size();
+    }
+    if(length > this->_max_length)
+    {
+        return Value(std::move(strings));
+    }
+
+    auto iterator = this->_values.find(strings);
+    if(iterator == this->_values.end())
+    {
+        Value value(strings);
+        iterator = this->_values.insert(
+            std::make_pair(std::move(strings), std::move(value))).first;
+    }
+
+    // The copy shares the content of the pooled value
+    return iterator->second;
+}
+
+void
+StringPool
+::intern(DataSet & data_set)
+{
+    // Elements cannot be modified through the iterators of the data set
+    for(auto const & item: data_set)
+    {
+        auto const & tag = item.first;
+        auto const & element = item.second;
+        if(element.is_string())
+        {
+            data_set[tag] = Element(
+                this->intern(element.as_string()), element.vr);
+        }
+        else if(element.is_data_set())
+        {
+            for(auto & nested: data_set[tag].as_data_set())
+            {
+                this->intern(nested);
+            }
+        }
+    }
+}
+
+std::size_t
+StringPool
+::size() const
+{
+    return this->_values.size();
+}
+
+void
+StringPool
+::clear()
+{
+    this->_values.clear();
+}
+
+std::size_t
+StringPool::Hash
+::operator()(Value::Strings const & strings) const
+{
+    std::hash<std::string> const hash;
+    std::size_t result = strings.size();
+    for(auto const & string: strings)
+    {
+        // Cf. boost::hash_combine
+        result ^= hash(string) + 0x9e3779b9 + (result<<6) + (result>>2);
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,78 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _a2fa5215_4204_471a_9893_5594f358d85b
+#define _a2fa5215_4204_471a_9893_5594f358d85b
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "odil/DataSet.h"
+#include "odil/odil.h"
+#include "odil/Value.h"
+
+namespace odil
+{
+
+/**
+ * @brief Pool of short string values (UIDs, code strings, ...): equal values
+ * obtained from the pool share the same content, which is compared by
+ * address.
+ *
+ * The shared content is copied as soon as it is modified through one of the
+ * values (cf. Value). A pool is not thread-safe.
+ *
+ * Only the values read by a Reader or an IncrementalReader whose string_pool
+ * is set are pooled: values set through DataSet are not, unless they are
+ * interned afterwards with intern(DataSet &).
+ */
+class ODIL_API StringPool
+{
+public:
+    /// @brief Default maximum length of the interned values.
+    static std::size_t const default_max_length = 64;
+
+    /**
+     * @brief Create an empty pool, interning the values whose total length
+     * is at most max_length.
+     */
+    explicit StringPool(std::size_t max_length=default_max_length);
+
+    /// @brief Return the maximum length of the interned values.
+    std::size_t get_max_length() const;
+
+    /**
+     * @brief Return a value sharing the content of an equal value of the
+     * pool; add the strings to the pool if there is no such value. Values
+     * which are too long are returned without being interned.
+     */
+    Value intern(Value::Strings strings);
+
+    /// @brief Intern the string values of a data set and of its sequences.
+    void intern(DataSet & data_set);
+
+    /// @brief Return the number of values in the pool.
+    std::size_t size() const;
+
+    /// @brief Remove all the values from the pool.
+    void clear();
+
+private:
+    struct Hash
+    {
+        std::size_t operator()(Value::Strings const & strings) const;
+    };
+
+    std::size_t _max_length;
+
+    std::unordered_map<Value::Strings, Value, Hash> _values;
+};
+
+}
+
+#endif // _a2fa5215_4204_471a_9893_5594f358d85b
@@ -0,0 +1,520 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/Transcoder.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "odil/DataSet.h"
+#include "odil/endian.h"
+#include "odil/Exception.h"
+#include "odil/Reader.h"
+#include "odil/registry.h"
+#include "odil/Tag.h"
+#include "odil/uid.h"
+#include "odil/VR.h"
+#include "odil/Writer.h"
+
+namespace
+{
+
+uint32_t const undefined_length = 0xffffffff;
+
+/// @brief Test whether the length of an element is stored on 32 bits.
+bool has_long_length(odil::VR vr)
+{
+    // PS 3.5, 7.1.2
+    return (
+        odil::is_binary(vr)
+        || vr == odil::VR::SQ || vr == odil::VR::UC || vr == odil::VR::UR
+        || vr == odil::VR::UT);
+}
+
+/// @brief Return the size of the items to swap when changing byte ordering.
+std::size_t get_item_size(odil::VR vr)
+{
+    if(vr == odil::VR::AT || vr == odil::VR::OW || vr == odil::VR::SS
+        || vr == odil::VR::US)
+    {
+        return 2;
+    }
+    else if(vr == odil::VR::FL || vr == odil::VR::OF || vr == odil::VR::OL
+        || vr == odil::VR::SL || vr == odil::VR::UL)
+    {
+        return 4;
+    }
+    else if(vr == odil::VR::FD || vr == odil::VR::OD)
+    {
+        return 8;
+    }
+    else
+    {
+        return 1;
+    }
+}
+
+}
+
+namespace odil
+{
+
+uint32_t const Transcoder::context_threshold = 1024;
+
+bool
+Transcoder
+::is_supported(std::string const & transfer_syntax)
+{
+    return (
+        transfer_syntax == registry::ImplicitVRLittleEndian
+        || transfer_syntax == registry::ExplicitVRLittleEndian
+        || transfer_syntax == registry::ExplicitVRBigEndian_Retired);
+}
+
+Transcoder
+::Transcoder(
+    std::istream & input, std::string const & input_transfer_syntax,
+    std::ostream & output, std::string const & output_transfer_syntax,
+    std::size_t buffer_size)
+: _input(input), _output(output),
+    _input_transfer_syntax(input_transfer_syntax),
+    _input_byte_ordering(
+        (input_transfer_syntax == registry::ExplicitVRBigEndian_Retired)
+        ?ByteOrdering::BigEndian:ByteOrdering::LittleEndian),
+    _input_explicit_vr(
+        input_transfer_syntax != registry::ImplicitVRLittleEndian),
+    _output_byte_ordering(
+        (output_transfer_syntax == registry::ExplicitVRBigEndian_Retired)
+        ?ByteOrdering::BigEndian:ByteOrdering::LittleEndian),
+    _output_explicit_vr(
+        output_transfer_syntax != registry::ImplicitVRLittleEndian),
+    _buffer(), _vr_finder()
+{
+    if(!Transcoder::is_supported(input_transfer_syntax))
+    {
+        throw Exception("Cannot transcode from " + input_transfer_syntax);
+    }
+    if(!Transcoder::is_supported(output_transfer_syntax))
+    {
+        throw Exception("Cannot transcode to " + output_transfer_syntax);
+    }
+
+    // Keep whole items of all VRs in the buffer
+    this->_buffer.resize(std::max<std::size_t>(8, buffer_size - buffer_size%8));
+}
+
+void
+Transcoder
+::transcode_data_set()
+{
+    DataSet context(this->_input_transfer_syntax);
+    while(this->_input.peek() != EOF)
+    {
+        auto const tag = this->_read_tag();
+        this->_transcode_element(tag, context);
+    }
+}
+
+void
+Transcoder
+::transcode_file(
+    std::istream & input, std::ostream & output,
+    std::string const & transfer_syntax)
+{
+    auto meta_information = Reader::read_meta_information(input);
+
+    // Check the transfer syntaxes before writing anything
+    auto & transfer_syntax_uid =
+        meta_information.as_string(registry::TransferSyntaxUID);
+    Transcoder transcoder(
+        input, transfer_syntax_uid[0], output, transfer_syntax);
+
+    transfer_syntax_uid = { transfer_syntax };
+    meta_information.add(
+        registry::ImplementationClassUID, {implementation_class_uid});
+    meta_information.add(
+        registry::ImplementationVersionName, {implementation_version_name});
+
+    // File preamble and DICOM prefix, PS3.10, 7.1
+    std::string const header = std::string(128, '\0') + "DICM";
+    output.write(header.data(), header.size());
+    if(!output)
+    {
+        throw Exception("Could not write to stream");
+    }
+
+    Writer const meta_information_writer(
+        output, registry::ExplicitVRLittleEndian);
+    meta_information_writer.write_data_set(meta_information);
+
+    transcoder.transcode_data_set();
+}
+
+void
+Transcoder
+::transcode_file(
+    std::string const & input_path, std::string const & output_path,
+    std::string const & transfer_syntax)
+{
+    std::ifstream input(input_path, std::ios::in | std::ios::binary);
+    if(!input)
+    {
+        throw Exception("Could not open "+input_path);
+    }
+
+    // Opening the output would truncate the input if both are the same file:
+    // write next to the output, on the same file system, and rename.
+    boost::filesystem::path const output_file(output_path);
+    auto const temporary_file =
+        output_file.parent_path()/boost::filesystem::unique_path(
+            output_file.filename().string()+".%%%%-%%%%-%%%%");
+    boost::system::error_code error;
+    try
+    {
+        std::ofstream output(
+            temporary_file.string(), std::ios::out | std::ios::binary);
+        if(!output)
+        {
+            throw Exception("Could not open "+temporary_file.string());
+        }
+        Transcoder::transcode_file(input, output, transfer_syntax);
+        output.close();
+        if(!output)
+        {
+            throw Exception("Could not write to "+temporary_file.string());
+        }
+
+        // The input must be closed before being replaced on some platforms
+        input.close();
+        boost::filesystem::rename(temporary_file, output_file, error);
+        if(error)
+        {
+            throw Exception(
+                "Could not replace "+output_path+": "+error.message());
+        }
+    }
+    catch(...)
+    {
+        boost::filesystem::remove(temporary_file, error);
+        throw;
+    }
+}
+
+Tag
+Transcoder
+::_read_tag() const
+{
+    auto const group = Reader::read_binary<uint16_t>(
+        this->_input, this->_input_byte_ordering);
+    auto const element = Reader::read_binary<uint16_t>(
+        this->_input, this->_input_byte_ordering);
+    return Tag(group, element);
+}
+
+void
+Transcoder
+::_write_tag(Tag const & tag) const
+{
+    Writer::write_binary(tag.group, this->_output, this->_output_byte_ordering);
+    Writer::write_binary(
+        tag.element, this->_output, this->_output_byte_ordering);
+}
+
+void
+Transcoder
+::_write_vr_and_length(VR vr, uint32_t length) const
+{
+    if(this->_output_explicit_vr)
+    {
+        auto const vr_string = as_string(vr);
+        this->_output.write(vr_string.data(), 2);
+        if(!this->_output)
+        {
+            throw Exception("Could not write to stream");
+        }
+
+        if(has_long_length(vr))
+        {
+            Writer::write_binary(
+                uint16_t(0), this->_output, this->_output_byte_ordering);
+            Writer::write_binary(
+                length, this->_output, this->_output_byte_ordering);
+        }
+        else if(length > 0xffff)
+        {
+            throw Exception(
+                "Value is too long for VR " + as_string(vr) + ": "
+                + std::to_string(length));
+        }
+        else
+        {
+            Writer::write_binary(
+                uint16_t(length), this->_output, this->_output_byte_ordering);
+        }
+    }
+    else
+    {
+        Writer::write_binary(length, this->_output, this->_output_byte_ordering);
+    }
+}
+
+uint64_t
+Transcoder
+::_transcode_element(Tag const & tag, DataSet & context)
+{
+    uint64_t read = 0;
+
+    VR vr;
+    uint32_t length;
+    if(this->_input_explicit_vr)
+    {
+        char vr_string[2];
+        this->_input.read(vr_string, 2);
+        if(!this->_input)
+        {
+            throw Exception("Could not read from stream");
+        }
+        vr = as_vr(std::string(vr_string, 2));
+        if(has_long_length(vr))
+        {
+            Reader::ignore(this->_input, 2);
+            length = Reader::read_binary<uint32_t>(
+                this->_input, this->_input_byte_ordering);
+            read += 8;
+        }
+        else
+        {
+            length = Reader::read_binary<uint16_t>(
+                this->_input, this->_input_byte_ordering);
+            read += 4;
+        }
+    }
+    else
+    {
+        vr = this->_vr_finder(tag, context, this->_input_transfer_syntax);
+        length = Reader::read_binary<uint32_t>(
+            this->_input, this->_input_byte_ordering);
+        read += 4;
+    }
+
+    if(tag.element == 0)
+    {
+        // The group length changes with the explicit-ness of the VRs
+        Reader::ignore(this->_input, length);
+        read += length;
+    }
+    else if(vr == VR::SQ)
+    {
+        this->_write_tag(tag);
+        this->_write_vr_and_length(VR::SQ, undefined_length);
+        read += this->_transcode_sequence(length);
+        this->_write_tag(registry::SequenceDelimitationItem);
+        Writer::write_binary(
+            uint32_t(0), this->_output, this->_output_byte_ordering);
+    }
+    else if(vr == VR::UN && length == undefined_length)
+    {
+        // UN with undefined length is a sequence whose items and delimiters
+        // are encoded in Implicit VR Little Endian, PS3.5, 6.2.2
+        auto const transfer_syntax = this->_input_transfer_syntax;
+        auto const byte_ordering = this->_input_byte_ordering;
+        auto const explicit_vr = this->_input_explicit_vr;
+
+        this->_input_transfer_syntax = registry::ImplicitVRLittleEndian;
+        this->_input_byte_ordering = ByteOrdering::LittleEndian;
+        this->_input_explicit_vr = false;
+
+        this->_write_tag(tag);
+        this->_write_vr_and_length(VR::SQ, undefined_length);
+        read += this->_transcode_sequence(length);
+        this->_write_tag(registry::SequenceDelimitationItem);
+        Writer::write_binary(
+            uint32_t(0), this->_output, this->_output_byte_ordering);
+
+        this->_input_transfer_syntax = transfer_syntax;
+        this->_input_byte_ordering = byte_ordering;
+        this->_input_explicit_vr = explicit_vr;
+    }
+    else if(length == undefined_length)
+    {
+        // Encapsulated pixel data, PS 3.5, A.4
+        this->_write_tag(tag);
+        this->_write_vr_and_length(vr, undefined_length);
+        read += this->_transcode_fragments();
+    }
+    else
+    {
+        this->_write_tag(tag);
+        this->_write_vr_and_length(vr, length);
+
+        if(!this->_input_explicit_vr && length <= Transcoder::context_threshold)
+        {
+            std::string content;
+            this->_copy_value(vr, length, &content);
+
+            std::istringstream stream(content);
+            Reader const reader(stream, this->_input_transfer_syntax);
+            context.add(tag, reader.read_element(tag, vr, length));
+        }
+        else
+        {
+            this->_copy_value(vr, length, nullptr);
+        }
+        read += length;
+    }
+
+    return read;
+}
+
+uint64_t
+Transcoder
+::_transcode_item(uint32_t length)
+{
+    DataSet context(this->_input_transfer_syntax);
+    uint64_t read = 0;
+    while(length == undefined_length || read < length)
+    {
+        auto const tag = this->_read_tag();
+        read += 4;
+        if(length == undefined_length && tag == registry::ItemDelimitationItem)
+        {
+            Reader::ignore(this->_input, 4);
+            read += 4;
+            break;
+        }
+        read += this->_transcode_element(tag, context);
+    }
+
+    if(length != undefined_length && read != length)
+    {
+        throw Exception("Content is larger than its container");
+    }
+
+    return read;
+}
+
+uint64_t
+Transcoder
+::_transcode_sequence(uint32_t length)
+{
+    uint64_t read = 0;
+    while(length == undefined_length || read < length)
+    {
+        auto const tag = this->_read_tag();
+        auto const item_length = Reader::read_binary<uint32_t>(
+            this->_input, this->_input_byte_ordering);
+        read += 8;
+
+        if(tag == registry::Item)
+        {
+            this->_write_tag(registry::Item);
+            Writer::write_binary(
+                undefined_length, this->_output, this->_output_byte_ordering);
+            read += this->_transcode_item(item_length);
+            this->_write_tag(registry::ItemDelimitationItem);
+            Writer::write_binary(
+                uint32_t(0), this->_output, this->_output_byte_ordering);
+        }
+        else if(tag == registry::SequenceDelimitationItem)
+        {
+            // Also tolerated at the end of defined-length sequences
+            break;
+        }
+        else
+        {
+            throw Exception("Expected Item, got: "+std::string(tag));
+        }
+    }
+
+    if(length != undefined_length && read != length)
+    {
+        throw Exception("Content is larger than its container");
+    }
+
+    return read;
+}
+
+uint64_t
+Transcoder
+::_transcode_fragments()
+{
+    uint64_t read = 0;
+    while(true)
+    {
+        auto const tag = this->_read_tag();
+        auto const length = Reader::read_binary<uint32_t>(
+            this->_input, this->_input_byte_ordering);
+        read += 8;
+
+        this->_write_tag(tag);
+        Writer::write_binary(length, this->_output, this->_output_byte_ordering);
+
+        if(tag == registry::SequenceDelimitationItem)
+        {
+            break;
+        }
+        else if(tag != registry::Item)
+        {
+            throw Exception("Expected Item, got: "+std::string(tag));
+        }
+
+        // Fragments are byte streams
+        this->_copy_value(VR::OB, length, nullptr);
+        read += length;
+    }
+
+    return read;
+}
+
+void
+Transcoder
+::_copy_value(VR vr, uint32_t length, std::string * content)
+{
+    auto const item_size =
+        (this->_input_byte_ordering != this->_output_byte_ordering)
+        ?get_item_size(vr):1;
+
+    auto const buffer = this->_buffer.data();
+    while(length > 0)
+    {
+        // The buffer size is a multiple of the item size
+        auto const size = std::min<std::size_t>(length, this->_buffer.size());
+        this->_input.read(buffer, size);
+        if(!this->_input)
+        {
+            throw Exception("Could not read from stream");
+        }
+
+        if(content != nullptr)
+        {
+            content->append(buffer, size);
+        }
+        if(item_size > 1)
+        {
+            swap_bytes(buffer, buffer, size, item_size);
+        }
+
+        this->_output.write(buffer, size);
+        if(!this->_output)
+        {
+            throw Exception("Could not write to stream");
+        }
+
+        length -= size;
+    }
+}
+
+}
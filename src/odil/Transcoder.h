@@ -0,0 +1,140 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _3d9f10e6_ff9d_4f45_9d0f_2b1d52db7892
+#define _3d9f10e6_ff9d_4f45_9d0f_2b1d52db7892
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "odil/DataSet.h"
+#include "odil/endian.h"
+#include "odil/odil.h"
+#include "odil/Tag.h"
+#include "odil/VR.h"
+#include "odil/VRFinder.h"
+
+namespace odil
+{
+
+/**
+ * @brief Convert DICOM objects between uncompressed transfer syntaxes
+ * element by element, without building the data set.
+ *
+ * Values are copied through a fixed-size buffer and byte-swapped if the byte
+ * orderings differ, so that the memory usage does not depend on the size of
+ * the object. Sequences and items are written with undefined length, since
+ * the length of their content changes with the explicit-ness of the VRs;
+ * group length elements are discarded for the same reason. When reading
+ * implicit VR, the elements shorter than context_threshold are kept to find
+ * the VR of the next elements of their data set.
+ */
+class ODIL_API Transcoder
+{
+public:
+    /// @brief Maximal length of the elements kept to find the VR of others.
+    static uint32_t const context_threshold;
+
+    /**
+     * @brief Test whether a transfer syntax can be transcoded, i.e. whether
+     * it is uncompressed and not deflated.
+     */
+    static bool is_supported(std::string const & transfer_syntax);
+
+    /**
+     * @brief Build a transcoder between the two streams. If one of the
+     * transfer syntaxes is not supported, a odil::Exception is raised.
+     */
+    Transcoder(
+        std::istream & input, std::string const & input_transfer_syntax,
+        std::ostream & output, std::string const & output_transfer_syntax,
+        std::size_t buffer_size=65536);
+
+    /// @brief Transcode a data set, up to the end of the input stream.
+    void transcode_data_set();
+
+    /**
+     * @brief Transcode a file (meta-information and data set), updating the
+     * transfer syntax of its meta-information.
+     */
+    static void transcode_file(
+        std::istream & input, std::ostream & output,
+        std::string const & transfer_syntax);
+
+    /**
+     * @brief Transcode a file given by its path. The output is written to a
+     * temporary file which then replaces output_path, so that input_path and
+     * output_path may be the same file.
+     */
+    static void transcode_file(
+        std::string const & input_path, std::string const & output_path,
+        std::string const & transfer_syntax);
+
+private:
+    std::istream & _input;
+    std::ostream & _output;
+
+    std::string _input_transfer_syntax;
+    ByteOrdering _input_byte_ordering;
+    bool _input_explicit_vr;
+
+    ByteOrdering _output_byte_ordering;
+    bool _output_explicit_vr;
+
+    /// @brief Buffer through which the values are copied.
+    std::vector<char> _buffer;
+
+    VRFinder _vr_finder;
+
+    /// @brief Read a tag from the input stream.
+    Tag _read_tag() const;
+
+    /// @brief Write a tag to the output stream.
+    void _write_tag(Tag const & tag) const;
+
+    /// @brief Write the VR (if explicit) and length of an element.
+    void _write_vr_and_length(VR vr, uint32_t length) const;
+
+    /**
+     * @brief Transcode an element whose tag has been read, return the number
+     * of bytes read after the tag.
+     */
+    uint64_t _transcode_element(Tag const & tag, DataSet & context);
+
+    /**
+     * @brief Transcode the content of an item, return the number of bytes
+     * read.
+     */
+    uint64_t _transcode_item(uint32_t length);
+
+    /**
+     * @brief Transcode the items of a sequence, return the number of bytes
+     * read.
+     */
+    uint64_t _transcode_sequence(uint32_t length);
+
+    /**
+     * @brief Transcode the fragments of encapsulated pixel data, return the
+     * number of bytes read.
+     */
+    uint64_t _transcode_fragments();
+
+    /**
+     * @brief Copy a value through the buffer, and keep its encoded form in
+     * content if not null.
+     */
+    void _copy_value(VR vr, uint32_t length, std::string * content);
+};
+
+}
+
+#endif // _3d9f10e6_ff9d_4f45_9d0f_2b1d52db7892
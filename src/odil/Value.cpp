@@ -9,14 +9,24 @@
 #include "odil/Value.h"
 
 #include <cstdint>
+#include <cstring>
 #include <initializer_list>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "odil/BinaryBuffer.h"
 #include "odil/DataSet.h"
+#include "odil/endian.h"
 #include "odil/Exception.h"
+#include "odil/hash.h"
+#include "odil/Reader.h"
+#include "odil/registry.h"
+#include "odil/Tag.h"
 
 namespace
 {
@@ -43,80 +53,374 @@ struct ValueSizeGetter
     }
 };
 
-struct ClearValue
+/// @brief Compare a contiguous binary buffer and binary fragments.
+bool equal(odil::BinaryBuffer const & buffer, odil::Value::Binary const & binary)
 {
-    typedef void result_type;
+    if(buffer.get_fragments_count() != binary.size())
+    {
+        return false;
+    }
+    for(std::size_t i=0; i<binary.size(); ++i)
+    {
+        auto const size = buffer.get_fragment_size(i);
+        if(size != binary[i].size()
+            || (size != 0
+                && std::memcmp(buffer.get_fragment(i), &binary[i][0], size) != 0))
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
-    template <typename T>
-    result_type operator()(T & container) const
+/// @brief Construct an object in uninitialized storage.
+template<typename T, typename ... Args>
+void construct(T & storage, Args && ... args)
+{
+    new (&storage) T(std::forward<Args>(args)...);
+}
+
+/// @brief Destroy an object, leaving its storage uninitialized.
+template<typename T>
+void destroy(T & object)
+{
+    object.~T();
+}
+
+/// @brief Return the size in bytes of an integer format.
+std::size_t get_width(odil::Value::IntegerFormat format)
+{
+    return (
+        format == odil::Value::IntegerFormat::Int16
+        || format == odil::Value::IntegerFormat::UInt16)?2:4;
+}
+
+/// @brief Widen integers stored in their native width.
+template<typename T>
+void widen(uint8_t const * data, odil::Value::Integers & integers)
+{
+    for(auto & integer: integers)
     {
-        return container.clear();
+        T item;
+        std::memcpy(&item, data, sizeof(T));
+        integer = item;
+        data += sizeof(T);
     }
-};
+}
+
+/// @brief Combine the hashes of fixed-width integers stored in an array.
+template<typename T>
+uint64_t hash_items(uint8_t const * data, std::size_t size, uint64_t hash)
+{
+    for(std::size_t i=0; i<size; ++i)
+    {
+        T item;
+        std::memcpy(&item, data, sizeof(T));
+        hash = odil::hash_combine(
+            hash, static_cast<uint64_t>(static_cast<odil::Value::Integer>(item)));
+        data += sizeof(T);
+    }
+    return hash;
+}
+
+/// @brief Return the type of the values encoded with the given VR.
+odil::Value::Type get_encoded_type(odil::VR vr)
+{
+    if(odil::is_int(vr))
+    {
+        return odil::Value::Type::Integers;
+    }
+    else if(odil::is_real(vr))
+    {
+        return odil::Value::Type::Reals;
+    }
+    else if(odil::is_string(vr))
+    {
+        return odil::Value::Type::Strings;
+    }
+    else
+    {
+        throw odil::Exception(
+            "Cannot create encoded value for VR " + odil::as_string(vr));
+    }
+}
+
+/// @brief Return the shared content, or an empty content if there is none.
+template<typename T>
+T const & get(std::shared_ptr<T> const & content)
+{
+    static T const empty{};
+    return content?*content:empty;
+}
+
+/// @brief Return the content, after making sure it exists and is not shared.
+template<typename T>
+T & detach(std::shared_ptr<T> & content)
+{
+    if(!content)
+    {
+        content = std::make_shared<T>();
+    }
+    else if(content.use_count() > 1)
+    {
+        content = std::make_shared<T>(*content);
+    }
+    return *content;
+}
+
+/**
+ * @brief Return the content to be stored in a copy: the content is shared,
+ * unless references to it have been exposed to the user.
+ */
+template<typename T>
+std::shared_ptr<T> share(std::shared_ptr<T> const & content, bool exposed)
+{
+    return (exposed && content)?std::make_shared<T>(*content):content;
+}
+
 }
 
 namespace odil
 {
 
+Value::Storage
+::Storage()
+{
+    // Alternatives are constructed by Value
+}
+
+Value::Storage
+::~Storage()
+{
+    // Alternatives are destroyed by Value
+}
+
+struct Value::Derived
+{
+    /// @brief Contiguous buffer of the fragments, or loaded deferred content.
+    std::once_flag buffer_flag;
+    std::shared_ptr<BinaryBuffer> buffer;
+
+    /// @brief Fragments of the contiguous buffer.
+    std::once_flag fragments_flag;
+    std::shared_ptr<Binary> fragments;
+
+    /// @brief Integers stored in their native width, widened.
+    std::once_flag integers_flag;
+    std::shared_ptr<Integers> integers;
+
+    /// @brief Decoded form of the encoded value.
+    std::once_flag decoded_flag;
+    std::shared_ptr<Value> decoded;
+};
+
 #define ODIL_VALUE_CONSTRUCTORS(type, holder) \
     Value\
     ::Value(type const & value)\
-    : _type(Type::type), holder(value) \
-    {} \
+    : _derived(nullptr), _type(Type::type), \
+        _representation(Representation::Default), \
+        _exposed(false), _has_hash(false), _hash(0) \
+    { \
+        construct(this->_storage.holder, std::make_shared<type>(value)); \
+    } \
     \
     Value\
     ::Value(type && value)\
-    : _type(Type::type), holder(std::move(value)) \
-    {} \
+    : _derived(nullptr), _type(Type::type), \
+        _representation(Representation::Default), \
+        _exposed(false), _has_hash(false), _hash(0) \
+    { \
+        construct( \
+            this->_storage.holder, std::make_shared<type>(std::move(value))); \
+    } \
     \
     Value\
     ::Value(std::initializer_list<type::value_type> const & value)\
-    : _type(Type::type), holder(value) \
-    {}
+    : _derived(nullptr), _type(Type::type), \
+        _representation(Representation::Default), \
+        _exposed(false), _has_hash(false), _hash(0) \
+    { \
+        construct(this->_storage.holder, std::make_shared<type>(value)); \
+    }
     /*
      * No need for for a rvalue reference version of std::initializer_list:
      * copying a std::initializer_list does not copy the underlying objects.
      */
 
-    ODIL_VALUE_CONSTRUCTORS(Integers, _integers);
-    ODIL_VALUE_CONSTRUCTORS(Reals, _reals);
-    ODIL_VALUE_CONSTRUCTORS(Strings, _strings);
-    ODIL_VALUE_CONSTRUCTORS(Binary, _binary);
+    ODIL_VALUE_CONSTRUCTORS(Integers, integers);
+    ODIL_VALUE_CONSTRUCTORS(Reals, reals);
+    ODIL_VALUE_CONSTRUCTORS(Strings, strings);
+    ODIL_VALUE_CONSTRUCTORS(DataSets, data_sets);
+    ODIL_VALUE_CONSTRUCTORS(Binary, binary);
 
 #undef ODIL_VALUE_CONSTRUCTORS
 
 Value
-::Value(DataSets const & value)
-: _type(Type::DataSets), _data_sets(std::make_shared<DataSets>(value))
+::Value(std::initializer_list<int> const & value)
+: _derived(nullptr), _type(Type::Integers),
+    _representation(Representation::Default),
+    _exposed(false), _has_hash(false), _hash(0)
 {
+    construct(
+        this->_storage.integers,
+        std::make_shared<Integers>(value.begin(), value.end()));
 }
 
 Value
-::Value(DataSets && value)
-: _type(Type::DataSets), _data_sets(std::make_shared<DataSets>(std::move(value)))
+::Value(std::initializer_list<std::initializer_list<uint8_t>> const & value)
+: _derived(nullptr), _type(Type::Binary),
+    _representation(Representation::Default),
+    _exposed(false), _has_hash(false), _hash(0)
 {
+    construct(
+        this->_storage.binary,
+        std::make_shared<Binary>(value.begin(), value.end()));
 }
 
 Value
-::Value(std::initializer_list<DataSets::value_type> const & value)
-: _type(Type::DataSets), _data_sets(std::make_shared<DataSets>(value))
+::Value(BinaryBuffer const & value)
+: _derived(nullptr), _type(Type::Binary),
+    _representation(Representation::Buffer),
+    _exposed(false), _has_hash(false), _hash(0)
 {
+    construct(this->_storage.binary_buffer, std::make_shared<BinaryBuffer>(value));
 }
 
 Value
-::Value(std::initializer_list<int> const & value)
-: _type(Type::Integers)
+::Value(BinaryBuffer && value)
+: _derived(nullptr), _type(Type::Binary),
+    _representation(Representation::Buffer),
+    _exposed(false), _has_hash(false), _hash(0)
 {
-    this->_integers.resize(value.size());
-    std::copy(value.begin(), value.end(), this->_integers.begin());
+    construct(
+        this->_storage.binary_buffer,
+        std::make_shared<BinaryBuffer>(std::move(value)));
 }
 
 Value
-::Value(std::initializer_list<std::initializer_list<uint8_t>> const & value)
-: _type(Type::Binary)
+::Value(BinaryBuffer const & data, IntegerFormat format)
+: _derived(nullptr), _type(Type::Integers),
+    _representation(Representation::NativeIntegers),
+    _exposed(false), _has_hash(false), _hash(0)
+{
+    if(data.get_fragments_count() > 1 || data.size()%get_width(format) != 0)
+    {
+        throw Exception("Invalid native integers");
+    }
+    construct(
+        this->_storage.native_integers,
+        std::make_shared<NativeIntegers>(NativeIntegers{format, data}));
+}
+
+Value
+::Value(BinaryBuffer const & data, VR vr, ByteOrdering byte_ordering)
+: _derived(nullptr), _type(get_encoded_type(vr)),
+    _representation(Representation::Encoded),
+    _exposed(false), _has_hash(false), _hash(0)
+{
+    if(data.get_fragments_count() > 1)
+    {
+        throw Exception("Invalid encoded value");
+    }
+    construct(
+        this->_storage.encoded,
+        std::make_shared<Encoded>(Encoded{data, vr, byte_ordering}));
+}
+
+Value
+::Value(BinaryLoader const & loader)
+: _derived(nullptr), _type(Type::Binary),
+    _representation(Representation::Deferred),
+    _exposed(false), _has_hash(false), _hash(0)
+{
+    construct(
+        this->_storage.binary_loader, std::make_shared<BinaryLoader>(loader));
+}
+
+Value
+::~Value()
 {
-    this->_binary.resize(value.size());
-    std::copy(value.begin(), value.end(), this->_binary.begin());
+    this->_destroy();
+    this->_clear_derived();
+}
+
+Value
+::Value(Value const & other)
+: _derived(nullptr), _type(other._type),
+    _representation(other._representation),
+    _exposed(false), _has_hash(other._has_hash.load()),
+    _hash(other._hash.load())
+{
+    this->_construct(other);
+}
+
+Value
+::Value(Value && other) noexcept
+: _derived(other._derived.exchange(nullptr)), _type(other._type),
+    _representation(other._representation),
+    _exposed(other._exposed), _has_hash(other._has_hash.load()),
+    _hash(other._hash.load())
+{
+    this->_construct(std::move(other));
+}
+
+Value &
+Value
+::operator=(Value const & other)
+{
+    if(this != &other)
+    {
+        // Copy first, so that the value is unchanged if the copy fails
+        Value copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+Value &
+Value
+::operator=(Value && other) noexcept
+{
+    if(this != &other)
+    {
+        this->_destroy();
+        this->_clear_derived();
+        this->_derived = other._derived.exchange(nullptr);
+        this->_type = other._type;
+        this->_representation = other._representation;
+        this->_exposed = other._exposed;
+        this->_has_hash = other._has_hash.load();
+        this->_hash = other._hash.load();
+        this->_construct(std::move(other));
+    }
+    return *this;
+}
+
+bool
+Value
+::get_integer_format(VR vr, IntegerFormat & format)
+{
+    if(vr == VR::SS)
+    {
+        format = IntegerFormat::Int16;
+    }
+    else if(vr == VR::US)
+    {
+        format = IntegerFormat::UInt16;
+    }
+    else if(vr == VR::SL)
+    {
+        format = IntegerFormat::Int32;
+    }
+    else if(vr == VR::UL)
+    {
+        format = IntegerFormat::UInt32;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
 }
 
 Value::Type
@@ -130,6 +434,19 @@ bool
 Value
 ::empty() const
 {
+    if(this->_representation == Representation::Encoded)
+    {
+        return this->_get_decoded().empty();
+    }
+    else if(this->_representation == Representation::NativeIntegers)
+    {
+        return this->_storage.native_integers->data.size() == 0;
+    }
+    else if(this->_type == Type::Binary
+        && this->_representation != Representation::Default)
+    {
+        return this->as_binary_buffer().empty();
+    }
     return apply_visitor(IsEmptyValue(), *this);
 }
 
@@ -137,6 +454,20 @@ std::size_t
 Value
 ::size() const
 {
+    if(this->_representation == Representation::Encoded)
+    {
+        return this->_get_decoded().size();
+    }
+    else if(this->_representation == Representation::NativeIntegers)
+    {
+        auto const & native_integers = *this->_storage.native_integers;
+        return native_integers.data.size()/get_width(native_integers.format);
+    }
+    else if(this->_type == Type::Binary
+        && this->_representation != Representation::Default)
+    {
+        return this->as_binary_buffer().get_fragments_count();
+    }
     return apply_visitor(ValueSizeGetter(), *this);
 }
 
@@ -149,7 +480,11 @@ Value \
     { \
         throw Exception("Type mismatch"); \
     } \
-    return this->_##name; \
+    else if(this->_representation == Representation::Encoded) \
+    { \
+        return this->_get_decoded().as_##name(); \
+    } \
+    return get(this->_storage.name); \
 }
 
 #define DECLARE_NON_CONST_ACCESSOR(type, name) \
@@ -161,11 +496,43 @@ Value \
     { \
         throw Exception("Type mismatch"); \
     } \
-    return this->_##name; \
+    this->_decode(); \
+    this->_clear_derived(); \
+    this->_exposed = true; \
+    this->_has_hash = false; \
+    return detach(this->_storage.name); \
 }
 
-DECLARE_CONST_ACCESSOR(Integers, integers)
-DECLARE_NON_CONST_ACCESSOR(Integers, integers)
+Value::Integers const &
+Value
+::as_integers() const
+{
+    if(this->get_type() != Type::Integers)
+    {
+        throw Exception("Type mismatch");
+    }
+    else if(this->_representation == Representation::Encoded)
+    {
+        return this->_get_decoded().as_integers();
+    }
+    return this->_get_integers();
+}
+
+Value::Integers &
+Value
+::as_integers()
+{
+    if(this->get_type() != Type::Integers)
+    {
+        throw Exception("Type mismatch");
+    }
+    this->_decode();
+    this->_widen_integers();
+    this->_clear_derived();
+    this->_exposed = true;
+    this->_has_hash = false;
+    return detach(this->_storage.integers);
+}
 
 DECLARE_CONST_ACCESSOR(Reals, reals)
 DECLARE_NON_CONST_ACCESSOR(Reals, reals)
@@ -173,34 +540,251 @@ DECLARE_NON_CONST_ACCESSOR(Reals, reals)
 DECLARE_CONST_ACCESSOR(Strings, strings)
 DECLARE_NON_CONST_ACCESSOR(Strings, strings)
 
-Value::DataSets const & 
+DECLARE_CONST_ACCESSOR(DataSets, data_sets)
+DECLARE_NON_CONST_ACCESSOR(DataSets, data_sets)
+
+Value::Binary const &
+Value
+::as_binary() const
+{
+    if(this->get_type() != Type::Binary)
+    {
+        throw Exception("Type mismatch");
+    }
+    return this->_get_fragments();
+}
+
+BinaryBuffer const &
 Value
-::as_data_sets() const
+::as_binary_buffer() const
 {
-    if(this->get_type() != Type::DataSets)
+    if(this->get_type() != Type::Binary)
     {
         throw Exception("Type mismatch");
     }
-	return *this->_data_sets;
+    return this->_get_buffer();
 }
 
-Value::DataSets &
+Value::Binary &
 Value
-::as_data_sets()
+::as_binary()
 {
-    if(this->get_type() != Type::DataSets)
+    if(this->get_type() != Type::Binary)
     {
         throw Exception("Type mismatch");
     }
-	return *this->_data_sets;
+    this->_to_fragments();
+    this->_clear_derived();
+    this->_exposed = true;
+    this->_has_hash = false;
+    return detach(this->_storage.binary);
 }
 
-DECLARE_CONST_ACCESSOR(Binary, binary)
-DECLARE_NON_CONST_ACCESSOR(Binary, binary)
+BinaryBuffer &
+Value
+::as_binary_buffer()
+{
+    if(this->get_type() != Type::Binary)
+    {
+        throw Exception("Type mismatch");
+    }
+    this->_to_buffer();
+    this->_clear_derived();
+    this->_exposed = true;
+    this->_has_hash = false;
+    return detach(this->_storage.binary_buffer);
+}
+
+bool
+Value
+::has_binary_buffer() const
+{
+    return (
+        this->_type == Type::Binary
+        && this->_representation != Representation::Default);
+}
+
+bool
+Value
+::has_native_integers() const
+{
+    return this->_representation == Representation::NativeIntegers;
+}
+
+Value::IntegerFormat
+Value
+::get_integer_format() const
+{
+    if(!this->has_native_integers())
+    {
+        throw Exception("Type mismatch");
+    }
+    return this->_storage.native_integers->format;
+}
+
+BinaryBuffer const &
+Value
+::as_native_integers() const
+{
+    if(!this->has_native_integers())
+    {
+        throw Exception("Type mismatch");
+    }
+    return this->_storage.native_integers->data;
+}
+
+bool
+Value
+::is_encoded() const
+{
+    return this->_representation == Representation::Encoded;
+}
+
+BinaryBuffer const &
+Value
+::get_encoded_data() const
+{
+    if(!this->is_encoded())
+    {
+        throw Exception("Value is not encoded");
+    }
+    return this->_storage.encoded->data;
+}
+
+VR
+Value
+::get_encoded_vr() const
+{
+    if(!this->is_encoded())
+    {
+        throw Exception("Value is not encoded");
+    }
+    return this->_storage.encoded->vr;
+}
+
+ByteOrdering
+Value
+::get_encoded_byte_ordering() const
+{
+    if(!this->is_encoded())
+    {
+        throw Exception("Value is not encoded");
+    }
+    return this->_storage.encoded->byte_ordering;
+}
 
 #undef DECLARE_NON_CONST_ACCESSOR
 #undef DECLARE_CONST_ACCESSOR
 
+uint64_t
+Value
+::get_hash() const
+{
+    if(this->_has_hash.load(std::memory_order_acquire))
+    {
+        return this->_hash.load(std::memory_order_relaxed);
+    }
+
+    auto hash = hash_combine(hash_seed, static_cast<uint64_t>(this->_type));
+    if(this->_type == Type::Integers)
+    {
+        if(this->has_native_integers())
+        {
+            // Hash the integers without widening them
+            auto const & native_integers = *this->_storage.native_integers;
+            auto const data = native_integers.data.data();
+            auto const size = this->size();
+            if(native_integers.format == IntegerFormat::Int16)
+            {
+                hash = hash_items<int16_t>(data, size, hash);
+            }
+            else if(native_integers.format == IntegerFormat::UInt16)
+            {
+                hash = hash_items<uint16_t>(data, size, hash);
+            }
+            else if(native_integers.format == IntegerFormat::Int32)
+            {
+                hash = hash_items<int32_t>(data, size, hash);
+            }
+            else
+            {
+                hash = hash_items<uint32_t>(data, size, hash);
+            }
+        }
+        else
+        {
+            for(auto const & integer: this->as_integers())
+            {
+                hash = hash_combine(hash, static_cast<uint64_t>(integer));
+            }
+        }
+    }
+    else if(this->_type == Type::Reals)
+    {
+        for(auto real: this->as_reals())
+        {
+            if(real == 0)
+            {
+                // 0 and -0 are equal
+                real = 0;
+            }
+            hash = hash_combine(hash, hash_bytes(&real, sizeof(real)));
+        }
+    }
+    else if(this->_type == Type::Strings)
+    {
+        for(auto const & string: this->as_strings())
+        {
+            hash = hash_combine(hash, hash_bytes(string.data(), string.size()));
+        }
+    }
+    else if(this->_type == Type::DataSets)
+    {
+        for(auto const & data_set: this->as_data_sets())
+        {
+            hash = hash_combine(hash, data_set.get_hash());
+        }
+    }
+    else if(this->_type == Type::Binary)
+    {
+        // Hash the fragments in the current representation, so that equal
+        // buffers and fragments have the same hash.
+        if(this->has_binary_buffer())
+        {
+            auto const & buffer = this->as_binary_buffer();
+            for(std::size_t i=0; i<buffer.get_fragments_count(); ++i)
+            {
+                hash = hash_combine(
+                    hash,
+                    hash_bytes(
+                        buffer.get_fragment(i), buffer.get_fragment_size(i)));
+            }
+        }
+        else
+        {
+            for(auto const & fragment: this->as_binary())
+            {
+                hash = hash_combine(
+                    hash, hash_bytes(fragment.data(), fragment.size()));
+            }
+        }
+    }
+    else
+    {
+        throw Exception("Unknown type");
+    }
+
+    if(!this->_exposed)
+    {
+        // The content cannot be modified without invalidating the hash.
+        // Concurrent const accesses store the same hash.
+        this->_hash.store(hash, std::memory_order_relaxed);
+        this->_has_hash.store(true, std::memory_order_release);
+    }
+
+    return hash;
+}
+
 bool
 Value
 ::operator==(Value const & other) const
@@ -209,25 +793,74 @@ Value
     {
         return false;
     }
-    else if(this->_type == Value::Type::Integers)
+    else if(
+        this->_has_hash && other._has_hash && this->_hash != other._hash)
+    {
+        // Memoized hashes differ: no need to compare the contents
+        return false;
+    }
+    else if(
+        this->is_encoded() && other.is_encoded()
+        && this->get_encoded_vr() == other.get_encoded_vr()
+        && this->get_encoded_byte_ordering() == other.get_encoded_byte_ordering()
+        && this->get_encoded_data() == other.get_encoded_data())
     {
-        return this->_integers == other._integers;
+        // Same encoded form: no need to decode the values
+        return true;
     }
+
+    // The storage of encoded values does not hold their content
+    bool const decoded = !this->is_encoded() && !other.is_encoded();
+
+    if(this->_type == Value::Type::Integers)
+    {
+        if(this->has_native_integers() && other.has_native_integers()
+            && this->get_integer_format() == other.get_integer_format())
+        {
+            return this->as_native_integers() == other.as_native_integers();
+        }
+        return this->as_integers() == other.as_integers();
+    }
+    // Values sharing their content (copies, or values from a StringPool)
+    // are equal.
     else if(this->_type == Value::Type::Reals)
     {
-        return this->_reals == other._reals;
+        return (
+            (decoded && this->_storage.reals == other._storage.reals)
+            || this->as_reals() == other.as_reals());
     }
     else if(this->_type == Value::Type::Strings)
     {
-        return this->_strings == other._strings;
+        return (
+            (decoded && this->_storage.strings == other._storage.strings)
+            || this->as_strings() == other.as_strings());
     }
     else if(this->_type == Value::Type::DataSets)
     {
-        return *(this->_data_sets) == *(other._data_sets);
+        return (
+            (decoded && this->_storage.data_sets == other._storage.data_sets)
+            || this->as_data_sets() == other.as_data_sets());
     }
     else if(this->_type == Value::Type::Binary)
     {
-        return this->_binary == other._binary;
+        // Compare the values in their current representations, to avoid
+        // converting them.
+        if(this->has_binary_buffer() && other.has_binary_buffer())
+        {
+            return this->as_binary_buffer() == other.as_binary_buffer();
+        }
+        else if(this->has_binary_buffer())
+        {
+            return equal(this->as_binary_buffer(), other.as_binary());
+        }
+        else if(other.has_binary_buffer())
+        {
+            return equal(other.as_binary_buffer(), this->as_binary());
+        }
+        else
+        {
+            return this->as_binary() == other.as_binary();
+        }
     }
     else
     {
@@ -246,8 +879,472 @@ void
 Value
 ::clear()
 {
-    apply_visitor(ClearValue(), *this);
+    this->_clear_derived();
+    this->_has_hash = false;
+    if(this->_representation != Representation::Default)
+    {
+        // Don't load, decode or convert the content only to discard it
+        this->_reset();
+    }
+    else if(this->_type == Type::Integers)
+    {
+        this->_clear(this->_storage.integers);
+    }
+    else if(this->_type == Type::Reals)
+    {
+        this->_clear(this->_storage.reals);
+    }
+    else if(this->_type == Type::Strings)
+    {
+        this->_clear(this->_storage.strings);
+    }
+    else if(this->_type == Type::DataSets)
+    {
+        this->_clear(this->_storage.data_sets);
+    }
+    else
+    {
+        this->_clear(this->_storage.binary);
+    }
+}
+
+void
+Value
+::_construct(Value const & other)
+{
+    if(this->_representation == Representation::NativeIntegers)
+    {
+        // Native integers are never modified
+        construct(
+            this->_storage.native_integers, other._storage.native_integers);
+    }
+    else if(this->_representation == Representation::Encoded)
+    {
+        // Encoded values are never modified
+        construct(this->_storage.encoded, other._storage.encoded);
+    }
+    else if(this->_type == Type::Integers)
+    {
+        construct(
+            this->_storage.integers,
+            share(other._storage.integers, other._exposed));
+    }
+    else if(this->_type == Type::Reals)
+    {
+        construct(
+            this->_storage.reals, share(other._storage.reals, other._exposed));
+    }
+    else if(this->_type == Type::Strings)
+    {
+        construct(
+            this->_storage.strings,
+            share(other._storage.strings, other._exposed));
+    }
+    else if(this->_type == Type::DataSets)
+    {
+        construct(
+            this->_storage.data_sets,
+            share(other._storage.data_sets, other._exposed));
+    }
+    else if(this->_representation == Representation::Default)
+    {
+        construct(
+            this->_storage.binary, share(other._storage.binary, other._exposed));
+    }
+    else if(this->_representation == Representation::Buffer)
+    {
+        construct(
+            this->_storage.binary_buffer,
+            share(other._storage.binary_buffer, other._exposed));
+    }
+    else
+    {
+        // The loader is never modified
+        construct(this->_storage.binary_loader, other._storage.binary_loader);
+    }
+}
+
+void
+Value
+::_construct(Value && other) noexcept
+{
+    if(this->_representation == Representation::NativeIntegers)
+    {
+        construct(
+            this->_storage.native_integers,
+            std::move(other._storage.native_integers));
+        other._reset();
+    }
+    else if(this->_representation == Representation::Encoded)
+    {
+        construct(this->_storage.encoded, std::move(other._storage.encoded));
+        other._reset();
+    }
+    else if(this->_type == Type::Integers)
+    {
+        construct(this->_storage.integers, std::move(other._storage.integers));
+    }
+    else if(this->_type == Type::Reals)
+    {
+        construct(this->_storage.reals, std::move(other._storage.reals));
+    }
+    else if(this->_type == Type::Strings)
+    {
+        construct(this->_storage.strings, std::move(other._storage.strings));
+    }
+    else if(this->_type == Type::DataSets)
+    {
+        construct(
+            this->_storage.data_sets, std::move(other._storage.data_sets));
+    }
+    else if(this->_representation == Representation::Default)
+    {
+        construct(this->_storage.binary, std::move(other._storage.binary));
+    }
+    else
+    {
+        if(this->_representation == Representation::Buffer)
+        {
+            construct(
+                this->_storage.binary_buffer,
+                std::move(other._storage.binary_buffer));
+        }
+        else
+        {
+            construct(
+                this->_storage.binary_loader,
+                std::move(other._storage.binary_loader));
+        }
+
+        other._reset();
+    }
+
+    // The content of other, if any, is now empty and not shared.
+    other._exposed = false;
+    other._has_hash = false;
+}
+
+void
+Value
+::_destroy()
+{
+    if(this->_representation == Representation::NativeIntegers)
+    {
+        destroy(this->_storage.native_integers);
+    }
+    else if(this->_representation == Representation::Encoded)
+    {
+        destroy(this->_storage.encoded);
+    }
+    else if(this->_type == Type::Integers)
+    {
+        destroy(this->_storage.integers);
+    }
+    else if(this->_type == Type::Reals)
+    {
+        destroy(this->_storage.reals);
+    }
+    else if(this->_type == Type::Strings)
+    {
+        destroy(this->_storage.strings);
+    }
+    else if(this->_type == Type::DataSets)
+    {
+        destroy(this->_storage.data_sets);
+    }
+    else if(this->_representation == Representation::Default)
+    {
+        destroy(this->_storage.binary);
+    }
+    else if(this->_representation == Representation::Buffer)
+    {
+        destroy(this->_storage.binary_buffer);
+    }
+    else
+    {
+        destroy(this->_storage.binary_loader);
+    }
+}
+
+void
+Value
+::_reset() noexcept
+{
+    this->_destroy();
+    this->_clear_derived();
+    // The new content has not been exposed
+    this->_exposed = false;
+    this->_representation = Representation::Default;
+    if(this->_type == Type::Integers)
+    {
+        construct(this->_storage.integers);
+    }
+    else if(this->_type == Type::Reals)
+    {
+        construct(this->_storage.reals);
+    }
+    else if(this->_type == Type::Strings)
+    {
+        construct(this->_storage.strings);
+    }
+    else if(this->_type == Type::DataSets)
+    {
+        construct(this->_storage.data_sets);
+    }
+    else
+    {
+        construct(this->_storage.binary);
+    }
+}
+
+template<typename T>
+void
+Value
+::_clear(std::shared_ptr<T> & content)
+{
+    if(content.use_count() == 1)
+    {
+        // Keep references returned to the user valid
+        content->clear();
+    }
+    else
+    {
+        // The new content has not been exposed
+        content.reset();
+        this->_exposed = false;
+    }
 }
 
+Value::Derived &
+Value
+::_get_derived() const
+{
+    auto derived = this->_derived.load(std::memory_order_acquire);
+    if(derived == nullptr)
+    {
+        // Concurrent const accesses may all create the derived
+        // representations: only the first one is kept.
+        std::unique_ptr<Derived> created(new Derived());
+        if(this->_derived.compare_exchange_strong(
+            derived, created.get(), std::memory_order_acq_rel))
+        {
+            derived = created.release();
+        }
+    }
+    return *derived;
 }
 
+void
+Value
+::_clear_derived() noexcept
+{
+    delete this->_derived.exchange(nullptr);
+}
+
+BinaryBuffer const &
+Value
+::_get_buffer() const
+{
+    if(this->_representation == Representation::Buffer)
+    {
+        return *this->_storage.binary_buffer;
+    }
+
+    auto & derived = this->_get_derived();
+    // If the conversion or the loader fails, the next access tries again.
+    std::call_once(
+        derived.buffer_flag,
+        [this, &derived]()
+        {
+            derived.buffer = std::make_shared<BinaryBuffer>(
+                (this->_representation == Representation::Deferred)
+                ?(*this->_storage.binary_loader)()
+                :BinaryBuffer(get(this->_storage.binary)));
+        });
+    return *derived.buffer;
+}
+
+Value::Binary const &
+Value
+::_get_fragments() const
+{
+    if(this->_representation == Representation::Default)
+    {
+        return get(this->_storage.binary);
+    }
+
+    auto const & buffer = this->_get_buffer();
+    auto & derived = this->_get_derived();
+    std::call_once(
+        derived.fragments_flag,
+        [&buffer, &derived]()
+        {
+            derived.fragments = std::make_shared<Binary>(buffer.to_fragments());
+        });
+    return *derived.fragments;
+}
+
+void
+Value
+::_load_binary()
+{
+    if(this->_representation == Representation::Deferred)
+    {
+        // Keep the content loaded by a const accessor, if any. Load before
+        // destroying the loader, in case loading fails.
+        auto const derived = this->_derived.load();
+        auto buffer = (derived != nullptr && derived->buffer)
+            ?derived->buffer
+            :std::make_shared<BinaryBuffer>((*this->_storage.binary_loader)());
+        destroy(this->_storage.binary_loader);
+        construct(this->_storage.binary_buffer, std::move(buffer));
+        this->_representation = Representation::Buffer;
+        this->_clear_derived();
+    }
+}
+
+void
+Value
+::_to_fragments()
+{
+    this->_load_binary();
+    if(this->_representation == Representation::Buffer)
+    {
+        // Keep the fragments converted by a const accessor, if any
+        auto const derived = this->_derived.load();
+        auto fragments = (derived != nullptr && derived->fragments)
+            ?derived->fragments
+            :std::make_shared<Binary>(
+                this->_storage.binary_buffer->to_fragments());
+        destroy(this->_storage.binary_buffer);
+        construct(this->_storage.binary, std::move(fragments));
+        this->_representation = Representation::Default;
+        this->_clear_derived();
+        this->_exposed = false;
+    }
+}
+
+void
+Value
+::_to_buffer()
+{
+    this->_load_binary();
+    if(this->_representation == Representation::Default)
+    {
+        // Keep the buffer converted by a const accessor, if any
+        auto const derived = this->_derived.load();
+        auto buffer = (derived != nullptr && derived->buffer)
+            ?derived->buffer
+            :std::make_shared<BinaryBuffer>(get(this->_storage.binary));
+        destroy(this->_storage.binary);
+        construct(this->_storage.binary_buffer, std::move(buffer));
+        this->_representation = Representation::Buffer;
+        this->_clear_derived();
+        this->_exposed = false;
+    }
+}
+
+Value::Integers const &
+Value
+::_get_integers() const
+{
+    if(this->_representation != Representation::NativeIntegers)
+    {
+        return get(this->_storage.integers);
+    }
+
+    auto & derived = this->_get_derived();
+    std::call_once(
+        derived.integers_flag,
+        [this, &derived]()
+        {
+            auto const & native_integers = *this->_storage.native_integers;
+            auto const data = native_integers.data.data();
+            auto integers = std::make_shared<Integers>(
+                native_integers.data.size()/get_width(native_integers.format));
+            if(native_integers.format == IntegerFormat::Int16)
+            {
+                widen<int16_t>(data, *integers);
+            }
+            else if(native_integers.format == IntegerFormat::UInt16)
+            {
+                widen<uint16_t>(data, *integers);
+            }
+            else if(native_integers.format == IntegerFormat::Int32)
+            {
+                widen<int32_t>(data, *integers);
+            }
+            else
+            {
+                widen<uint32_t>(data, *integers);
+            }
+            derived.integers = std::move(integers);
+        });
+    return *derived.integers;
+}
+
+void
+Value
+::_widen_integers()
+{
+    if(this->_representation == Representation::NativeIntegers)
+    {
+        // Keep the integers widened by a const accessor, if any
+        this->_get_integers();
+        auto integers = this->_derived.load()->integers;
+        destroy(this->_storage.native_integers);
+        construct(this->_storage.integers, std::move(integers));
+        this->_representation = Representation::Default;
+        this->_clear_derived();
+    }
+}
+
+Value const &
+Value
+::_get_decoded() const
+{
+    auto & derived = this->_get_derived();
+    std::call_once(
+        derived.decoded_flag,
+        [this, &derived]()
+        {
+            auto const & encoded = *this->_storage.encoded;
+
+            // Decode as the reader does; the explicit-ness of the VR is not
+            // relevant for the value itself.
+            std::istringstream stream(
+                std::string(
+                    reinterpret_cast<char const *>(encoded.data.data()),
+                    encoded.data.size()));
+            Reader const reader(
+                stream,
+                (encoded.byte_ordering == ByteOrdering::BigEndian)
+                    ?registry::ExplicitVRBigEndian_Retired
+                    :registry::ExplicitVRLittleEndian);
+            auto element = reader.read_element(
+                Tag(0xffff, 0xffff), encoded.vr, encoded.data.size());
+            derived.decoded = std::make_shared<Value>(element.get_value());
+        });
+    return *derived.decoded;
+}
+
+void
+Value
+::_decode()
+{
+    if(this->_representation == Representation::Encoded)
+    {
+        // Keep the value decoded by a const accessor, if any, along with its
+        // own derived representations.
+        this->_get_decoded();
+        Value value(std::move(*this->_derived.load()->decoded));
+        auto const derived = value._derived.exchange(nullptr);
+        this->_destroy();
+        this->_clear_derived();
+        this->_representation = value._representation;
+        this->_construct(std::move(value));
+        this->_derived = derived;
+    }
+}
+
+}
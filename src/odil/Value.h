@@ -9,13 +9,18 @@
 #ifndef _dca5b15b_b8df_4925_a446_d42efe06c923
 #define _dca5b15b_b8df_4925_a446_d42efe06c923
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "odil/BinaryBuffer.h"
+#include "odil/endian.h"
 #include "odil/odil.h"
+#include "odil/VR.h"
 
 namespace odil
 {
@@ -24,6 +29,18 @@ class DataSet;
 
 /**
  * @brief A value held in a DICOM element.
+ *
+ * Copies of a value share its content, which is copied only when it is
+ * accessed through a non-const accessor while being shared.
+ *
+ * Const accessors never modify the stored content. When it must be converted
+ * (binary content stored as a contiguous buffer and accessed as fragments or
+ * vice versa, integers stored in their native width, encoded values), the
+ * converted content is kept next to the stored one. The references returned
+ * by const accessors thus remain valid until the value is modified, and
+ * concurrent const accesses are safe. Non-const accessors may replace the
+ * stored content by its converted form, which invalidates the references
+ * returned for the other forms.
  */
 class ODIL_API Value
 {
@@ -62,6 +79,24 @@ public:
     /// @brief Binary data container.
     typedef std::vector<std::vector<uint8_t>> Binary;
 
+    /// @brief Function returning the content of a deferred binary value.
+    typedef std::function<BinaryBuffer()> BinaryLoader;
+
+    /// @brief Fixed-width formats of integers stored in their native width.
+    enum class IntegerFormat
+    {
+        Int16,
+        UInt16,
+        Int32,
+        UInt32
+    };
+
+    /**
+     * @brief Return whether integers encoded with the given VR have a
+     * fixed-width format, and set it.
+     */
+    static bool get_integer_format(VR vr, IntegerFormat & format);
+
 #define ODIL_VALUE_CONSTRUCTORS(type) \
     Value(type const & value); \
     Value(type && value); \
@@ -82,14 +117,38 @@ public:
 
     Value(std::initializer_list<std::initializer_list<uint8_t>> const & value);
 
+    /// @brief Create a binary value stored in a contiguous buffer.
+    Value(BinaryBuffer const & value);
+
+    /// @brief Create a binary value stored in a contiguous buffer.
+    Value(BinaryBuffer && value);
+
+    /**
+     * @brief Create integers stored in their native width, in host byte
+     * order; they are widened when first accessed as Integers.
+     */
+    Value(BinaryBuffer const & data, IntegerFormat format);
+
+    /**
+     * @brief Create an integer, real or string value from its encoded form,
+     * which is decoded when the value is first accessed.
+     */
+    Value(BinaryBuffer const & data, VR vr, ByteOrdering byte_ordering);
+
+    /**
+     * @brief Create a binary value whose content is returned by the loader
+     * when the value is first accessed.
+     */
+    Value(BinaryLoader const & loader);
+
     /** @addtogroup default_operations Default class operations
      * @{
      */
-    ~Value() =default;
-    Value(Value const &) =default;
-    Value(Value &&) =default;
-    Value & operator=(Value const &) =default;
-    Value & operator=(Value &&) =default;
+    ~Value();
+    Value(Value const & other);
+    Value(Value && other) noexcept;
+    Value & operator=(Value const & other);
+    Value & operator=(Value && other) noexcept;
     /// @}
 
     /// @brief Return the type store in the value.
@@ -171,6 +230,83 @@ public:
      */
     Binary & as_binary();
 
+    /**
+     * @brief Return the binary data contained in the value, as a contiguous
+     * buffer.
+     *
+     * If the value does not contain binary data, a odil::Exception is raised.
+     */
+    BinaryBuffer const & as_binary_buffer() const;
+
+    /**
+     * @brief Return the binary data contained in the value, as a contiguous
+     * buffer.
+     *
+     * If the value does not contain binary data, a odil::Exception is raised.
+     */
+    BinaryBuffer & as_binary_buffer();
+
+    /**
+     * @brief Test whether the value contains binary data which can be
+     * accessed by as_binary_buffer without being copied.
+     */
+    bool has_binary_buffer() const;
+
+    /**
+     * @brief Test whether the value contains integers which are still
+     * stored in their native width.
+     */
+    bool has_native_integers() const;
+
+    /**
+     * @brief Return the format of the integers stored in their native width.
+     *
+     * If the value does not contain such integers, a odil::Exception is
+     * raised.
+     */
+    IntegerFormat get_integer_format() const;
+
+    /**
+     * @brief Return the integers stored in their native width, in host byte
+     * order.
+     *
+     * If the value does not contain such integers, a odil::Exception is
+     * raised.
+     */
+    BinaryBuffer const & as_native_integers() const;
+
+    /// @brief Test whether the value is still in its encoded form.
+    bool is_encoded() const;
+
+    /**
+     * @brief Return the encoded form of the value.
+     *
+     * If the value is not in its encoded form, a odil::Exception is raised.
+     */
+    BinaryBuffer const & get_encoded_data() const;
+
+    /**
+     * @brief Return the VR of the encoded form of the value.
+     *
+     * If the value is not in its encoded form, a odil::Exception is raised.
+     */
+    VR get_encoded_vr() const;
+
+    /**
+     * @brief Return the byte ordering of the encoded form of the value.
+     *
+     * If the value is not in its encoded form, a odil::Exception is raised.
+     */
+    ByteOrdering get_encoded_byte_ordering() const;
+
+    /**
+     * @brief Return a hash of the content: equal values have equal hashes.
+     *
+     * The hash is memoized until the value is modified, and memoized hashes
+     * are used to speed up the equality test.
+     */
+    uint64_t get_hash() const;
+
     /// @brief Equality test.
     bool operator==(Value const & other) const;
 
@@ -181,15 +317,151 @@ public:
     void clear();
 
 private:
-    Integers _integers;
-    Reals _reals;
-    Strings _strings;
-    // NOTE: can't use std::vector<DataSet> with forward-declaration of DataSet
-    // cf. C++11, 17.6.4.8, last bullet of clause 2
-    std::shared_ptr<DataSets> _data_sets;
-    Binary _binary;
+    /// @brief Integers stored in their native width.
+    struct NativeIntegers
+    {
+        IntegerFormat format;
+        BinaryBuffer data;
+    };
+
+    /// @brief Encoded form of a value.
+    struct Encoded
+    {
+        BinaryBuffer data;
+        VR vr;
+        ByteOrdering byte_ordering;
+    };
+
+    /**
+     * @brief Storage of the active alternative only. The content is shared
+     * between copies of the value until it is modified; an empty pointer
+     * stands for an empty content.
+     */
+    union Storage
+    {
+        std::shared_ptr<Integers> integers;
+        std::shared_ptr<Reals> reals;
+        std::shared_ptr<Strings> strings;
+        // NOTE: can't use std::vector<DataSet> with forward-declaration of
+        // DataSet cf. C++11, 17.6.4.8, last bullet of clause 2
+        std::shared_ptr<DataSets> data_sets;
+        std::shared_ptr<Binary> binary;
+        std::shared_ptr<BinaryBuffer> binary_buffer;
+        /// @brief Loader of deferred binary content, active until loaded.
+        std::shared_ptr<BinaryLoader> binary_loader;
+        /// @brief Integers in their native width, active until widened.
+        std::shared_ptr<NativeIntegers> native_integers;
+        /// @brief Encoded form, active until decoded.
+        std::shared_ptr<Encoded> encoded;
+
+        Storage();
+        ~Storage();
+    };
+
+    Storage _storage;
+
+    /**
+     * @brief Representations derived from the stored one by const accessors.
+     * Each of them is computed once and kept until the value is modified, so
+     * that the references returned by const accessors remain valid and that
+     * concurrent const accesses are safe.
+     */
+    struct Derived;
+
+    /// @brief Derived representations, created on demand.
+    mutable std::atomic<Derived *> _derived;
 
     Type _type;
+
+    /// @brief Representations of the content, converted on demand.
+    enum class Representation: uint8_t
+    {
+        Default,
+        Buffer,
+        Deferred,
+        NativeIntegers,
+        Encoded
+    };
+
+    /// @brief Active representation of the content.
+    Representation _representation;
+
+    /**
+     * @brief Whether a non-const reference to the content has been returned:
+     * copies of the value may not share it anymore. Reset when the content
+     * is replaced (assignment, clear of a shared content, conversion).
+     */
+    bool _exposed;
+
+    /// @brief Whether the hash of the content is memoized.
+    mutable std::atomic<bool> _has_hash;
+
+    /// @brief Memoized hash of the content.
+    mutable std::atomic<uint64_t> _hash;
+
+    /// @brief Construct the storage from the active alternative of other.
+    void _construct(Value const & other);
+
+    /// @brief Construct the storage from the active alternative of other.
+    void _construct(Value && other) noexcept;
+
+    /// @brief Destroy the active alternative.
+    void _destroy();
+
+    /**
+     * @brief Replace the content by an empty content of the same type, in
+     * the default representation.
+     */
+    void _reset() noexcept;
+
+    /// @brief Clear the content, or stop sharing it.
+    template<typename T>
+    void _clear(std::shared_ptr<T> & content);
+
+    /// @brief Return the derived representations, create them if needed.
+    Derived & _get_derived() const;
+
+    /// @brief Discard the derived representations.
+    void _clear_derived() noexcept;
+
+    /**
+     * @brief Return the binary content as a contiguous buffer, convert or
+     * load it in the derived representations if needed.
+     */
+    BinaryBuffer const & _get_buffer() const;
+
+    /**
+     * @brief Return the binary content as fragments, convert it in the
+     * derived representations if needed.
+     */
+    Binary const & _get_fragments() const;
+
+    /// @brief Replace the deferred binary content by its loaded form, if any.
+    void _load_binary();
+
+    /// @brief Replace the binary content by its fragments.
+    void _to_fragments();
+
+    /// @brief Replace the binary content by its contiguous buffer.
+    void _to_buffer();
+
+    /**
+     * @brief Return the integers, widen them in the derived representations
+     * if they are stored in their native width.
+     */
+    Integers const & _get_integers() const;
+
+    /**
+     * @brief Replace the integers stored in their native width by their
+     * widened form, if any.
+     */
+    void _widen_integers();
+
+    /// @brief Return the decoded form of the value, decode it if needed.
+    Value const & _get_decoded() const;
+
+    /// @brief Replace the encoded form of the value by its decoded form.
+    void _decode();
 };
 
 /**
@@ -208,6 +480,21 @@ apply_visitor(TVisitor const & visitor, Value & value);
 
 }
 
+namespace std
+{
+
+/// @brief Hash of values, to use them as keys of unordered containers.
+template<>
+struct hash<odil::Value>
+{
+    std::size_t operator()(odil::Value const & value) const
+    {
+        return static_cast<std::size_t>(value.get_hash());
+    }
+};
+
+}
+
 #include "odil/Value.txx"
 
 #endif // _dca5b15b_b8df_4925_a446_d42efe06c923
@@ -8,13 +8,16 @@
 
 #include "odil/Writer.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <map>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "odil/DataSet.h"
 #include "odil/endian.h"
@@ -26,47 +29,265 @@
 #include "odil/VR.h"
 #include "odil/write_ds.h"
 
-namespace odil
+namespace
 {
 
-void
-Writer
-::write_encapsulated_pixel_data(
-    Value::Binary const & value, std::ostream & stream,
-    ByteOrdering byte_ordering, bool explicit_vr)
+/// @brief Test whether the VL of the VR is stored on 4 bytes in explicit VR.
+bool has_long_length(odil::VR vr)
 {
-    Writer writer(stream, byte_ordering, explicit_vr);
-    uint32_t length;
-    for(auto const & fragment: value)
+    // PS 3.5, 7.1.2
+    return (
+        vr == odil::VR::OB || vr == odil::VR::OD || vr == odil::VR::OF
+        || vr == odil::VR::OL || vr == odil::VR::OW || vr == odil::VR::SQ
+        || vr == odil::VR::UC || vr == odil::VR::UR || vr == odil::VR::UT
+        || vr == odil::VR::UN);
+}
+
+/// @brief Return the length of the VR and VL fields of an element.
+uint32_t get_header_length(odil::VR vr, bool explicit_vr)
+{
+    return (explicit_vr && has_long_length(vr))?8:4;
+}
+
+/// @brief Return the length of a string.
+uint32_t get_text_length(odil::Value::String const & value)
+{
+    return value.size();
+}
+
+/// @brief Return the length of the decimal representation of an integer.
+uint32_t get_text_length(odil::Value::Integer value)
+{
+    uint32_t length = (value < 0)?2:1;
+    while(value <= -10 || value >= 10)
     {
-        writer.write_tag(registry::Item);
-        length = fragment.size();
-        Writer::write_binary(length, stream, byte_ordering);
-        if(length > 0)
+        value /= 10;
+        ++length;
+    }
+    return length;
+}
+
+/// @brief Write a string item.
+void write_text(std::ostream & stream, odil::Value::String const & value)
+{
+    stream.write(value.data(), value.size());
+}
+
+/// @brief Write the decimal representation of an integer item.
+void write_text(std::ostream & stream, odil::Value::Integer value)
+{
+    // Sign, 19 digits and NUL
+    char buffer[21];
+    odil::write_is(value, buffer);
+    stream.write(buffer, std::strlen(buffer));
+}
+
+/**
+ * @brief Append the formatted items of a DS value, with their separators and
+ * padding, to text and return its length.
+ */
+uint32_t format_ds(odil::Value::Reals const & value, std::string & text)
+{
+    auto const begin = text.size();
+    for(std::size_t i=0; i<value.size(); ++i)
+    {
+        if(i != 0)
+        {
+            text.push_back('\\');
+        }
+
+        // Each item in the DS is at most 16 bytes, account for NUL at end.
+        // Non-finite items are rejected by write_ds.
+        char buffer[16+1];
+        odil::write_ds(value[i], buffer, 16);
+        text.append(buffer);
+    }
+    if((text.size()-begin)%2 == 1)
+    {
+        text.push_back(' ');
+    }
+    return text.size()-begin;
+}
+
+/// @brief Return the length of a list of items, including the padding.
+template<typename T, typename F>
+uint32_t get_strings_length(T const & sequence, F const & get_item_length)
+{
+    uint32_t length = 0;
+    for(auto const & item: sequence)
+    {
+        length += get_item_length(item);
+    }
+    length += sequence.size()-1;
+    return length+length%2;
+}
+
+/// @brief Return the length of encapsulated pixel data.
+uint32_t get_encapsulated_length(odil::BinaryBuffer const & value)
+{
+    uint32_t length = 8;
+    for(std::size_t i=0; i<value.get_fragments_count(); ++i)
+    {
+        length += 8+value.get_fragment_size(i);
+    }
+    return length;
+}
+
+/**
+ * @brief Return the length of an non-empty value which is not a sequence, as
+ * written by Writer::write_element. DS values are formatted and appended to
+ * ds_values.
+ */
+uint32_t get_value_length(
+    odil::Value const & value, odil::VR vr, std::string & ds_values)
+{
+    using odil::VR;
+    using odil::Value;
+
+    Value::IntegerFormat format;
+    if(value.is_encoded() && value.get_encoded_vr() == vr)
+    {
+        return value.get_encoded_data().size();
+    }
+    else if(value.has_binary_buffer())
+    {
+        auto const & buffer = value.as_binary_buffer();
+        return (buffer.get_fragments_count() > 1)
+            ?get_encapsulated_length(buffer)
+            :(buffer.size()+buffer.size()%2);
+    }
+    else if(
+        value.has_native_integers()
+        && Value::get_integer_format(vr, format)
+        && format == value.get_integer_format())
+    {
+        return value.as_native_integers().size();
+    }
+    else if(value.get_type() == Value::Type::Integers)
+    {
+        auto const & integers = value.as_integers();
+        if(vr == VR::IS)
+        {
+            return get_strings_length(
+                integers,
+                [](Value::Integer item) { return get_text_length(item); });
+        }
+        else if(vr == VR::SL || vr == VR::UL)
+        {
+            return 4*integers.size();
+        }
+        else if(vr == VR::SS || vr == VR::US || vr == VR::AT)
+        {
+            return 2*integers.size();
+        }
+        else
+        {
+            throw odil::Exception(
+                "Cannot write " + odil::as_string(vr) + " as integers");
+        }
+    }
+    else if(value.get_type() == Value::Type::Reals)
+    {
+        auto const & reals = value.as_reals();
+        if(vr == VR::DS)
+        {
+            return format_ds(reals, ds_values);
+        }
+        else if(vr == VR::FD)
+        {
+            return 8*reals.size();
+        }
+        else if(vr == VR::FL)
+        {
+            return 4*reals.size();
+        }
+        else
+        {
+            throw odil::Exception(
+                "Cannot write " + odil::as_string(vr) + " as reals");
+        }
+    }
+    else if(value.get_type() == Value::Type::Strings)
+    {
+        auto const & strings = value.as_strings();
+        if(vr == VR::AT)
+        {
+            return 4*strings.size();
+        }
+        else
+        {
+            return get_strings_length(
+                strings,
+                [](Value::String const & item) { return get_text_length(item); });
+        }
+    }
+    else if(value.get_type() == Value::Type::Binary)
+    {
+        auto const & binary = value.as_binary();
+        if(binary.size() > 1)
         {
-            stream.write(reinterpret_cast<char const*>(&fragment[0]), length);
-            if(!stream)
+            uint32_t length = 8;
+            for(auto const & fragment: binary)
             {
-                throw Exception("Could not write to stream");
+                length += 8+fragment.size();
             }
+            return length;
+        }
+        else
+        {
+            return binary[0].size()+binary[0].size()%2;
         }
     }
-    writer.write_tag(registry::SequenceDelimitationItem);
-    length = 0;
-    Writer::write_binary(length, stream, byte_ordering);
-    if(!stream)
+    else
     {
-        throw Exception("Could not write to stream");
+        throw odil::Exception("Unknown value type");
     }
 }
 
+}
+
+namespace odil
+{
+
+void
+Writer
+::write_encapsulated_pixel_data(
+    Value::Binary const & value, std::ostream & stream,
+    ByteOrdering byte_ordering, bool explicit_vr)
+{
+    Writer::_write_encapsulated_pixel_data(
+        value, stream, byte_ordering, explicit_vr, nullptr);
+}
+
+void
+Writer
+::write_encapsulated_pixel_data(
+    BinaryBuffer const & value, std::ostream & stream,
+    ByteOrdering byte_ordering, bool explicit_vr)
+{
+    Writer::_write_encapsulated_pixel_data(
+        value, stream, byte_ordering, explicit_vr, nullptr);
+}
+
+Writer
+::Writer(
+    SegmentList & segments,
+    std::string const & transfer_syntax,
+    ItemEncoding item_encoding, bool use_group_length)
+: Writer(
+    segments.get_stream(), transfer_syntax, item_encoding, use_group_length)
+{
+    this->_segments = &segments;
+}
+
 Writer
 ::Writer(
     std::ostream & stream,
     ByteOrdering byte_ordering, bool explicit_vr, ItemEncoding item_encoding,
     bool use_group_length)
 : stream(stream), byte_ordering(byte_ordering), explicit_vr(explicit_vr),
-    item_encoding(item_encoding), use_group_length(use_group_length)
+    item_encoding(item_encoding), use_group_length(use_group_length),
+    _segments(nullptr)
 {
     // Nothing else
 }
@@ -81,60 +302,55 @@ Writer
         (transfer_syntax==registry::ExplicitVRBigEndian_Retired)?
         ByteOrdering::BigEndian:ByteOrdering::LittleEndian),
     explicit_vr(transfer_syntax!=registry::ImplicitVRLittleEndian),
-    item_encoding(item_encoding), use_group_length(use_group_length)
+    item_encoding(item_encoding), use_group_length(use_group_length),
+    _segments(nullptr)
 {
     // Nothing else
 }
 
-void
+std::size_t
 Writer
-::write_data_set(DataSet const & data_set) const
+::encoded_size(
+    DataSet const & data_set, std::string const & transfer_syntax,
+    ItemEncoding item_encoding, bool use_group_length)
 {
-    // Build a map of the different group in order to handle
-    // Group Length elements
-    std::map<uint16_t, std::vector<Tag>> groups;
-    for(auto const & item: data_set)
-    {
-        auto const & tag = item.first;
-        groups[tag.group].push_back(tag);
-    }
+    // Nothing is written to the stream
+    std::ostream stream(nullptr);
+    Writer const writer(stream, transfer_syntax, item_encoding, use_group_length);
+    return writer.get_encoded_size(data_set);
+}
 
-    for(auto const & groups_it: groups)
-    {
-        std::ostringstream group_stream;
-        Writer group_writer(
-            group_stream, this->byte_ordering, this->explicit_vr,
-            this->item_encoding, this->use_group_length);
+std::size_t
+Writer
+::get_encoded_size(DataSet const & data_set) const
+{
+    return this->get_lengths(data_set).size;
+}
 
-        for(auto const & tag: groups_it.second)
-        {
-            group_writer.write_tag(tag);
-            group_writer.write_element(data_set[tag]);
-        }
+Writer::Lengths
+Writer
+::get_lengths(DataSet const & data_set) const
+{
+    Lengths lengths;
+    lengths.size = this->_get_length(data_set, lengths);
+    return lengths;
+}
 
-        // Write group length if necessary
-        // Mandatory for group 0: PS3.7, 9.3, 10.3, and E.1
-        // Mandatory for group 2: PS3.10, 7.1
-        // Forbidden for groups 4 and 6?
-        auto const write_group_length = (
-            groups_it.first == 0 || groups_it.first == 2 ||
-            (this->use_group_length && groups_it.first != 4 && groups_it.first != 6));
-        if(write_group_length)
-        {
-            // Group length: (gggg,0000) UL Type=3 VM=1
-            this->write_tag(Tag(groups_it.first, 0));
-            this->write_element(
-                Element(Value::Integers({group_stream.tellp()}), VR::UL));
-        }
+void
+Writer
+::write_data_set(DataSet const & data_set) const
+{
+    // Compute the lengths of the nested containers, then write each byte
+    // directly to the stream.
+    this->write_data_set(data_set, this->get_lengths(data_set));
+}
 
-        // Write group data to main stream
-        std::string const group_data = group_stream.str();
-        this->stream.write(&group_data[0], group_data.size());
-        if(!this->stream)
-        {
-            throw Exception("Could not write to stream");
-        }
-    }
+void
+Writer
+::write_data_set(DataSet const & data_set, Lengths const & lengths) const
+{
+    Cursor cursor{0, 0};
+    this->_write_data_set(data_set, lengths, cursor);
 }
 
 void
@@ -149,70 +365,11 @@ void
 Writer
 ::write_element(Element const & element) const
 {
-    auto const vr = element.vr;
-
-    // Write VR
-    if(this->explicit_vr)
-    {
-        this->stream << as_string(vr);
-        if(!this->stream)
-        {
-            throw Exception("Could not write to stream");
-        }
-    }
-
-    // Write value to a sub-stream
-    std::ostringstream value_stream;
-    if(!element.get_value().empty())
-    {
-        Visitor const visitor(
-            value_stream, vr, this->byte_ordering, this->explicit_vr,
-            this->item_encoding, this->use_group_length);
-        apply_visitor(visitor, element.get_value());
-    }
-
-    // Write VL
-    if(this->explicit_vr)
-    {
-        if(vr == VR::OB || vr == VR::OD || vr == VR::OF || vr == VR::OL ||
-           vr == VR::OW || vr == VR::SQ || vr == VR::UC || vr == VR::UR || 
-           vr == VR::UT || vr == VR::UN)
-        {
-            this->write_binary(uint16_t(0), this->stream, this->byte_ordering);
-
-            uint32_t vl;
-            if(vr == VR::SQ &&
-                this->item_encoding == ItemEncoding::UndefinedLength)
-            {
-                vl = 0xffffffff;
-            }
-            else if(is_binary(vr) && element.size() > 1)
-            {
-                vl = 0xffffffff;
-            }
-            else
-            {
-               vl = value_stream.tellp();
-            }
-            this->write_binary(vl, this->stream, this->byte_ordering);
-        }
-        else
-        {
-            this->write_binary(
-                uint16_t(value_stream.tellp()), this->stream, this->byte_ordering);
-        }
-    }
-    else
-    {
-        this->write_binary(
-            uint32_t(value_stream.tellp()), this->stream, this->byte_ordering);
-    }
+    Lengths lengths;
+    lengths.size = this->_get_length(element, lengths);
 
-    this->stream.write(value_stream.str().c_str(), value_stream.tellp());
-    if(!this->stream)
-    {
-        throw Exception("Could not write to stream");
-    }
+    Cursor cursor{0, 0};
+    this->_write_element(element, lengths, cursor);
 }
 
 void
@@ -303,13 +460,315 @@ Writer
     data_set_writer.write_data_set(data_set);
 }
 
+void
+Writer
+::_write_raw(
+    std::ostream & stream, uint8_t const * data, std::size_t size,
+    SegmentList * segments, std::shared_ptr<uint8_t const> const & owner)
+{
+    if(segments != nullptr && owner && size >= segments->get_threshold())
+    {
+        // Data written so far is already stored in the segments. The
+        // reference shares the ownership of the data, so that it remains
+        // valid if the value is modified or destroyed.
+        segments->append_reference(
+            std::shared_ptr<uint8_t const>(owner, data), size);
+    }
+    else
+    {
+        stream.write(reinterpret_cast<char const*>(data), size);
+    }
+    if(!stream)
+    {
+        throw Exception("Could not write to stream");
+    }
+}
+
+void
+Writer
+::_write_encapsulated_pixel_data(
+    Value::Binary const & value, std::ostream & stream,
+    ByteOrdering byte_ordering, bool explicit_vr, SegmentList * segments)
+{
+    Writer writer(stream, byte_ordering, explicit_vr);
+    uint32_t length;
+    for(auto const & fragment: value)
+    {
+        writer.write_tag(registry::Item);
+        length = fragment.size();
+        Writer::write_binary(length, stream, byte_ordering);
+        if(length > 0)
+        {
+            // Fragments are not shared: copy them
+            Writer::_write_raw(stream, &fragment[0], length, segments, nullptr);
+        }
+    }
+    writer.write_tag(registry::SequenceDelimitationItem);
+    length = 0;
+    Writer::write_binary(length, stream, byte_ordering);
+    if(!stream)
+    {
+        throw Exception("Could not write to stream");
+    }
+}
+
+void
+Writer
+::_write_encapsulated_pixel_data(
+    BinaryBuffer const & value, std::ostream & stream,
+    ByteOrdering byte_ordering, bool explicit_vr, SegmentList * segments)
+{
+    Writer writer(stream, byte_ordering, explicit_vr);
+    uint32_t length;
+    for(std::size_t i=0; i<value.get_fragments_count(); ++i)
+    {
+        writer.write_tag(registry::Item);
+        length = value.get_fragment_size(i);
+        Writer::write_binary(length, stream, byte_ordering);
+        if(length > 0)
+        {
+            Writer::_write_raw(
+                stream, value.get_fragment(i), length, segments,
+                value.get_shared_data());
+        }
+    }
+    writer.write_tag(registry::SequenceDelimitationItem);
+    length = 0;
+    Writer::write_binary(length, stream, byte_ordering);
+    if(!stream)
+    {
+        throw Exception("Could not write to stream");
+    }
+}
+
+bool
+Writer
+::_has_group_length(uint16_t group) const
+{
+    // Mandatory for group 0: PS3.7, 9.3, 10.3, and E.1
+    // Mandatory for group 2: PS3.10, 7.1
+    // Forbidden for groups 4 and 6?
+    return (
+        group == 0 || group == 2 ||
+        (this->use_group_length && group != 4 && group != 6));
+}
+
+uint32_t
+Writer
+::_get_length(DataSet const & data_set, Lengths & lengths) const
+{
+    uint32_t length = 0;
+
+    // Elements are sorted by tag: the elements of a group are contiguous.
+    auto it = data_set.begin();
+    while(it != data_set.end())
+    {
+        auto const group = it->first.group;
+
+        auto const group_index = lengths.items.size();
+        auto const has_group_length = this->_has_group_length(group);
+        if(has_group_length)
+        {
+            lengths.items.push_back(0);
+        }
+
+        uint32_t group_length = 0;
+        for(/* No initialization */;
+            it != data_set.end() && it->first.group == group; ++it)
+        {
+            group_length += 4+this->_get_length(it->second, lengths);
+        }
+
+        if(has_group_length)
+        {
+            // Group length: (gggg,0000) UL Type=3 VM=1
+            lengths.items[group_index] = group_length;
+            length += 4+get_header_length(VR::UL, this->explicit_vr)+4;
+        }
+        length += group_length;
+    }
+
+    return length;
+}
+
+uint32_t
+Writer
+::_get_length(Element const & element, Lengths & lengths) const
+{
+    auto const & value = element.get_value();
+
+    // The length of the value is stored before the lengths of its items
+    auto const index = lengths.items.size();
+    lengths.items.push_back(0);
+
+    uint32_t length = 0;
+    if(value.get_type() == Value::Type::DataSets)
+    {
+        auto const undefined_length =
+            (this->item_encoding == ItemEncoding::UndefinedLength);
+        auto const & data_sets = value.as_data_sets();
+        for(auto const & data_set: data_sets)
+        {
+            auto const item_index = lengths.items.size();
+            lengths.items.push_back(0);
+            auto const item_length = this->_get_length(data_set, lengths);
+            lengths.items[item_index] = item_length;
+
+            length += 8+item_length+(undefined_length?8:0);
+        }
+        if(!data_sets.empty() && undefined_length)
+        {
+            length += 8;
+        }
+    }
+    else if(
+        (value.is_encoded() && value.get_encoded_vr() == element.vr)
+        || !value.empty())
+    {
+        length = get_value_length(value, element.vr, lengths.ds_values);
+    }
+    lengths.items[index] = length;
+
+    return get_header_length(element.vr, this->explicit_vr)+length;
+}
+
+void
+Writer
+::_write_data_set(
+    DataSet const & data_set, Lengths const & lengths,
+    Cursor & cursor) const
+{
+    auto it = data_set.begin();
+    while(it != data_set.end())
+    {
+        auto const group = it->first.group;
+
+        if(this->_has_group_length(group))
+        {
+            // Group length: (gggg,0000) UL Type=3 VM=1
+            this->write_tag(Tag(group, 0));
+            this->_write_vr_and_length(VR::UL, 4);
+            this->write_binary(
+                lengths.items[cursor.item], this->stream, this->byte_ordering);
+            ++cursor.item;
+        }
+
+        for(/* No initialization */;
+            it != data_set.end() && it->first.group == group; ++it)
+        {
+            this->write_tag(it->first);
+            this->_write_element(it->second, lengths, cursor);
+        }
+    }
+}
+
+void
+Writer
+::_write_element(
+    Element const & element, Lengths const & lengths,
+    Cursor & cursor) const
+{
+    auto const vr = element.vr;
+    auto const & value = element.get_value();
+
+    auto const length = lengths.items[cursor.item];
+    ++cursor.item;
+
+    // Write VR and VL
+    uint32_t vl = length;
+    if(this->explicit_vr && vr == VR::SQ &&
+        this->item_encoding == ItemEncoding::UndefinedLength)
+    {
+        vl = 0xffffffff;
+    }
+    else if(this->explicit_vr && is_binary(vr) && element.size() > 1)
+    {
+        vl = 0xffffffff;
+    }
+    this->_write_vr_and_length(vr, vl);
+
+    // Write value
+    Visitor const visitor(
+        this->stream, vr, this->byte_ordering, this->explicit_vr,
+        this->item_encoding, this->use_group_length, lengths, cursor,
+        this->_segments);
+    if(value.is_encoded() && value.get_encoded_vr() == vr)
+    {
+        // Copy the encoded value instead of decoding and re-encoding it
+        visitor.write_encoded(
+            value.get_encoded_data(), value.get_encoded_byte_ordering());
+    }
+    else if(!value.empty())
+    {
+        Value::IntegerFormat format;
+        if(value.has_binary_buffer())
+        {
+            // Don't convert contiguous binary data to fragments
+            visitor.write_binary_buffer(value.as_binary_buffer());
+        }
+        else if(
+            value.has_native_integers()
+            && Value::get_integer_format(vr, format)
+            && format == value.get_integer_format())
+        {
+            // Don't widen integers stored in the width of the VR
+            visitor.write_native_integers(value.as_native_integers());
+        }
+        else if(vr == VR::DS && value.get_type() == Value::Type::Reals)
+        {
+            // Formatted while computing the lengths
+            this->stream.write(&lengths.ds_values[cursor.ds_value], length);
+            if(!this->stream)
+            {
+                throw Exception("Could not write DS");
+            }
+            cursor.ds_value += length;
+        }
+        else
+        {
+            apply_visitor(visitor, value);
+        }
+    }
+}
+
+void
+Writer
+::_write_vr_and_length(VR vr, uint32_t vl) const
+{
+    if(this->explicit_vr)
+    {
+        this->stream << as_string(vr);
+        if(!this->stream)
+        {
+            throw Exception("Could not write to stream");
+        }
+
+        if(has_long_length(vr))
+        {
+            this->write_binary(uint16_t(0), this->stream, this->byte_ordering);
+            this->write_binary(vl, this->stream, this->byte_ordering);
+        }
+        else
+        {
+            this->write_binary(
+                uint16_t(vl), this->stream, this->byte_ordering);
+        }
+    }
+    else
+    {
+        this->write_binary(vl, this->stream, this->byte_ordering);
+    }
+}
+
 Writer::Visitor
 ::Visitor(
     std::ostream & stream, VR vr,
     ByteOrdering byte_ordering, bool explicit_vr, Writer::ItemEncoding item_encoding,
-    bool use_group_length)
+    bool use_group_length, Lengths const & lengths, Cursor & cursor,
+    SegmentList * segments)
 : stream(stream), vr(vr), byte_ordering(byte_ordering), explicit_vr(explicit_vr),
-    item_encoding(item_encoding), use_group_length(use_group_length)
+    item_encoding(item_encoding), use_group_length(use_group_length),
+    lengths(lengths), cursor(cursor), segments(segments)
 {
     // Nothing else
 }
@@ -364,48 +823,9 @@ Writer::Visitor::result_type
 Writer::Visitor
 ::operator()(Value::Reals const & value) const
 {
-    if(this->vr == VR::DS)
-    {
-        int written = 0;
-        for(int i=0; i<value.size(); ++i)
-        {
-            auto const & item = value[i];
-            
-            if(!std::isfinite(item))
-            {
-                throw Exception("DS items must be finite");
-            }
-            
-            // Each item in the DS is at most 16 bytes, account for NUL at end
-            static unsigned int const buffer_size=16+1;
-            static char buffer[buffer_size];
-            write_ds(item, buffer, buffer_size);
-            auto const length = strlen(buffer);
-            
-            this->stream.write(buffer, length);
-            written += length;
-            if(!this->stream.good())
-            {
-                throw Exception("Could not write DS");
-            }
-            
-            if(i<value.size()-1)
-            {
-                this->stream.put('\\');
-                written += 1;
-                if(!this->stream.good())
-                {
-                    throw Exception("Could not write DS");
-                }
-            }
-        };
-        if(written % 2 == 1)
-        {
-            this->stream.put(' ');
-        }
-        //this->write_strings(value, ' ');
-    }
-    else if(this->vr == VR::FD)
+    // DS values are written by _write_element from the text formatted while
+    // computing the lengths.
+    if(this->vr == VR::FD)
     {
         for(auto const & item: value)
         {
@@ -452,62 +872,47 @@ Writer::Visitor::result_type
 Writer::Visitor
 ::operator()(Value::DataSets const & value) const
 {
-    // Write all items to a sub-stream
-    std::ostringstream sequence_stream;
-    Writer sequence_writer(
-        sequence_stream, this->byte_ordering, this->explicit_vr,
+    // Items are written directly to the stream, their lengths have been
+    // computed beforehand.
+    Writer item_writer(
+        this->stream, this->byte_ordering, this->explicit_vr,
         this->item_encoding, this->use_group_length);
+    item_writer._segments = this->segments;
 
     for(auto const & item: value)
     {
-        // Write item to a sub-stream
-        std::ostringstream item_stream;
-        Writer item_writer(
-            item_stream, this->byte_ordering, this->explicit_vr,
-            this->item_encoding, this->use_group_length);
-        item_writer.write_data_set(item);
-
         // Beginning of item
-        sequence_writer.write_tag(registry::Item);
+        item_writer.write_tag(registry::Item);
 
         // Item length
         uint32_t item_length;
         if(this->item_encoding == ItemEncoding::ExplicitLength)
         {
-            item_length = item_stream.tellp();
+            item_length = this->lengths.items[this->cursor.item];
         }
         else
         {
             item_length = 0xffffffff;
         }
-        Writer::write_binary(item_length, sequence_stream, this->byte_ordering);
+        ++this->cursor.item;
+        Writer::write_binary(item_length, this->stream, this->byte_ordering);
 
         // Data set
-        sequence_stream.write(item_stream.str().c_str(), item_stream.tellp());
-        if(!sequence_stream)
-        {
-            throw Exception("Could not write to stream");
-        }
+        item_writer._write_data_set(item, this->lengths, this->cursor);
 
         // End of item
         if(this->item_encoding == ItemEncoding::UndefinedLength)
         {
-            sequence_writer.write_tag(registry::ItemDelimitationItem);
-            Writer::write_binary(uint32_t(0), sequence_stream, this->byte_ordering);
+            item_writer.write_tag(registry::ItemDelimitationItem);
+            Writer::write_binary(uint32_t(0), this->stream, this->byte_ordering);
         }
     }
 
     // End of sequence
     if(this->item_encoding == ItemEncoding::UndefinedLength)
     {
-        sequence_writer.write_tag(registry::SequenceDelimitationItem);
-        Writer::write_binary(uint32_t(0), sequence_stream, this->byte_ordering);
-    }
-
-    this->stream.write(sequence_stream.str().c_str(), sequence_stream.tellp());
-    if(!this->stream)
-    {
-        throw Exception("Could not write to stream");
+        item_writer.write_tag(registry::SequenceDelimitationItem);
+        Writer::write_binary(uint32_t(0), this->stream, this->byte_ordering);
     }
 }
 
@@ -521,53 +926,139 @@ Writer::Visitor
     }
     else if(value.size() > 1)
     {
-        Writer::write_encapsulated_pixel_data(
-            value, this->stream, this->byte_ordering, this->explicit_vr);
+        Writer::_write_encapsulated_pixel_data(
+            value, this->stream, this->byte_ordering, this->explicit_vr,
+            this->segments);
     }
     else
     {
-        if(this->vr == VR::OB || this->vr == VR::UN)
-        {
-            this->stream.write(
-                reinterpret_cast<char const*>(&value[0][0]), value[0].size());
-        }
-        else if(this->vr == VR::OW)
-        {
-            if(value[0].size()%2 != 0)
-            {
-                throw Exception("Value cannot be written as OW");
-            }
-            for(int i=0; i<value[0].size(); i+=2)
-            {
-                uint16_t item = *reinterpret_cast<uint16_t const *>(&value[0][i]);
-                Writer::write_binary(item, this->stream, this->byte_ordering);
-            }
-        }
-        else if(this->vr == VR::OF)
-        {
-            if(value[0].size()%4 != 0)
-            {
-                throw Exception("Value cannot be written as OF");
-            }
-            for(int i=0; i<value[0].size(); i+=4)
-            {
-                uint32_t item = *reinterpret_cast<uint32_t const *>(&value[0][i]);
-                Writer::write_binary(item, this->stream, this->byte_ordering);
-            }
-        }
-        else
-        {
-            throw Exception("Cannot write "+as_string(this->vr)+" as binary");
-        }
+        this->write_binary_item(&value[0][0], value[0].size(), nullptr);
+    }
+}
 
-        if(!this->stream)
+void
+Writer::Visitor
+::write_binary_buffer(BinaryBuffer const & value) const
+{
+    if(value.empty())
+    {
+        return;
+    }
+    else if(value.get_fragments_count() > 1)
+    {
+        Writer::_write_encapsulated_pixel_data(
+            value, this->stream, this->byte_ordering, this->explicit_vr,
+            this->segments);
+    }
+    else
+    {
+        this->write_binary_item(
+            value.data(), value.size(), value.get_shared_data());
+    }
+}
+
+void
+Writer::Visitor
+::write_binary_item(
+    uint8_t const * data, std::size_t size,
+    std::shared_ptr<uint8_t const> const & owner) const
+{
+    if(this->vr == VR::OB || this->vr == VR::UN)
+    {
+        Writer::_write_raw(this->stream, data, size, this->segments, owner);
+    }
+    else if(
+        this->vr == VR::OD || this->vr == VR::OF || this->vr == VR::OL ||
+        this->vr == VR::OW)
+    {
+        std::size_t const item_size =
+            (this->vr == VR::OD)?8:((this->vr == VR::OW)?2:4);
+        if(size%item_size != 0)
         {
-            throw Exception("Could not write to stream");
+            throw Exception(
+                "Value cannot be written as "+as_string(this->vr));
         }
 
-        if(value[0].size()%2 == 1)
+        this->write_items(data, size, item_size, owner);
+    }
+    else
+    {
+        throw Exception("Cannot write "+as_string(this->vr)+" as binary");
+    }
+
+    if(!this->stream)
+    {
+        throw Exception("Could not write to stream");
+    }
+
+    if(size%2 == 1)
+    {
+        this->stream.put('\0');
+    }
+}
+
+void
+Writer::Visitor
+::write_native_integers(BinaryBuffer const & value) const
+{
+    if(!value.empty())
+    {
+        auto const item_size =
+            (this->vr == VR::SS || this->vr == VR::US)?2:4;
+        this->write_items(
+            value.data(), value.size(), item_size, value.get_shared_data());
+    }
+}
+
+void
+Writer::Visitor
+::write_encoded(BinaryBuffer const & value, ByteOrdering byte_ordering) const
+{
+    std::size_t item_size = 1;
+    if(this->vr == VR::AT || this->vr == VR::SS || this->vr == VR::US)
+    {
+        item_size = 2;
+    }
+    else if(this->vr == VR::FL || this->vr == VR::SL || this->vr == VR::UL)
+    {
+        item_size = 4;
+    }
+    else if(this->vr == VR::FD)
+    {
+        item_size = 8;
+    }
+
+    if(!value.empty())
+    {
+        this->write_items(
+            value.data(), value.size(), item_size, value.get_shared_data(),
+            byte_ordering);
+    }
+}
+
+void
+Writer::Visitor
+::write_items(
+    uint8_t const * data, std::size_t size, std::size_t item_size,
+    std::shared_ptr<uint8_t const> const & owner,
+    ByteOrdering byte_ordering) const
+{
+    auto const begin = reinterpret_cast<char const*>(data);
+    if(item_size == 1 || this->byte_ordering == byte_ordering)
+    {
+        Writer::_write_raw(this->stream, data, size, this->segments, owner);
+    }
+    else
+    {
+        // Convert through a bounded buffer to avoid copying the
+        // whole array.
+        std::vector<char> buffer(std::min<std::size_t>(65536, size));
+        for(std::size_t offset=0; offset<size; )
         {
-            this->stream.put('\0');
+            auto const chunk_size = std::min(buffer.size(), size-offset);
+            swap_bytes(begin+offset, &buffer[0], chunk_size, item_size);
+            this->stream.write(&buffer[0], chunk_size);
+            offset += chunk_size;
         }
     }
 }
@@ -582,12 +1073,14 @@ Writer::Visitor
         return;
     }
 
-    auto const stream_begin = this->stream.tellp();
+    // The stream may not be seekable: count the written bytes.
+    std::size_t written = 0;
 
     auto last_element_it = --sequence.end();
     for(auto it = sequence.begin(); it!= sequence.end(); ++it)
     {
-        this->stream << *it;
+        write_text(this->stream, *it);
+        written += get_text_length(*it);
         if(!this->stream)
         {
             throw Exception("Could not write to stream");
@@ -596,6 +1089,7 @@ Writer::Visitor
         if(it != last_element_it)
         {
             this->stream << "\\";
+            written += 1;
             if(!this->stream)
             {
                 throw Exception("Could not write to stream");
@@ -603,9 +1097,7 @@ Writer::Visitor
         }
     }
 
-    auto const stream_end = this->stream.tellp();
-
-    if((stream_end-stream_begin)%2 == 1)
+    if(written%2 == 1)
     {
         this->stream.put(padding);
         if(!this->stream)
@@ -9,14 +9,20 @@
 #ifndef _ca5c06d2_04f9_4009_9e98_5607e1060379
 #define _ca5c06d2_04f9_4009_9e98_5607e1060379
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <ostream>
 #include <string>
+#include <vector>
 
+#include "odil/BinaryBuffer.h"
 #include "odil/DataSet.h"
 #include "odil/Element.h"
 #include "odil/endian.h"
 #include "odil/odil.h"
 #include "odil/registry.h"
+#include "odil/SegmentList.h"
 #include "odil/Tag.h"
 #include "odil/Value.h"
 #include "odil/VR.h"
@@ -35,6 +41,28 @@ public:
         UndefinedLength
     };
 
+    /**
+     * @brief Lengths computed before writing a data set, so that each byte
+     * is written once.
+     *
+     * They are only valid for the data set and the encoding parameters of
+     * the writer which computed them.
+     */
+    struct Lengths
+    {
+        /// @brief Number of bytes written by write_data_set.
+        std::size_t size;
+
+        /// @brief Lengths of the values, items and groups, in writing order.
+        std::vector<uint32_t> items;
+
+        /**
+         * @brief DS values, formatted with their separators and padding while
+         * computing their lengths, in writing order.
+         */
+        std::string ds_values;
+    };
+
     /// @brief Output stream.
     std::ostream & stream;
 
@@ -60,6 +88,22 @@ public:
         Value::Binary const & value, std::ostream & stream,
         ByteOrdering byte_ordering, bool explicit_vr);
 
+    /// @brief Write pixel data stored in a contiguous buffer in encapsulated form.
+    static void write_encapsulated_pixel_data(
+        BinaryBuffer const & value, std::ostream & stream,
+        ByteOrdering byte_ordering, bool explicit_vr);
+
+    /**
+     * @brief Build a writer storing the encoded data in a list of segments,
+     * where large binary values are referenced instead of copied; derive
+     * byte ordering and explicit-ness of VR from transfer syntax.
+     */
+    Writer(
+        SegmentList & segments,
+        std::string const & transfer_syntax,
+        ItemEncoding item_encoding=ItemEncoding::ExplicitLength,
+        bool use_group_length=false);
+
     /// @brief Build a writer.
     Writer(
         std::ostream & stream,
@@ -77,9 +121,34 @@ public:
         ItemEncoding item_encoding=ItemEncoding::ExplicitLength,
         bool use_group_length=false);
 
+    /**
+     * @brief Return the number of bytes written by write_data_set, without
+     * encoding the data set.
+     *
+     * The size only depends on the data set and on the encoding parameters,
+     * and may be memoized, e.g. using DataSet::get_hash.
+     */
+    static std::size_t encoded_size(
+        DataSet const & data_set, std::string const & transfer_syntax,
+        ItemEncoding item_encoding=ItemEncoding::ExplicitLength,
+        bool use_group_length=false);
+
+    /// @brief Return the number of bytes written by write_data_set.
+    std::size_t get_encoded_size(DataSet const & data_set) const;
+
+    /**
+     * @brief Return the lengths used to write a data set, e.g. to allocate
+     * the output before calling write_data_set(data_set, lengths).
+     */
+    Lengths get_lengths(DataSet const & data_set) const;
+
     /// @brief Write a data set.
     void write_data_set(DataSet const & data_set) const;
 
+    /// @brief Write a data set using lengths returned by get_lengths.
+    void write_data_set(
+        DataSet const & data_set, Lengths const & lengths) const;
+
     /// @brief Write a tag.
     void write_tag(Tag const & tag) const;
 
@@ -95,6 +164,61 @@ public:
         bool use_group_length=false);
 
 private:
+    /// @brief Segments referencing large binary values, if not null.
+    SegmentList * _segments;
+
+    /**
+     * @brief Write raw data, or reference it in the segments if it is large
+     * enough and kept alive by owner (which may be null).
+     */
+    static void _write_raw(
+        std::ostream & stream, uint8_t const * data, std::size_t size,
+        SegmentList * segments, std::shared_ptr<uint8_t const> const & owner);
+
+    /// @brief Write pixel data in encapsulated form.
+    static void _write_encapsulated_pixel_data(
+        Value::Binary const & value, std::ostream & stream,
+        ByteOrdering byte_ordering, bool explicit_vr, SegmentList * segments);
+
+    /// @brief Write pixel data stored in a contiguous buffer in encapsulated form.
+    static void _write_encapsulated_pixel_data(
+        BinaryBuffer const & value, std::ostream & stream,
+        ByteOrdering byte_ordering, bool explicit_vr, SegmentList * segments);
+
+    /// @brief Position of the next length and of the next DS value.
+    struct Cursor
+    {
+        std::size_t item;
+        std::size_t ds_value;
+    };
+
+    /// @brief Test whether the group length of a group is written.
+    bool _has_group_length(uint16_t group) const;
+
+    /**
+     * @brief Append the lengths of the nested values, items and groups and
+     * return the encoded length of the data set.
+     */
+    uint32_t _get_length(DataSet const & data_set, Lengths & lengths) const;
+
+    /**
+     * @brief Append the lengths of the value and of its items and return the
+     * encoded length of the element (VR, VL and value).
+     */
+    uint32_t _get_length(Element const & element, Lengths & lengths) const;
+
+    /// @brief Write a data set, using the lengths starting at cursor.
+    void _write_data_set(
+        DataSet const & data_set, Lengths const & lengths,
+        Cursor & cursor) const;
+
+    /// @brief Write an element, using the lengths starting at cursor.
+    void _write_element(
+        Element const & element, Lengths const & lengths,
+        Cursor & cursor) const;
+
+    /// @brief Write the VR (if explicit) and VL of an element.
+    void _write_vr_and_length(VR vr, uint32_t vl) const;
 
     struct Visitor
     {
@@ -108,10 +232,19 @@ private:
         ItemEncoding item_encoding;
         bool use_group_length;
 
+        /// @brief Lengths of the items of sequences.
+        Lengths const & lengths;
+        /// @brief Position of the length of the next item.
+        Cursor & cursor;
+
+        /// @brief Segments referencing large binary values, if not null.
+        SegmentList * segments;
+
         Visitor(
             std::ostream & stream, VR vr,
             ByteOrdering byte_ordering, bool explicit_vr, ItemEncoding item_encoding,
-            bool use_group_length);
+            bool use_group_length, Lengths const & lengths, Cursor & cursor,
+            SegmentList * segments);
 
         result_type operator()(Value::Integers const & value) const;
         result_type operator()(Value::Reals const & value) const;
@@ -119,6 +252,33 @@ private:
         result_type operator()(Value::DataSets const & value) const;
         result_type operator()(Value::Binary const & value) const;
 
+        /// @brief Write binary data stored in a contiguous buffer.
+        void write_binary_buffer(BinaryBuffer const & value) const;
+
+        /**
+         * @brief Write a non-encapsulated binary value, kept alive by owner
+         * (which may be null).
+         */
+        void write_binary_item(
+            uint8_t const * data, std::size_t size,
+            std::shared_ptr<uint8_t const> const & owner) const;
+
+        /// @brief Write integers stored in their native width.
+        void write_native_integers(BinaryBuffer const & value) const;
+
+        /// @brief Write a value in its encoded form.
+        void write_encoded(
+            BinaryBuffer const & value, ByteOrdering byte_ordering) const;
+
+        /**
+         * @brief Write fixed-size items stored with the given byte ordering,
+         * kept alive by owner (which may be null).
+         */
+        void write_items(
+            uint8_t const * data, std::size_t size, std::size_t item_size,
+            std::shared_ptr<uint8_t const> const & owner,
+            ByteOrdering byte_ordering=host_byte_ordering) const;
+
         template<typename T>
         void write_strings(T const & sequence, char padding) const;
     };
@@ -10,11 +10,13 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <boost/date_time.hpp>
 
 #include "odil/Exception.h"
+#include "odil/SegmentList.h"
 
 namespace odil
 {
@@ -218,6 +220,38 @@ Transport
     this->_run(source, error);
 }
 
+void
+Transport
+::write(SegmentList const & segments)
+{
+    if(!this->is_open())
+    {
+        throw Exception("Not connected");
+    }
+
+    // The segments are valid as long as the list is not modified.
+    std::vector<boost::asio::const_buffer> buffers;
+    for(auto const & segment: segments.get_segments())
+    {
+        buffers.push_back(boost::asio::buffer(segment.data, segment.size));
+    }
+
+    auto source = Source::NONE;
+    boost::system::error_code error;
+    this->_start_deadline(source, error);
+
+    boost::asio::async_write(
+        *this->_socket, buffers,
+        [&source,&error](boost::system::error_code const & e, std::size_t)
+        {
+            source = Source::OPERATION;
+            error = e;
+        }
+    );
+
+    this->_run(source, error);
+}
+
 void
 Transport
 ::_start_deadline(Source & source, boost::system::error_code & error)
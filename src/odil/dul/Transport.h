@@ -16,6 +16,7 @@
 #include <boost/date_time.hpp>
 
 #include "odil/odil.h"
+#include "odil/SegmentList.h"
 
 namespace odil
 {
@@ -83,6 +84,12 @@ struct ODIL_API Transport
     /// @brief Write data, raise an exception on error.
     void write(std::string const & data);
 
+    /**
+     * @brief Write the segments in a single gather operation, without
+     * concatenating them, raise an exception on error.
+     */
+    void write(SegmentList const & segments);
+
 private:
     boost::asio::io_service _service;
     std::shared_ptr<Socket> _socket;
@@ -0,0 +1,121 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/endian.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define ODIL_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "odil/Exception.h"
+
+namespace
+{
+
+void swap_items(
+    char const * source, char * destination, std::size_t size,
+    std::size_t item_size)
+{
+    char item[8];
+    for(std::size_t offset=0; offset < size; offset += item_size)
+    {
+        // Go through a temporary in case source and destination are equal
+        std::reverse_copy(source+offset, source+offset+item_size, item);
+        std::copy(item, item+item_size, destination+offset);
+    }
+}
+
+#ifdef ODIL_SSE2
+
+__m128i swap_16(__m128i block)
+{
+    return _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8));
+}
+
+__m128i swap_32(__m128i block)
+{
+    block = swap_16(block);
+    block = _mm_shufflelo_epi16(block, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(block, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+__m128i swap_64(__m128i block)
+{
+    block = swap_16(block);
+    block = _mm_shufflelo_epi16(block, _MM_SHUFFLE(0, 1, 2, 3));
+    return _mm_shufflehi_epi16(block, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+template<__m128i (*Swap)(__m128i)>
+std::size_t swap_blocks(char const * source, char * destination, std::size_t size)
+{
+    std::size_t const blocks_size = size - size%16;
+    for(std::size_t offset=0; offset < blocks_size; offset += 16)
+    {
+        auto const block = _mm_loadu_si128(
+            reinterpret_cast<__m128i const *>(source+offset));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(destination+offset), Swap(block));
+    }
+    return blocks_size;
+}
+
+#endif // ODIL_SSE2
+
+}
+
+namespace odil
+{
+
+void swap_bytes(
+    char const * source, char * destination, std::size_t size,
+    std::size_t item_size)
+{
+    if(item_size != 1 && item_size != 2 && item_size != 4 && item_size != 8)
+    {
+        throw Exception("Cannot swap items of "+std::to_string(item_size)+" bytes");
+    }
+    if(size % item_size != 0)
+    {
+        throw Exception("Size is not a multiple of item size");
+    }
+
+    std::size_t done = 0;
+#ifdef ODIL_SSE2
+    if(item_size == 2)
+    {
+        done = swap_blocks<swap_16>(source, destination, size);
+    }
+    else if(item_size == 4)
+    {
+        done = swap_blocks<swap_32>(source, destination, size);
+    }
+    else if(item_size == 8)
+    {
+        done = swap_blocks<swap_64>(source, destination, size);
+    }
+#endif // ODIL_SSE2
+
+    if(item_size == 1)
+    {
+        if(source != destination)
+        {
+            std::copy(source, source+size, destination);
+        }
+    }
+    else
+    {
+        swap_items(source+done, destination+done, size-done, item_size);
+    }
+}
+
+}
@@ -9,8 +9,12 @@
 #ifndef _05d00816_25d0_41d1_9768_afd39f0503da
 #define _05d00816_25d0_41d1_9768_afd39f0503da
 
+#include <cstddef>
+
 #include <boost/detail/endian.hpp>
 
+#include "odil/odil.h"
+
 #define ODIL_SWAP \
     auto source = reinterpret_cast<char const *>(&value); \
     auto const end = source + sizeof(value); \
@@ -32,6 +36,13 @@ enum class ByteOrdering
     BigEndian
 };
 
+/// @brief Byte ordering of the host.
+#ifdef BOOST_LITTLE_ENDIAN
+ByteOrdering const host_byte_ordering = ByteOrdering::LittleEndian;
+#else
+ByteOrdering const host_byte_ordering = ByteOrdering::BigEndian;
+#endif
+
 template<typename T>
 T host_to_big_endian(T const & value)
 {
@@ -80,6 +91,15 @@ T little_endian_to_host(T const & value)
 #endif
 }
 
+/**
+ * @brief Reverse the byte order of each item (of 1, 2, 4 or 8 bytes) of an
+ * array, storing the result in destination; source and destination may be
+ * the same array, but must not otherwise overlap. The size is given in bytes.
+ */
+ODIL_API void swap_bytes(
+    char const * source, char * destination, std::size_t size,
+    std::size_t item_size);
+
 }
 
 #undef ODIL_SWAP
@@ -0,0 +1,38 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/hash.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace odil
+{
+
+uint64_t hash_bytes(void const * data, std::size_t size, uint64_t seed)
+{
+    auto const begin = reinterpret_cast<uint8_t const *>(data);
+    auto const end = begin+size;
+    for(auto it = begin; it != end; ++it)
+    {
+        seed ^= *it;
+        seed *= 0x100000001b3ULL;
+    }
+    return seed;
+}
+
+uint64_t hash_combine(uint64_t seed, uint64_t value)
+{
+    // Mix the value before combining it, cf. boost::hash_combine
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+}
@@ -0,0 +1,32 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _c0e26146_c006_444b_9502_e1ec79e23b23
+#define _c0e26146_c006_444b_9502_e1ec79e23b23
+
+#include <cstddef>
+#include <cstdint>
+
+#include "odil/odil.h"
+
+namespace odil
+{
+
+/// @brief Initial value of the structural hashes.
+uint64_t const hash_seed = 0xcbf29ce484222325ULL;
+
+/// @brief Hash a sequence of bytes (FNV-1a), starting from seed.
+ODIL_API uint64_t hash_bytes(
+    void const * data, std::size_t size, uint64_t seed=hash_seed);
+
+/// @brief Combine a hash with the hash of another object.
+ODIL_API uint64_t hash_combine(uint64_t seed, uint64_t value);
+
+}
+
+#endif // _c0e26146_c006_444b_9502_e1ec79e23b23
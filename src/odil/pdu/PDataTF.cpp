@@ -9,6 +9,7 @@
 #include "odil/pdu/PDataTF.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <istream>
 #include <string>
@@ -39,6 +40,25 @@ PDataTF::PresentationDataValueItem
     this->set_fragment(fragment);
 }
 
+PDataTF::PresentationDataValueItem
+::PresentationDataValueItem(
+    uint8_t presentation_context_id, uint8_t control_header,
+    std::string const & buffer, std::size_t offset, std::size_t size)
+{
+    this->_item.add("Item-length", uint32_t(4));
+    this->_item.add("Presentation-Context-ID", uint8_t(0));
+    this->_item.add("Control-header", uint8_t(0));
+    this->_item.add("Fragment", std::string());
+
+    this->set_presentation_context_id(presentation_context_id);
+    this->set_control_header(control_header);
+
+    // Copy the fragment directly from the buffer, without a temporary string
+    auto & fragment = this->_item.as_string("Fragment");
+    fragment.assign(buffer, offset, size);
+    this->_item.as_unsigned_int_32("Item-length") = 2+fragment.size();
+}
+
 PDataTF::PresentationDataValueItem
 ::PresentationDataValueItem(std::istream & stream)
 {
@@ -9,8 +9,10 @@
 #ifndef _b3062f12_8a06_46a8_9dda_8a7edf96e4a6
 #define _b3062f12_8a06_46a8_9dda_8a7edf96e4a6
 
+#include <cstddef>
 #include <cstdint>
 #include <istream>
+#include <string>
 #include <vector>
 
 #include "odil/odil.h"
@@ -33,6 +35,14 @@ public:
             uint8_t presentation_context_id, uint8_t control_header,
             std::string const & fragment);
 
+        /**
+         * @brief Constructor, the fragment is the part of buffer starting at
+         * offset, of at most size bytes.
+         */
+        PresentationDataValueItem(
+            uint8_t presentation_context_id, uint8_t control_header,
+            std::string const & buffer, std::size_t offset, std::size_t size);
+
         PresentationDataValueItem(std::istream & stream);
 
         uint8_t get_presentation_context_id() const;
@@ -0,0 +1,276 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/read_ds.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+
+#include "odil/Exception.h"
+#include "odil/Value.h"
+
+// Helper functions
+namespace
+{
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\0';
+}
+
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/// @brief Return the end of the item starting at begin.
+char const * find_item_end(char const * begin, char const * end)
+{
+    return std::find(begin, end, '\\');
+}
+
+/// @brief Remove the padding around an item.
+void trim(char const * & begin, char const * & end)
+{
+    while(begin != end && is_space(*begin))
+    {
+        ++begin;
+    }
+    while(end != begin && is_space(*(end-1)))
+    {
+        --end;
+    }
+}
+
+/// @brief Exactly representable powers of 10.
+double const powers_of_10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+/**
+ * @brief Parse a real which has an exact double representation: at most 15
+ * significant digits and a power of 10 of at most 22. Return false if the
+ * real does not match these conditions or is not valid.
+ */
+bool parse_exact_real(char const * begin, char const * end, double & value)
+{
+    char const * it = begin;
+
+    bool negative = false;
+    if(it != end && (*it == '+' || *it == '-'))
+    {
+        negative = (*it == '-');
+        ++it;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool has_digits = false;
+
+    while(it != end && is_digit(*it))
+    {
+        has_digits = true;
+        if(mantissa != 0 || *it != '0')
+        {
+            mantissa = 10*mantissa + (*it-'0');
+            ++digits;
+        }
+        ++it;
+    }
+    if(it != end && *it == '.')
+    {
+        ++it;
+        while(it != end && is_digit(*it))
+        {
+            has_digits = true;
+            if(mantissa != 0 || *it != '0')
+            {
+                mantissa = 10*mantissa + (*it-'0');
+                ++digits;
+            }
+            --exponent;
+            ++it;
+        }
+    }
+    if(!has_digits || digits > 15)
+    {
+        return false;
+    }
+
+    if(it != end && (*it == 'e' || *it == 'E'))
+    {
+        ++it;
+        bool negative_exponent = false;
+        if(it != end && (*it == '+' || *it == '-'))
+        {
+            negative_exponent = (*it == '-');
+            ++it;
+        }
+        if(it == end || !is_digit(*it))
+        {
+            return false;
+        }
+        int explicit_exponent = 0;
+        while(it != end && is_digit(*it))
+        {
+            explicit_exponent = 10*explicit_exponent + (*it-'0');
+            if(explicit_exponent > 1000)
+            {
+                return false;
+            }
+            ++it;
+        }
+        exponent += negative_exponent?-explicit_exponent:explicit_exponent;
+    }
+
+    if(it != end || exponent < -22 || exponent > 22)
+    {
+        return false;
+    }
+
+    // Both the mantissa and the power of 10 are exact: the result is
+    // correctly rounded.
+    value = double(mantissa);
+    if(exponent < 0)
+    {
+        value /= powers_of_10[-exponent];
+    }
+    else
+    {
+        value *= powers_of_10[exponent];
+    }
+    if(negative)
+    {
+        value = -value;
+    }
+
+    return true;
+}
+
+/// @brief Parse any real, independently of the current locale.
+double parse_real(char const * begin, char const * end)
+{
+    double value;
+    if(parse_exact_real(begin, end, value))
+    {
+        return value;
+    }
+
+    // Slow path for long mantissas and large exponents
+    std::istringstream stream(std::string(begin, end));
+    stream.imbue(std::locale::classic());
+    stream >> value;
+    if(begin == end || stream.fail() || stream.peek() != EOF)
+    {
+        throw odil::Exception(
+            "Cannot parse DS item \""+std::string(begin, end)+"\"");
+    }
+
+    return value;
+}
+
+int64_t parse_integer(char const * begin, char const * end)
+{
+    char const * it = begin;
+
+    bool negative = false;
+    if(it != end && (*it == '+' || *it == '-'))
+    {
+        negative = (*it == '-');
+        ++it;
+    }
+    if(it == end)
+    {
+        throw odil::Exception(
+            "Cannot parse IS item \""+std::string(begin, end)+"\"");
+    }
+
+    // Accumulate as a negative number to handle the minimum value
+    int64_t const minimum = std::numeric_limits<int64_t>::min();
+    int64_t value = 0;
+    while(it != end)
+    {
+        if(!is_digit(*it))
+        {
+            throw odil::Exception(
+                "Cannot parse IS item \""+std::string(begin, end)+"\"");
+        }
+        int const digit = *it-'0';
+        if(value < (minimum+digit)/10)
+        {
+            throw odil::Exception(
+                "IS item out of range \""+std::string(begin, end)+"\"");
+        }
+        value = 10*value-digit;
+        ++it;
+    }
+
+    if(!negative)
+    {
+        if(value == minimum)
+        {
+            throw odil::Exception(
+                "IS item out of range \""+std::string(begin, end)+"\"");
+        }
+        value = -value;
+    }
+
+    return value;
+}
+
+}
+
+namespace odil
+{
+
+void read_ds(char const * begin, char const * end, Value::Reals & values)
+{
+    char const * item_begin = begin;
+    while(true)
+    {
+        char const * const item_end = find_item_end(item_begin, end);
+
+        char const * number_begin = item_begin;
+        char const * number_end = item_end;
+        trim(number_begin, number_end);
+        values.push_back(parse_real(number_begin, number_end));
+
+        if(item_end == end)
+        {
+            break;
+        }
+        item_begin = item_end+1;
+    }
+}
+
+void read_is(char const * begin, char const * end, Value::Integers & values)
+{
+    char const * item_begin = begin;
+    while(true)
+    {
+        char const * const item_end = find_item_end(item_begin, end);
+
+        char const * number_begin = item_begin;
+        char const * number_end = item_end;
+        trim(number_begin, number_end);
+        values.push_back(parse_integer(number_begin, number_end));
+
+        if(item_end == end)
+        {
+            break;
+        }
+        item_begin = item_end+1;
+    }
+}
+
+}
@@ -0,0 +1,38 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _0e0c8837_80c4_46fe_b082_df408f50bc95
+#define _0e0c8837_80c4_46fe_b082_df408f50bc95
+
+#include "odil/odil.h"
+#include "odil/Value.h"
+
+namespace odil
+{
+
+/**
+ * @brief Parse the backslash-separated, space-padded DS items stored in
+ * (begin, end) and append them to values.
+ *
+ * The parsing does not depend on the current locale. If an item is not a
+ * valid decimal string, a odil::Exception is raised.
+ */
+ODIL_API void read_ds(char const * begin, char const * end, Value::Reals & values);
+
+/**
+ * @brief Parse the backslash-separated, space-padded IS items stored in
+ * (begin, end) and append them to values.
+ *
+ * If an item is not a valid integer string, a odil::Exception is raised.
+ */
+ODIL_API void read_is(
+    char const * begin, char const * end, Value::Integers & values);
+
+}
+
+#endif // _0e0c8837_80c4_46fe_b082_df408f50bc95
@@ -628,7 +628,8 @@ STOWRSRequest
         else if (data_set.is_data_set(tag))
         {
             // Case of sequence with multiple sub-elements
-            for (auto sq : data_set.as_data_set(tag))
+            auto const & const_data_set = data_set;
+            for (auto sq : const_data_set.as_data_set(tag))
             {
                 STOWRSRequest::_extract_bulk_data(sq, bulk_data);
             }
@@ -683,7 +684,8 @@ STOWRSRequest
         }
         else if (data_set.is_data_set(tag))
         {
-            for (auto sq : data_set.as_data_set(tag))
+            auto const & const_data_set = data_set;
+            for (auto sq : const_data_set.as_data_set(tag))
             {
                 STOWRSRequest::_restore_data_set(sq, uuid_bulk_raw);
             }
@@ -9,103 +9,380 @@
 #include "odil/write_ds.h"
 
 #include <cmath>
-#include <cstdio>
-#include <cstdlib>
+#include <cstdint>
 #include <cstring>
 
+#include "odil/Exception.h"
+#include "odil/Value.h"
+
 // Helper functions
-namespace 
+namespace
+{
+
+/**
+ * @brief Floating-point number f*2^e with a 64-bit significand, cf. Loitsch,
+ * "Printing Floating-Point Numbers Quickly and Accurately with Integers",
+ * PLDI 2010.
+ */
+struct DiyFp
 {
+    uint64_t f;
+    int e;
+};
 
-/// @brief Remove the trailing zeros of the mantissa.
-void clean(char * mantissa)
+/// @brief Return the product of x and y, rounded to 64 bits.
+DiyFp multiply(DiyFp const & x, DiyFp const & y)
 {
-    char * it = mantissa + strlen(mantissa) - 1;
-    while(*it == '0' && it > mantissa)
+    uint64_t const x_low = x.f & 0xffffffffu;
+    uint64_t const x_high = x.f >> 32;
+    uint64_t const y_low = y.f & 0xffffffffu;
+    uint64_t const y_high = y.f >> 32;
+
+    uint64_t const low_low = x_low * y_low;
+    uint64_t const low_high = x_low * y_high;
+    uint64_t const high_low = x_high * y_low;
+    uint64_t const high_high = x_high * y_high;
+
+    uint64_t middle =
+        (low_low >> 32) + (low_high & 0xffffffffu) + (high_low & 0xffffffffu);
+    // Round to nearest, ties up
+    middle += uint64_t(1) << 31;
+
+    return {
+        high_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32),
+        x.e + y.e + 64 };
+}
+
+/// @brief Shift the significand so that its most significant bit is set.
+DiyFp normalize(DiyFp x)
+{
+    while((x.f >> 63) == 0)
     {
-        *it = '\0';
-        --it;
+        x.f <<= 1;
+        --x.e;
     }
-    
-    if(*it == '.')
+    return x;
+}
+
+/// @brief Cached power of ten, f*2^e ~ 10^k.
+struct CachedPower
+{
+    uint64_t f;
+    int e;
+    int k;
+};
+
+/// @brief Normalized powers of ten, from 10^-300 to 10^324 by steps of 8.
+CachedPower const cached_powers[] = {
+    { 0xAB70FE17C79AC6CA, -1060, -300 },
+    { 0xFF77B1FCBEBCDC4F, -1034, -292 },
+    { 0xBE5691EF416BD60C, -1007, -284 },
+    { 0x8DD01FAD907FFC3C,  -980, -276 },
+    { 0xD3515C2831559A83,  -954, -268 },
+    { 0x9D71AC8FADA6C9B5,  -927, -260 },
+    { 0xEA9C227723EE8BCB,  -901, -252 },
+    { 0xAECC49914078536D,  -874, -244 },
+    { 0x823C12795DB6CE57,  -847, -236 },
+    { 0xC21094364DFB5637,  -821, -228 },
+    { 0x9096EA6F3848984F,  -794, -220 },
+    { 0xD77485CB25823AC7,  -768, -212 },
+    { 0xA086CFCD97BF97F4,  -741, -204 },
+    { 0xEF340A98172AACE5,  -715, -196 },
+    { 0xB23867FB2A35B28E,  -688, -188 },
+    { 0x84C8D4DFD2C63F3B,  -661, -180 },
+    { 0xC5DD44271AD3CDBA,  -635, -172 },
+    { 0x936B9FCEBB25C996,  -608, -164 },
+    { 0xDBAC6C247D62A584,  -582, -156 },
+    { 0xA3AB66580D5FDAF6,  -555, -148 },
+    { 0xF3E2F893DEC3F126,  -529, -140 },
+    { 0xB5B5ADA8AAFF80B8,  -502, -132 },
+    { 0x87625F056C7C4A8B,  -475, -124 },
+    { 0xC9BCFF6034C13053,  -449, -116 },
+    { 0x964E858C91BA2655,  -422, -108 },
+    { 0xDFF9772470297EBD,  -396, -100 },
+    { 0xA6DFBD9FB8E5B88F,  -369,  -92 },
+    { 0xF8A95FCF88747D94,  -343,  -84 },
+    { 0xB94470938FA89BCF,  -316,  -76 },
+    { 0x8A08F0F8BF0F156B,  -289,  -68 },
+    { 0xCDB02555653131B6,  -263,  -60 },
+    { 0x993FE2C6D07B7FAC,  -236,  -52 },
+    { 0xE45C10C42A2B3B06,  -210,  -44 },
+    { 0xAA242499697392D3,  -183,  -36 },
+    { 0xFD87B5F28300CA0E,  -157,  -28 },
+    { 0xBCE5086492111AEB,  -130,  -20 },
+    { 0x8CBCCC096F5088CC,  -103,  -12 },
+    { 0xD1B71758E219652C,   -77,   -4 },
+    { 0x9C40000000000000,   -50,    4 },
+    { 0xE8D4A51000000000,   -24,   12 },
+    { 0xAD78EBC5AC620000,     3,   20 },
+    { 0x813F3978F8940984,    30,   28 },
+    { 0xC097CE7BC90715B3,    56,   36 },
+    { 0x8F7E32CE7BEA5C70,    83,   44 },
+    { 0xD5D238A4ABE98068,   109,   52 },
+    { 0x9F4F2726179A2245,   136,   60 },
+    { 0xED63A231D4C4FB27,   162,   68 },
+    { 0xB0DE65388CC8ADA8,   189,   76 },
+    { 0x83C7088E1AAB65DB,   216,   84 },
+    { 0xC45D1DF942711D9A,   242,   92 },
+    { 0x924D692CA61BE758,   269,  100 },
+    { 0xDA01EE641A708DEA,   295,  108 },
+    { 0xA26DA3999AEF774A,   322,  116 },
+    { 0xF209787BB47D6B85,   348,  124 },
+    { 0xB454E4A179DD1877,   375,  132 },
+    { 0x865B86925B9BC5C2,   402,  140 },
+    { 0xC83553C5C8965D3D,   428,  148 },
+    { 0x952AB45CFA97A0B3,   455,  156 },
+    { 0xDE469FBD99A05FE3,   481,  164 },
+    { 0xA59BC234DB398C25,   508,  172 },
+    { 0xF6C69A72A3989F5C,   534,  180 },
+    { 0xB7DCBF5354E9BECE,   561,  188 },
+    { 0x88FCF317F22241E2,   588,  196 },
+    { 0xCC20CE9BD35C78A5,   614,  204 },
+    { 0x98165AF37B2153DF,   641,  212 },
+    { 0xE2A0B5DC971F303A,   667,  220 },
+    { 0xA8D9D1535CE3B396,   694,  228 },
+    { 0xFB9B7CD9A4A7443C,   720,  236 },
+    { 0xBB764C4CA7A44410,   747,  244 },
+    { 0x8BAB8EEFB6409C1A,   774,  252 },
+    { 0xD01FEF10A657842C,   800,  260 },
+    { 0x9B10A4E5E9913129,   827,  268 },
+    { 0xE7109BFBA19C0C9D,   853,  276 },
+    { 0xAC2820D9623BF429,   880,  284 },
+    { 0x80444B5E7AA7CF85,   907,  292 },
+    { 0xBF21E44003ACDD2D,   933,  300 },
+    { 0x8E679C2F5E44FF8F,   960,  308 },
+    { 0xD433179D9C8CB841,   986,  316 },
+    { 0x9E19DB92B4E31BA9,  1013,  324 },
+};
+
+int const cached_powers_min_exponent = -300;
+int const cached_powers_step = 8;
+
+/**
+ * @brief Binary exponents of the scaled boundaries, such that the integral
+ * part of the scaled value fits on 32 bits.
+ */
+int const alpha = -60;
+
+/**
+ * @brief Return a cached power c such that the binary exponent of the
+ * product of c and a normalized number of binary exponent e lies in
+ * [alpha, alpha+28].
+ */
+CachedPower const & get_cached_power(int e)
+{
+    // k = ceil((alpha-e-1) * log10(2)), without floating-point operations
+    int const f = alpha - e - 1;
+    int const k = (f * 78913) / (1 << 18) + (f > 0 ? 1 : 0);
+    int const index =
+        (k - cached_powers_min_exponent + cached_powers_step - 1)
+        / cached_powers_step;
+    return cached_powers[index];
+}
+
+/**
+ * @brief Return the number of decimal digits of n, and set power to the
+ * largest power of ten lower than or equal to n.
+ */
+int get_digits_count(uint32_t n, uint32_t & power)
+{
+    int count = 10;
+    power = 1000000000;
+    while(count > 1 && n < power)
     {
-        *it = '\0';
+        power /= 10;
+        --count;
     }
+    return count;
 }
 
 /**
- * @brief Add 1 to the integer contained in (buffer[0], buffer[n]) (end included).
- * @return 1 if a carry was used, 0 otherwise.
+ * @brief Move the last generated digit towards the scaled value w while the
+ * result stays within the rounding interval, cf. Loitsch, 5.3, and return
+ * the distance between the upper boundary and the digits.
  */
-int add1(char * buffer, int n)
+uint64_t round_weed(
+    char * digits, int length, uint64_t distance, uint64_t delta,
+    uint64_t rest, uint64_t ten_k)
 {
-    if(n < 0)
+    while(
+        rest < distance && delta - rest >= ten_k
+        && (rest + ten_k < distance || distance - rest > rest + ten_k - distance))
     {
-        return 1;
+        --digits[length-1];
+        rest += ten_k;
     }
-    
-    if(buffer[n] == '9')
+    return rest;
+}
+
+/**
+ * @brief Return 1 if w is greater than the digits, -1 if it is lower and 0
+ * if they are equal.
+ */
+int get_direction(uint64_t distance, uint64_t rest)
+{
+    return (rest > distance)?1:((rest < distance)?-1:0);
+}
+
+/**
+ * @brief Generate the shortest digits of a number in (low, high), adjust
+ * the decimal exponent of the last digit accordingly and set the position
+ * of w relative to the digits.
+ */
+int generate_digits(
+    DiyFp const & low, DiyFp const & w, DiyFp const & high,
+    char * digits, int & exponent, int & direction)
+{
+    uint64_t delta = high.f - low.f;
+    uint64_t distance = high.f - w.f;
+
+    int const shift = -high.e;
+    uint64_t const one = uint64_t(1) << shift;
+
+    uint32_t integral = static_cast<uint32_t>(high.f >> shift);
+    uint64_t fractional = high.f & (one - 1);
+
+    int length = 0;
+
+    uint32_t power;
+    int count = get_digits_count(integral, power);
+    while(count > 0)
     {
-        buffer[n] = '0';
-        return add1(buffer, n-1);
+        digits[length] = static_cast<char>('0' + integral / power);
+        ++length;
+        integral %= power;
+        --count;
+
+        uint64_t const rest = (uint64_t(integral) << shift) + fractional;
+        if(rest <= delta)
+        {
+            exponent += count;
+            direction = get_direction(
+                distance,
+                round_weed(
+                    digits, length, distance, delta, rest,
+                    uint64_t(power) << shift));
+            return length;
+        }
+
+        power /= 10;
     }
-    else
+
+    int fractional_count = 0;
+    while(true)
     {
-        buffer[n] += 1;
+        fractional *= 10;
+        digits[length] = static_cast<char>('0' + (fractional >> shift));
+        ++length;
+        fractional &= one - 1;
+        ++fractional_count;
+
+        delta *= 10;
+        distance *= 10;
+
+        if(fractional <= delta)
+        {
+            break;
+        }
     }
-    return 0;
+    exponent -= fractional_count;
+    direction = get_direction(
+        distance, round_weed(digits, length, distance, delta, fractional, one));
+    return length;
 }
 
 /**
- * @brief Round the integer contained in (buffer[0], buffer[n]) (end included)
- *        to the nearest factor of 10.
- * @return 1 if rounding was carried to next digit, 0 otherwise.
+ * @brief Write the shortest digits which read back as the positive, finite
+ * value, return their number, set the exponent of the first one and the
+ * position of the value relative to the digits (cf. get_direction).
  */
-int doround(char * buffer, unsigned int n)
+int get_shortest_digits(
+    double value, char * digits, int & exponent, int & direction)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint64_t const hidden_bit = uint64_t(1) << 52;
+    uint64_t const significand = bits & (hidden_bit - 1);
+    int const biased_exponent = static_cast<int>(bits >> 52);
+
+    DiyFp const v =
+        (biased_exponent == 0)
+        ?DiyFp{significand, 1-1075}
+        :DiyFp{significand + hidden_bit, biased_exponent-1075};
+
+    // Boundaries of the values which are rounded to v. The lower one is
+    // closer when v is a power of two.
+    DiyFp const high = normalize({2*v.f + 1, v.e - 1});
+    DiyFp low =
+        (significand == 0 && biased_exponent > 1)
+        ?DiyFp{4*v.f - 1, v.e - 2}
+        :DiyFp{2*v.f - 1, v.e - 1};
+    low.f <<= low.e - high.e;
+    low.e = high.e;
+
+    auto const & power = get_cached_power(high.e);
+    DiyFp const c{power.f, power.e};
+    DiyFp const scaled_w = multiply(normalize(v), c);
+    DiyFp scaled_low = multiply(low, c);
+    DiyFp scaled_high = multiply(high, c);
+
+    // Account for the imprecision of the products.
+    ++scaled_low.f;
+    --scaled_high.f;
+
+    int last_exponent = -power.k;
+    int length = generate_digits(
+        scaled_low, scaled_w, scaled_high, digits, last_exponent, direction);
+
+    while(length > 1 && digits[length-1] == '0')
+    {
+        --length;
+        ++last_exponent;
+    }
+
+    exponent = last_exponent + length - 1;
+    return length;
+}
+
+/// @brief Return the number of characters of the exponent of a DS.
+int get_exponent_length(int exponent)
 {
-    if(n >= strlen(buffer))
+    int length = (exponent < 0)?3:2;
+    if(exponent <= -100 || exponent >= 100)
     {
-        return 0;
+        length += 2;
     }
-    
-    char const c = buffer[n];
-    buffer[n] = 0;
-    if(c >= '5' && c <= '9')
+    else if(exponent <= -10 || exponent >= 10)
     {
-        return add1(buffer, n-1);
+        length += 1;
     }
-    
-    return 0;
+    return length;
 }
 
-int roundat(char * buffer, unsigned int i, int exponent) 
+/**
+ * @brief Write the decimal representation of an unsigned integer, return
+ * the end of the written characters.
+ */
+char * write_unsigned(uint64_t value, char * buffer)
 {
-    if(doround(buffer, i) != 0) 
+    char reversed[20];
+    int length = 0;
+    do
     {
-        exponent += 1;
-        switch(exponent) 
-        {
-            case -2:
-                strcpy(buffer, ".01");
-                break;
-            case -1:
-                strcpy(buffer, ".1");
-                break;
-            case 0:
-                strcpy(buffer, "1.");
-                break;
-            case 1:
-                strcpy(buffer, "10");
-                break;
-            case 2:
-                strcpy(buffer, "100");
-                break;
-            default:
-                sprintf(buffer, "1e%d", exponent);
-        }
-        return 1;
+        reversed[length] = static_cast<char>('0' + value % 10);
+        ++length;
+        value /= 10;
     }
-    return 0;
+    while(value != 0);
+
+    while(length > 0)
+    {
+        --length;
+        *buffer = reversed[length];
+        ++buffer;
+    }
+    return buffer;
 }
 
 }
@@ -115,96 +392,160 @@ namespace odil
 
 void write_ds(double f, char * buffer, int size)
 {
-    // Negative number: add initial '-' to buffer and process as positive number
-    if(f < 0)
+    // NaN and infinities have no DS representation
+    if(!std::isfinite(f))
     {
-        f = -f;
-        size -= 1;
-        *buffer = '-';
-        ++buffer;
+        throw Exception("DS items must be finite");
     }
-    
-    
-    char line[40];
-    sprintf(line, "%1.16e", f);
-    
-    if(line[0] == '-')
+
+    // Negative number: add initial '-' to buffer and process as positive
+    // number. This includes -0.
+    if(std::signbit(f))
     {
-        // Happens in the case of -0, other negative numbers have been already
-        // handled
         f = -f;
         size -= 1;
         *buffer = '-';
         ++buffer;
-        sprintf(line, "%1.16e", f);
-    }
-    
-    char * mantissa = line+1;
-    *mantissa = line[0];
-    
-    auto const end_of_mantissa = strcspn(mantissa, "eE");
-    mantissa[end_of_mantissa] = '\0';
-    int const exponent = strtol(mantissa + end_of_mantissa + 1, NULL, 10);
-    
-    if((exponent >= size) || (exponent < -3))
-    {
-        char exponent_buffer[6];
-        auto const exponent_length = sprintf(exponent_buffer, "e%d", exponent);
-        
-        auto const i = roundat(mantissa, size - 1 - exponent_length, exponent);
-        if(i == 1)
-        {
-            strcpy(buffer, mantissa);
-            return;
-        }
-        buffer[0] = mantissa[0];
-        buffer[1] = '.';
-        strncpy(buffer + i + 2, mantissa + 1, size - 2 - exponent_length);
-        buffer[size-exponent_length] = 0;
-        clean(buffer);
-        strcat(buffer, exponent_buffer);
     }
-    else if(exponent >= size - 2)
+
+    if(f == 0)
     {
-        roundat(mantissa, exponent + 1, exponent);
-        strcpy(buffer, mantissa);
+        buffer[0] = '0';
+        buffer[1] = '\0';
+        return;
     }
-    else if(exponent >= 0)
+
+    // At most 17 digits are required for a double.
+    char digits[17];
+    int exponent;
+    int direction;
+    int length = get_shortest_digits(f, digits, exponent, direction);
+
+    // Use the scientific notation for large and small numbers, and reduce
+    // the number of digits until the representation fits. Rounding the
+    // digits may increment the exponent and change the notation.
+    bool scientific;
+    while(true)
     {
-        auto const i = roundat(mantissa, size - 1, exponent);
-        if(i == 1)
+        scientific = (exponent >= size || exponent < -3);
+
+        int capacity;
+        if(scientific)
+        {
+            capacity = size - get_exponent_length(exponent);
+            // A single digit does not require a decimal point
+            capacity = (capacity >= 3)?(capacity-1):1;
+        }
+        else if(exponent >= 0)
+        {
+            // If needed, round to an integer
+            capacity = (exponent+1 < size)?(size-1):(exponent+1);
+        }
+        else
+        {
+            // Decimal point and leading zeros
+            capacity = size + exponent;
+        }
+        capacity = (capacity >= 1)?capacity:1;
+
+        if(length <= capacity)
+        {
+            break;
+        }
+
+        // Round to nearest, using the exact value to break apparent ties.
+        bool const round_up =
+            digits[capacity] > '5'
+            || (
+                digits[capacity] == '5'
+                && (length > capacity+1 || direction >= 0));
+        length = capacity;
+        if(round_up)
+        {
+            while(length > 0 && digits[length-1] == '9')
+            {
+                --length;
+            }
+            if(length == 0)
+            {
+                digits[0] = '1';
+                length = 1;
+                ++exponent;
+            }
+            else
+            {
+                ++digits[length-1];
+            }
+        }
+        while(length > 1 && digits[length-1] == '0')
         {
-            strcpy(buffer, mantissa);
-            return;
+            --length;
         }
-        strncpy(buffer, mantissa, exponent + 1);
-        buffer[exponent + 1] = '.';
-        strncpy(buffer + exponent + 2, mantissa + exponent + 1, size - exponent - 1);
-        buffer[size] = 0;
-        clean(buffer);
     }
-    else
+
+    if(scientific)
     {
-        int const i = roundat(mantissa, size + 1 + exponent, exponent);
-        if (i == 1)
+        *buffer = digits[0];
+        ++buffer;
+        if(length > 1)
         {
-            strcpy(buffer, mantissa);
-            return;
+            *buffer = '.';
+            ++buffer;
+            std::memcpy(buffer, digits+1, length-1);
+            buffer += length-1;
+        }
+        *buffer = 'e';
+        ++buffer;
+        if(exponent < 0)
+        {
+            *buffer = '-';
+            ++buffer;
         }
-        buffer[0] = '.';
-        for(int j=0; j< -1 - exponent; j++)
+        buffer = write_unsigned(std::abs(exponent), buffer);
+    }
+    else if(exponent >= 0)
+    {
+        if(length <= exponent+1)
         {
-            buffer[j+1] = '0';
+            std::memcpy(buffer, digits, length);
+            std::memset(buffer+length, '0', exponent+1-length);
+            buffer += exponent+1;
         }
-        if((i == 1) && (exponent != -1))
+        else
         {
-            buffer[-exponent] = '1';
+            std::memcpy(buffer, digits, exponent+1);
+            buffer += exponent+1;
+            *buffer = '.';
             ++buffer;
+            std::memcpy(buffer, digits+exponent+1, length-exponent-1);
+            buffer += length-exponent-1;
         }
-        strncpy(buffer - exponent, mantissa, size + 1 + exponent);
-        buffer[size] = 0;
-        clean(buffer);
     }
+    else
+    {
+        // No leading zero before the decimal point
+        *buffer = '.';
+        ++buffer;
+        std::memset(buffer, '0', -exponent-1);
+        buffer += -exponent-1;
+        std::memcpy(buffer, digits, length);
+        buffer += length;
+    }
+
+    *buffer = '\0';
+}
+
+void write_is(Value::Integer value, char * buffer)
+{
+    uint64_t magnitude = value;
+    if(value < 0)
+    {
+        *buffer = '-';
+        ++buffer;
+        // Two's complement negation, valid for the smallest integer
+        magnitude = 0 - magnitude;
+    }
+    *write_unsigned(magnitude, buffer) = '\0';
 }
 
 }
@@ -15,13 +15,34 @@
 #include <cstring>
 
 #include "odil/odil.h"
+#include "odil/Value.h"
 
 namespace odil
 {
 
-/// @brief Write a double as a DS to the buffer.
+/**
+ * @brief Write a finite double as a NUL-terminated DS to the buffer, which
+ * must hold at least size+1 characters.
+ *
+ * The digits which read back as f are computed with the Grisu2 algorithm,
+ * which yields the shortest ones for almost all values. They are used if
+ * they fit in size characters, otherwise the value is rounded to the
+ * nearest representation which fits. The formatting does not depend on the
+ * current locale and does not allocate memory.
+ *
+ * An exception is raised if f is NaN or infinite.
+ */
 ODIL_API void write_ds(double f, char * buffer, int size=16);
 
+/**
+ * @brief Write an integer as a NUL-terminated IS to the buffer, which must
+ * hold at least 21 characters.
+ *
+ * The formatting does not depend on the current locale and does not
+ * allocate memory.
+ */
+ODIL_API void write_is(Value::Integer value, char * buffer);
+
 }
 
 #endif // _1fe89041_9f3b_4536_a55a_81f045984a62
@@ -0,0 +1,223 @@
+#define BOOST_TEST_MODULE BatchReader
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "odil/BatchReader.h"
+#include "odil/DataSet.h"
+#include "odil/Exception.h"
+#include "odil/Projection.h"
+#include "odil/registry.h"
+#include "odil/Writer.h"
+
+struct Fixture
+{
+    std::vector<std::string> paths;
+    std::vector<odil::DataSet> data_sets;
+
+    Fixture()
+    {
+        for(int i=0; i<20; ++i)
+        {
+            odil::DataSet data_set;
+            data_set.add(
+                odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+            data_set.add(
+                odil::registry::SOPInstanceUID, {"1.2.3."+std::to_string(i)});
+            data_set.add(odil::registry::InstanceNumber, {i});
+
+            std::string const path("batch_"+std::to_string(i)+".dcm");
+            std::ofstream stream(path, std::ios::out | std::ios::binary);
+            odil::Writer::write_file(data_set, stream);
+
+            this->paths.push_back(path);
+            this->data_sets.push_back(data_set);
+        }
+    }
+
+    ~Fixture()
+    {
+        for(auto const & path: this->paths)
+        {
+            std::remove(path.c_str());
+        }
+    }
+};
+
+BOOST_AUTO_TEST_CASE(DefaultResult)
+{
+    odil::BatchReader::Result const result;
+    BOOST_REQUIRE(result.path.empty());
+    BOOST_REQUIRE_EQUAL(result.index, 0);
+    BOOST_REQUIRE(result.header.empty());
+    BOOST_REQUIRE(result.data_set.empty());
+    BOOST_REQUIRE(!result.error);
+}
+
+BOOST_FIXTURE_TEST_CASE(Ordered, Fixture)
+{
+    odil::BatchReader reader(4, true);
+    reader.queue_size = 2;
+
+    std::size_t index = 0;
+    reader.read(
+        this->paths, [&](odil::BatchReader::Result & result)
+        {
+            BOOST_REQUIRE_EQUAL(result.index, index);
+            BOOST_REQUIRE_EQUAL(result.path, this->paths[index]);
+            BOOST_REQUIRE(!result.error);
+            BOOST_REQUIRE(result.data_set == this->data_sets[index]);
+            BOOST_REQUIRE(
+                result.header.has(odil::registry::TransferSyntaxUID));
+            ++index;
+        });
+    BOOST_REQUIRE_EQUAL(index, this->paths.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(Unordered, Fixture)
+{
+    odil::BatchReader reader(4);
+
+    std::set<std::size_t> indices;
+    reader.read(
+        this->paths, [&](odil::BatchReader::Result & result)
+        {
+            BOOST_REQUIRE(!result.error);
+            BOOST_REQUIRE(result.data_set == this->data_sets[result.index]);
+            indices.insert(result.index);
+        });
+    BOOST_REQUIRE_EQUAL(indices.size(), this->paths.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(Next, Fixture)
+{
+    odil::BatchReader reader(3, true);
+    reader.projection = std::make_shared<odil::Projection>(
+        odil::Projection{odil::registry::InstanceNumber});
+    reader.start(this->paths);
+
+    odil::BatchReader::Result result;
+    std::size_t index = 0;
+    while(reader.next(result))
+    {
+        BOOST_REQUIRE_EQUAL(result.data_set.size(), 1);
+        BOOST_REQUIRE(
+            result.data_set.as_int(odil::registry::InstanceNumber)
+            == odil::Value::Integers({int(index)}));
+        ++index;
+    }
+    BOOST_REQUIRE_EQUAL(index, this->paths.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(Stop, Fixture)
+{
+    odil::BatchReader reader(2);
+    reader.start(this->paths);
+
+    odil::BatchReader::Result result;
+    BOOST_REQUIRE(reader.next(result));
+    reader.stop();
+    BOOST_REQUIRE(!reader.next(result));
+}
+
+/**
+ * @brief Start a reader whose reading threads block until release is set, and
+ * return once another thread waits in next. The waiting thread stores the
+ * value returned by next in returned.
+ */
+std::thread wait_for_next(
+    odil::BatchReader & reader, std::vector<std::string> const & paths,
+    std::atomic<bool> & release, std::atomic<int> & returned)
+{
+    reader.halt_condition = [&](odil::Tag const &) {
+        while(!release)
+        {
+            std::this_thread::yield();
+        }
+        return false;
+    };
+    reader.start(paths);
+
+    returned = -1;
+    std::thread thread([&]() {
+        odil::BatchReader::Result result;
+        returned = reader.next(result)?1:0;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    BOOST_REQUIRE_EQUAL(returned, -1);
+
+    return thread;
+}
+
+BOOST_FIXTURE_TEST_CASE(StopWhileWaiting, Fixture)
+{
+    odil::BatchReader reader(2);
+    std::atomic<bool> release(false);
+    std::atomic<int> returned(-1);
+    auto waiting = wait_for_next(reader, this->paths, release, returned);
+
+    // Stopping wakes the waiting thread, then joins the reading threads
+    std::thread stopping([&]() { reader.stop(); });
+    waiting.join();
+    BOOST_REQUIRE_EQUAL(returned, 0);
+
+    release = true;
+    stopping.join();
+}
+
+BOOST_FIXTURE_TEST_CASE(DestroyWhileWaiting, Fixture)
+{
+    std::unique_ptr<odil::BatchReader> reader(new odil::BatchReader(2));
+    std::atomic<bool> release(false);
+    std::atomic<int> returned(-1);
+    auto waiting = wait_for_next(*reader, this->paths, release, returned);
+
+    std::thread destroying([&]() { reader.reset(); });
+    waiting.join();
+    BOOST_REQUIRE_EQUAL(returned, 0);
+
+    release = true;
+    destroying.join();
+}
+
+BOOST_FIXTURE_TEST_CASE(Error, Fixture)
+{
+    auto paths = this->paths;
+    paths.insert(paths.begin()+1, "missing.dcm");
+
+    odil::BatchReader reader(2, true);
+    std::size_t errors = 0;
+    std::size_t count = 0;
+    reader.read(
+        paths, [&](odil::BatchReader::Result & result)
+        {
+            if(result.error)
+            {
+                ++errors;
+                BOOST_REQUIRE_EQUAL(result.index, 1);
+                BOOST_REQUIRE_THROW(
+                    std::rethrow_exception(result.error), odil::Exception);
+            }
+            ++count;
+        });
+    BOOST_REQUIRE_EQUAL(errors, 1);
+    BOOST_REQUIRE_EQUAL(count, paths.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(CallbackException, Fixture)
+{
+    odil::BatchReader reader(2);
+    BOOST_REQUIRE_THROW(
+        reader.read(
+            this->paths,
+            [](odil::BatchReader::Result &) { throw odil::Exception("Foo"); }),
+        odil::Exception);
+}
@@ -0,0 +1,121 @@
+#define BOOST_TEST_MODULE BinaryBuffer
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "odil/BinaryBuffer.h"
+#include "odil/Exception.h"
+
+BOOST_AUTO_TEST_CASE(DefaultConstructor)
+{
+    odil::BinaryBuffer const buffer;
+    BOOST_REQUIRE(buffer.empty());
+    BOOST_REQUIRE_EQUAL(buffer.get_fragments_count(), 0);
+    BOOST_REQUIRE_EQUAL(buffer.size(), 0);
+    BOOST_REQUIRE(!buffer.is_shared());
+}
+
+BOOST_AUTO_TEST_CASE(Size)
+{
+    odil::BinaryBuffer const buffer(100);
+    BOOST_REQUIRE(!buffer.empty());
+    BOOST_REQUIRE_EQUAL(buffer.get_fragments_count(), 1);
+    BOOST_REQUIRE_EQUAL(buffer.size(), 100);
+    BOOST_REQUIRE_EQUAL(buffer.get_fragment_size(0), 100);
+    BOOST_REQUIRE_EQUAL(
+        reinterpret_cast<std::uintptr_t>(buffer.data())
+            % odil::BinaryBuffer::alignment,
+        0);
+}
+
+BOOST_AUTO_TEST_CASE(Fragments)
+{
+    odil::BinaryBuffer::Fragments const fragments{{1, 2}, {}, {3, 4, 5, 6}};
+    odil::BinaryBuffer const buffer(fragments);
+    BOOST_REQUIRE_EQUAL(buffer.get_fragments_count(), 3);
+    BOOST_REQUIRE_EQUAL(buffer.size(), 6);
+    BOOST_REQUIRE(
+        buffer.get_offsets() == std::vector<std::size_t>({0, 2, 2}));
+    BOOST_REQUIRE_EQUAL(buffer.get_fragment_size(1), 0);
+    BOOST_REQUIRE_EQUAL(buffer.get_fragment_size(2), 4);
+    BOOST_REQUIRE_EQUAL(buffer.get_fragment(2)[0], 3);
+    BOOST_REQUIRE_EQUAL(buffer.data()[5], 6);
+    BOOST_REQUIRE(buffer.to_fragments() == fragments);
+
+    BOOST_REQUIRE_THROW(buffer.get_fragment(3), odil::Exception);
+    BOOST_REQUIRE_THROW(buffer.get_fragment_size(3), odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(AddFragment)
+{
+    odil::BinaryBuffer buffer;
+    for(uint8_t i=0; i<100; ++i)
+    {
+        auto const data = buffer.add_fragment(2);
+        data[0] = i;
+        data[1] = i+1;
+    }
+    BOOST_REQUIRE_EQUAL(buffer.get_fragments_count(), 100);
+    BOOST_REQUIRE_EQUAL(buffer.size(), 200);
+    for(uint8_t i=0; i<100; ++i)
+    {
+        BOOST_REQUIRE_EQUAL(buffer.get_fragment(i)[0], i);
+        BOOST_REQUIRE_EQUAL(buffer.get_fragment(i)[1], i+1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(CopyOnWrite)
+{
+    odil::BinaryBuffer buffer(odil::BinaryBuffer::Fragments{{1, 2}});
+    odil::BinaryBuffer copy(buffer);
+    BOOST_REQUIRE(buffer.is_shared());
+    BOOST_REQUIRE_EQUAL(
+        static_cast<odil::BinaryBuffer const &>(buffer).data(),
+        static_cast<odil::BinaryBuffer const &>(copy).data());
+
+    copy.data()[0] = 3;
+    BOOST_REQUIRE(!copy.is_shared());
+    BOOST_REQUIRE_EQUAL(buffer.data()[0], 1);
+    BOOST_REQUIRE_EQUAL(copy.data()[0], 3);
+    BOOST_REQUIRE(buffer != copy);
+}
+
+BOOST_AUTO_TEST_CASE(Move)
+{
+    odil::BinaryBuffer buffer(odil::BinaryBuffer::Fragments{{1, 2}});
+    auto const data = buffer.data();
+
+    odil::BinaryBuffer other(std::move(buffer));
+    BOOST_REQUIRE_EQUAL(other.data(), data);
+    BOOST_REQUIRE(buffer.empty());
+    BOOST_REQUIRE_EQUAL(buffer.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Wrap)
+{
+    std::shared_ptr<uint8_t const> data(
+        new uint8_t[4]{1, 2, 3, 4}, std::default_delete<uint8_t[]>());
+
+    odil::BinaryBuffer buffer(data, 4, {0, 1});
+    BOOST_REQUIRE(buffer.is_shared());
+    BOOST_REQUIRE_EQUAL(buffer.get_fragment(0)[0], 1);
+    BOOST_REQUIRE_EQUAL(buffer.get_fragment_size(1), 3);
+    BOOST_REQUIRE(buffer == odil::BinaryBuffer(odil::BinaryBuffer::Fragments{{1}, {2, 3, 4}}));
+
+    // Wrapped memory is never modified
+    buffer.data()[0] = 5;
+    BOOST_REQUIRE_EQUAL(data.get()[0], 1);
+    BOOST_REQUIRE_EQUAL(buffer.get_fragment(0)[0], 5);
+}
+
+BOOST_AUTO_TEST_CASE(WrapInvalidOffsets)
+{
+    std::shared_ptr<uint8_t const> data(
+        new uint8_t[4], std::default_delete<uint8_t[]>());
+    BOOST_REQUIRE_THROW(
+        odil::BinaryBuffer(data, 4, {2, 1}), odil::Exception);
+    BOOST_REQUIRE_THROW(
+        odil::BinaryBuffer(data, 4, {0, 5}), odil::Exception);
+}
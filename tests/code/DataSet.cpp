@@ -1,6 +1,10 @@
 #define BOOST_TEST_MODULE DataSet
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
 #include "odil/DataSet.h"
 #include "odil/Exception.h"
 #include "odil/Tag.h"
@@ -388,6 +392,128 @@ BOOST_AUTO_TEST_CASE(Remove)
     BOOST_CHECK(!dataset.has(tag));
 }
 
+BOOST_AUTO_TEST_CASE(Order)
+{
+    odil::DataSet dataset;
+    dataset.add(odil::registry::PatientName, {"Doe^John"});
+    dataset.add(odil::registry::SOPInstanceUID, {"1.2.3"});
+    dataset.add(odil::registry::PixelData, odil::VR::OB);
+    dataset.add(odil::registry::PatientID, {"DJ1234"});
+    dataset.add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+    dataset.remove(odil::registry::PixelData);
+
+    std::vector<odil::Tag> tags;
+    for(auto const & item: dataset)
+    {
+        tags.push_back(item.first);
+    }
+    std::vector<odil::Tag> const expected{
+        odil::registry::SOPInstanceUID,
+        odil::registry::PatientName, odil::registry::PatientID };
+    BOOST_CHECK(tags == expected);
+
+    BOOST_CHECK(
+        dataset.as_string(odil::registry::SOPInstanceUID)
+        == odil::Value::Strings({"1.2.3.4"}));
+    BOOST_CHECK(
+        dataset.as_string(odil::registry::PatientID)
+        == odil::Value::Strings({"DJ1234"}));
+}
+
+BOOST_AUTO_TEST_CASE(StableReferences)
+{
+    odil::DataSet dataset;
+    dataset.add(odil::registry::PatientName, {"Doe^John"});
+    auto & element = dataset[odil::registry::PatientName];
+    auto const & strings = element.as_string();
+
+    // Adding elements, before and after, does not move the others
+    for(uint16_t i=0; i<64; ++i)
+    {
+        dataset.add(odil::Tag(0x0009, 0x1000+i), {"before"}, odil::VR::LO);
+        dataset.add(odil::Tag(0x0011, 0x1000+i), {"after"}, odil::VR::LO);
+    }
+    dataset.remove(odil::Tag(0x0009, 0x1000));
+
+    BOOST_CHECK_EQUAL(&dataset[odil::registry::PatientName], &element);
+    BOOST_CHECK_EQUAL(&element.as_string(), &strings);
+    BOOST_CHECK(strings == odil::Value::Strings({"Doe^John"}));
+
+    odil::DataSet const copy(dataset);
+    BOOST_CHECK(copy == dataset);
+    BOOST_CHECK_NE(&copy[odil::registry::PatientName], &element);
+}
+
+BOOST_AUTO_TEST_CASE(ReuseRemoved)
+{
+    odil::DataSet dataset;
+    for(uint16_t i=0; i<16; ++i)
+    {
+        dataset.add(odil::Tag(0x0009, 0x1000+i), {int(i)}, odil::VR::SL);
+    }
+    auto const & last = dataset[odil::Tag(0x0009, 0x100f)];
+
+    // Removed elements are replaced, in any order
+    for(uint16_t i=0; i<8; ++i)
+    {
+        dataset.remove(odil::Tag(0x0009, 0x1000+2*i));
+    }
+    for(uint16_t i=0; i<8; ++i)
+    {
+        dataset.add(odil::Tag(0x0011, 0x1007-i), {int(i)}, odil::VR::SL);
+    }
+    BOOST_CHECK_EQUAL(&dataset[odil::Tag(0x0009, 0x100f)], &last);
+    BOOST_CHECK_EQUAL(dataset.size(), 16);
+
+    std::vector<odil::Tag> tags;
+    for(auto const & item: dataset)
+    {
+        tags.push_back(item.first);
+        BOOST_CHECK_EQUAL(item.second.size(), 1);
+    }
+    BOOST_CHECK(std::is_sorted(tags.begin(), tags.end()));
+    BOOST_CHECK(
+        dataset.as_int(odil::Tag(0x0011, 0x1000))
+        == odil::Value::Integers({7}));
+}
+
+BOOST_AUTO_TEST_CASE(ReplaceWhileIterating)
+{
+    odil::DataSet dataset;
+    dataset.add(odil::registry::PatientName, {"Doe^John"});
+    dataset.add(odil::registry::PatientID, {"DJ1234"});
+
+    // Replacing the value of an existing element keeps the iterators valid
+    std::size_t count = 0;
+    for(auto const & item: dataset)
+    {
+        dataset.add(item.first, {"Foo"});
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, 2);
+    BOOST_CHECK(
+        dataset.as_string(odil::registry::PatientID)
+        == odil::Value::Strings({"Foo"}));
+}
+
+BOOST_AUTO_TEST_CASE(Move)
+{
+    odil::DataSet dataset;
+    dataset.add(odil::registry::PatientName, {"Doe^John"});
+    auto const & element = dataset[odil::registry::PatientName];
+
+    // Moving keeps the elements in place
+    odil::DataSet other(std::move(dataset));
+    BOOST_CHECK_EQUAL(&other[odil::registry::PatientName], &element);
+    BOOST_CHECK(dataset.empty());
+
+    dataset.add(odil::registry::PatientID, {"DJ1234"});
+    dataset = std::move(other);
+    BOOST_CHECK_EQUAL(&dataset[odil::registry::PatientName], &element);
+    BOOST_CHECK(!dataset.has(odil::registry::PatientID));
+    BOOST_CHECK(other.empty());
+}
+
 BOOST_AUTO_TEST_CASE(RemoveMissing)
 {
     odil::Tag const tag("PatientID");
@@ -431,6 +557,79 @@ BOOST_AUTO_TEST_CASE(Difference)
     BOOST_CHECK(dataset1 != dataset3);
 }
 
+BOOST_AUTO_TEST_CASE(Hash)
+{
+    odil::DataSet dataset1;
+    dataset1.add("PatientID", {"DJ1234"});
+    dataset1.add("PatientAge", {"042Y"});
+
+    odil::DataSet dataset2(odil::registry::ExplicitVRLittleEndian);
+    dataset2.add("PatientAge", {"042Y"});
+    dataset2.add("PatientID", {"DJ1234"});
+
+    BOOST_CHECK_EQUAL(dataset1.get_hash(), dataset2.get_hash());
+
+    dataset2.as_string("PatientAge")[0] = "043Y";
+    BOOST_CHECK_NE(dataset1.get_hash(), dataset2.get_hash());
+
+    dataset2.remove("PatientAge");
+    dataset2.add("PatientAge", {"042Y"}, odil::VR::AS);
+    BOOST_CHECK_EQUAL(dataset1.get_hash(), dataset2.get_hash());
+
+    std::unordered_set<odil::DataSet> data_sets{dataset1};
+    BOOST_CHECK_EQUAL(data_sets.count(dataset2), 1);
+}
+
+BOOST_AUTO_TEST_CASE(HashMemoized)
+{
+    odil::DataSet data_set;
+    data_set.add("PatientID", {"DJ1234"});
+    auto const hash = data_set.get_hash();
+
+    // Modifications reset the memoized hash
+    data_set.add("PatientAge", {"042Y"});
+    BOOST_CHECK_NE(data_set.get_hash(), hash);
+    data_set.remove("PatientAge");
+    BOOST_CHECK_EQUAL(data_set.get_hash(), hash);
+    data_set.clear("PatientID");
+    BOOST_CHECK_NE(data_set.get_hash(), hash);
+    data_set.add("PatientID", {"DJ1234"});
+    BOOST_CHECK_EQUAL(data_set.get_hash(), hash);
+
+    // Copies keep the memoized hash
+    odil::DataSet const copy(data_set);
+    BOOST_CHECK_EQUAL(copy.get_hash(), hash);
+
+    // Elements exposed before computing the hash are not memoized
+    auto & patient_id = data_set.as_string("PatientID");
+    BOOST_CHECK_EQUAL(data_set.get_hash(), hash);
+    patient_id[0] = "DJ5678";
+    BOOST_CHECK_NE(data_set.get_hash(), hash);
+    patient_id[0] = "DJ1234";
+    BOOST_CHECK_EQUAL(data_set.get_hash(), hash);
+
+    auto & element = data_set["PatientID"];
+    element = odil::Element({"DJ5678"}, odil::VR::LO);
+    BOOST_CHECK_NE(data_set.get_hash(), hash);
+}
+
+BOOST_AUTO_TEST_CASE(EqualityHash)
+{
+    odil::DataSet data_set_1;
+    data_set_1.add("PatientID", {"DJ1234"});
+    odil::DataSet data_set_2;
+    data_set_2.add("PatientID", {"DJ5678"});
+
+    // Memoized hashes differ
+    BOOST_CHECK_NE(data_set_1.get_hash(), data_set_2.get_hash());
+    BOOST_CHECK(!(data_set_1 == data_set_2));
+
+    data_set_2.add("PatientID", {"DJ1234"});
+    BOOST_CHECK(data_set_1 == data_set_2);
+    BOOST_CHECK_EQUAL(data_set_1.get_hash(), data_set_2.get_hash());
+    BOOST_CHECK(data_set_1 == data_set_2);
+}
+
 BOOST_AUTO_TEST_CASE(Clear)
 {
     odil::DataSet data_set;
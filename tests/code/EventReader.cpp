@@ -0,0 +1,321 @@
+#define BOOST_TEST_MODULE EventReader
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "odil/DataSet.h"
+#include "odil/EventReader.h"
+#include "odil/registry.h"
+#include "odil/Tag.h"
+#include "odil/VR.h"
+#include "odil/Writer.h"
+
+/// @brief Record the events as strings.
+class Handler: public odil::EventReader::Handler
+{
+public:
+    std::vector<std::string> events;
+
+    virtual void begin_element(odil::Tag const & tag, odil::VR vr, uint32_t length)
+    {
+        this->events.push_back(
+            "begin_element "+std::string(tag)+" "+odil::as_string(vr)+" "
+            +std::to_string(length));
+    }
+
+    virtual void value(char const * data, std::size_t size)
+    {
+        this->events.push_back("value "+std::string(data, size));
+    }
+
+    virtual void end_element(odil::Tag const & tag)
+    {
+        this->events.push_back("end_element "+std::string(tag));
+    }
+
+    virtual void begin_sequence(odil::Tag const & tag, uint32_t)
+    {
+        this->events.push_back("begin_sequence "+std::string(tag));
+    }
+
+    virtual void end_sequence(odil::Tag const & tag)
+    {
+        this->events.push_back("end_sequence "+std::string(tag));
+    }
+
+    virtual void begin_item(uint32_t)
+    {
+        this->events.push_back("begin_item");
+    }
+
+    virtual void end_item()
+    {
+        this->events.push_back("end_item");
+    }
+};
+
+void do_test(
+    std::string const & transfer_syntax,
+    odil::Writer::ItemEncoding item_encoding)
+{
+    odil::DataSet item;
+    item.add(odil::registry::PatientID, {"1234"});
+
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::ReferencedStudySequence, {item, item});
+    data_set.add(
+        odil::registry::EncapsulatedDocument,
+        odil::Value::Binary({{'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j'}}),
+        odil::VR::OB);
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, transfer_syntax, item_encoding);
+    writer.write_data_set(data_set);
+
+    odil::EventReader const reader(stream, transfer_syntax, false, 8);
+    Handler handler;
+    reader.read_data_set(handler);
+
+    std::vector<std::string> const expected{
+        "begin_sequence 00081110",
+            "begin_item",
+                "begin_element 00100020 LO 4", "value 1234",
+                "end_element 00100020",
+            "end_item",
+            "begin_item",
+                "begin_element 00100020 LO 4", "value 1234",
+                "end_element 00100020",
+            "end_item",
+        "end_sequence 00081110",
+        "begin_element 00100010 PN 8", "value Doe^John",
+        "end_element 00100010",
+        "begin_element 00420011 OB 10", "value abcdefgh", "value ij",
+        "end_element 00420011"
+    };
+    BOOST_REQUIRE(handler.events == expected);
+}
+
+BOOST_AUTO_TEST_CASE(ExplicitVRLittleEndian)
+{
+    do_test(
+        odil::registry::ExplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength);
+    do_test(
+        odil::registry::ExplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::UndefinedLength);
+}
+
+BOOST_AUTO_TEST_CASE(ExplicitVRBigEndian)
+{
+    do_test(
+        odil::registry::ExplicitVRBigEndian_Retired,
+        odil::Writer::ItemEncoding::ExplicitLength);
+}
+
+BOOST_AUTO_TEST_CASE(ImplicitVRLittleEndian)
+{
+    do_test(
+        odil::registry::ImplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength);
+}
+
+BOOST_AUTO_TEST_CASE(ImplicitVRPixelData)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::BitsAllocated, {16});
+    data_set.add(
+        odil::registry::PixelData, odil::Value::Binary({{'a', 'b'}}),
+        odil::VR::OW);
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, odil::registry::ImplicitVRLittleEndian);
+    writer.write_data_set(data_set);
+
+    odil::EventReader const reader(
+        stream, odil::registry::ImplicitVRLittleEndian);
+    Handler handler;
+    reader.read_data_set(handler);
+
+    BOOST_REQUIRE_EQUAL(handler.events.size(), 6);
+    BOOST_REQUIRE_EQUAL(handler.events[3], "begin_element 7fe00010 OW 2");
+    BOOST_REQUIRE_EQUAL(handler.events[4], "value ab");
+}
+
+BOOST_AUTO_TEST_CASE(EncapsulatedPixelData)
+{
+    odil::DataSet data_set;
+    data_set.add(
+        odil::registry::PixelData,
+        odil::Value::Binary({{'a', 'b'}, {'c', 'd', 'e', 'f'}}), odil::VR::OB);
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, odil::registry::ExplicitVRLittleEndian);
+    writer.write_data_set(data_set);
+
+    odil::EventReader const reader(
+        stream, odil::registry::ExplicitVRLittleEndian);
+    Handler handler;
+    reader.read_data_set(handler);
+
+    std::vector<std::string> const expected{
+        "begin_element 7fe00010 OB 4294967295",
+            "begin_item", "value ab", "end_item",
+            "begin_item", "value cdef", "end_item",
+        "end_element 7fe00010"
+    };
+    BOOST_REQUIRE(handler.events == expected);
+}
+
+BOOST_AUTO_TEST_CASE(UndefinedLengthUN)
+{
+    // The content of a UN of undefined length is encoded in Implicit VR
+    // Little Endian, whatever the transfer syntax, PS3.5, 6.2.2. The VR of
+    // Pixel Data is found from the item.
+    odil::DataSet item;
+    item.add(odil::registry::BitsAllocated, {16});
+    item.add(
+        odil::registry::PixelData, odil::Value::Binary({{'a', 'b'}}),
+        odil::VR::OW);
+
+    std::ostringstream content;
+    odil::Writer const content_writer(
+        content, odil::registry::ImplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::UndefinedLength);
+    content_writer.write_element(odil::Element({item}, odil::VR::SQ));
+    // Skip the length of the sequence
+    auto const items = content.str().substr(4);
+
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired})
+    {
+        std::stringstream stream;
+        odil::Writer const writer(stream, transfer_syntax);
+        writer.write_tag(odil::registry::ReferencedStudySequence);
+        stream.write("UN\0\0", 4);
+        odil::Writer::write_binary(
+            uint32_t(0xffffffff), stream, writer.byte_ordering);
+        stream << items;
+        writer.write_data_set(data_set);
+
+        odil::EventReader const reader(stream, transfer_syntax);
+        Handler handler;
+        reader.read_data_set(handler);
+
+        BOOST_REQUIRE_EQUAL(handler.events.size(), 13);
+        BOOST_REQUIRE_EQUAL(handler.events[0], "begin_sequence 00081110");
+        BOOST_REQUIRE_EQUAL(handler.events[1], "begin_item");
+        BOOST_REQUIRE_EQUAL(handler.events[2], "begin_element 00280100 US 2");
+        BOOST_REQUIRE_EQUAL(handler.events[5], "begin_element 7fe00010 OW 2");
+        BOOST_REQUIRE_EQUAL(handler.events[6], "value ab");
+        BOOST_REQUIRE_EQUAL(handler.events[8], "end_item");
+        BOOST_REQUIRE_EQUAL(handler.events[9], "end_sequence 00081110");
+        BOOST_REQUIRE_EQUAL(
+            handler.events[10], "begin_element 00100010 PN 8");
+        BOOST_REQUIRE_EQUAL(handler.events[11], "value Doe^John");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(File)
+{
+    odil::DataSet data_set;
+    data_set.add(
+        odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+    data_set.add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+
+    std::stringstream stream;
+    odil::Writer::write_file(data_set, stream);
+
+    Handler handler;
+    auto const header = odil::EventReader::read_file(
+        stream, handler, false,
+        [](odil::Tag const & tag) { return tag == odil::registry::PatientName; });
+    BOOST_REQUIRE(
+        header.as_string(odil::registry::MediaStorageSOPInstanceUID)
+        == odil::Value::Strings({"1.2.3.4"}));
+
+    BOOST_REQUIRE_EQUAL(handler.events.size(), 6);
+    BOOST_REQUIRE_EQUAL(handler.events[0], "begin_element 00080016 UI 26");
+    BOOST_REQUIRE_EQUAL(handler.events[5], "end_element 00080018");
+}
+
+/// @brief Forward-only stream buffer on a string.
+class ForwardBuffer: public std::streambuf
+{
+public:
+    ForwardBuffer(std::string const & data)
+    : _data(data)
+    {
+        this->setg(&this->_data[0], &this->_data[0], &this->_data[0]+this->_data.size());
+    }
+
+private:
+    std::string _data;
+};
+
+BOOST_AUTO_TEST_CASE(NonSeekableHalt)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::StudyInstanceUID, {"1.23"});
+    data_set.add(odil::registry::SeriesInstanceUID, {"1.2.34"});
+
+    std::ostringstream data;
+    odil::Writer const writer(data, odil::registry::ExplicitVRLittleEndian);
+    writer.write_data_set(data_set);
+
+    ForwardBuffer buffer(data.str());
+    std::istream stream(&buffer);
+
+    odil::EventReader const reader(
+        stream, odil::registry::ExplicitVRLittleEndian);
+    auto const halt = [](odil::Tag const & tag) { return tag.group == 0x0020; };
+
+    Handler handler;
+    reader.read_data_set(handler, halt);
+    std::vector<std::string> const expected{
+        "begin_element 00100010 PN 8", "value Doe^John",
+        "end_element 00100010"};
+    BOOST_REQUIRE(handler.events == expected);
+
+    // The halting tag is kept by the reader for the next data set
+    Handler other_handler;
+    reader.read_data_set(other_handler);
+    std::vector<std::string> const other_expected{
+        "begin_element 0020000d UI 4", "value 1.23",
+        "end_element 0020000d",
+        "begin_element 0020000e UI 6", "value 1.2.34",
+        "end_element 0020000e"};
+    BOOST_REQUIRE(other_handler.events == other_expected);
+}
+
+BOOST_AUTO_TEST_CASE(NonSeekableReadTag)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::StudyInstanceUID, {"1.23"});
+
+    std::ostringstream data;
+    odil::Writer const writer(data, odil::registry::ExplicitVRLittleEndian);
+    writer.write_data_set(data_set);
+
+    ForwardBuffer buffer(data.str());
+    std::istream stream(&buffer);
+
+    odil::EventReader const reader(
+        stream, odil::registry::ExplicitVRLittleEndian);
+    Handler handler;
+    reader.read_data_set(
+        handler,
+        [](odil::Tag const & tag) { return tag == odil::registry::StudyInstanceUID; });
+    BOOST_REQUIRE(reader.read_tag() == odil::registry::StudyInstanceUID);
+}
@@ -0,0 +1,166 @@
+#define BOOST_TEST_MODULE IncrementalReader
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+#include "odil/DataSet.h"
+#include "odil/Exception.h"
+#include "odil/IncrementalReader.h"
+#include "odil/Reader.h"
+#include "odil/registry.h"
+#include "odil/VR.h"
+#include "odil/Writer.h"
+
+odil::DataSet create_data_set(bool empty_sequence)
+{
+    odil::DataSet nested;
+    nested.add(odil::registry::CodeValue, {"1234"});
+
+    odil::DataSet item;
+    item.add(odil::registry::PatientID, {"1234"});
+    item.add(odil::registry::ConceptNameCodeSequence, {nested});
+
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::ReferencedStudySequence, {item, item});
+    if(empty_sequence)
+    {
+        data_set.add(odil::registry::ReferencedSeriesSequence);
+    }
+    data_set.add(odil::registry::Rows, {256});
+    data_set.add(odil::registry::PixelSpacing, {1.5, 2.5});
+    data_set.add(odil::registry::StudyDescription, odil::VR::LO);
+    data_set.add(
+        odil::registry::RedPaletteColorLookupTableData,
+        odil::Value::Binary({{'a', 'b', 'c', 'd', 'e', 'f'}}),
+        odil::VR::OW);
+    data_set.add(
+        odil::registry::EncapsulatedDocument, odil::Value::Binary(),
+        odil::VR::OB);
+    return data_set;
+}
+
+void do_test(
+    std::string const & transfer_syntax,
+    odil::Writer::ItemEncoding item_encoding,
+    odil::DataSet const & data_set)
+{
+    std::stringstream stream;
+    odil::Writer const writer(stream, transfer_syntax, item_encoding);
+    writer.write_data_set(data_set);
+    auto const encoded = stream.str();
+
+    odil::Reader const reader(stream, transfer_syntax);
+    auto const expected = reader.read_data_set();
+
+    for(std::size_t const chunk_size: {1, 3, 7, 64, 1024})
+    {
+        odil::IncrementalReader incremental_reader(transfer_syntax);
+        for(std::size_t offset=0; offset<encoded.size(); offset+=chunk_size)
+        {
+            auto const size = std::min(chunk_size, encoded.size()-offset);
+            incremental_reader.feed(encoded.data()+offset, size);
+        }
+        BOOST_REQUIRE(incremental_reader.is_complete());
+        BOOST_REQUIRE(incremental_reader.finish() == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ExplicitVRLittleEndian)
+{
+    do_test(
+        odil::registry::ExplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength, create_data_set(true));
+    do_test(
+        odil::registry::ExplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::UndefinedLength, create_data_set(false));
+}
+
+BOOST_AUTO_TEST_CASE(ExplicitVRBigEndian)
+{
+    do_test(
+        odil::registry::ExplicitVRBigEndian_Retired,
+        odil::Writer::ItemEncoding::ExplicitLength, create_data_set(true));
+    do_test(
+        odil::registry::ExplicitVRBigEndian_Retired,
+        odil::Writer::ItemEncoding::UndefinedLength, create_data_set(false));
+}
+
+BOOST_AUTO_TEST_CASE(ImplicitVRLittleEndian)
+{
+    do_test(
+        odil::registry::ImplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength, create_data_set(true));
+}
+
+BOOST_AUTO_TEST_CASE(ImplicitVRPixelData)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::BitsAllocated, {16});
+    data_set.add(
+        odil::registry::PixelData, odil::Value::Binary({{'a', 'b'}}),
+        odil::VR::OW);
+    do_test(
+        odil::registry::ImplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength, data_set);
+}
+
+BOOST_AUTO_TEST_CASE(EncapsulatedPixelData)
+{
+    odil::DataSet data_set;
+    data_set.add(
+        odil::registry::PixelData,
+        odil::Value::Binary({{'a', 'b'}, {}, {'c', 'd', 'e', 'f'}}),
+        odil::VR::OB);
+    do_test(
+        odil::registry::ExplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength, data_set);
+}
+
+BOOST_AUTO_TEST_CASE(Incremental)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::PatientID, {"1234"});
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, odil::registry::ExplicitVRLittleEndian);
+    writer.write_data_set(data_set);
+    auto const encoded = stream.str();
+
+    odil::IncrementalReader reader(odil::registry::ExplicitVRLittleEndian);
+    // Header and value of Patient Name, first byte of Patient ID
+    reader.feed(encoded.data(), 17);
+    BOOST_REQUIRE(!reader.is_complete());
+    BOOST_REQUIRE_EQUAL(reader.get_data_set().size(), 1);
+    BOOST_REQUIRE(reader.get_data_set().has(odil::registry::PatientName));
+    BOOST_REQUIRE_THROW(reader.finish(), odil::Exception);
+
+    reader.feed(encoded.data()+17, encoded.size()-17);
+    BOOST_REQUIRE(reader.is_complete());
+    BOOST_REQUIRE(reader.finish() == data_set);
+    BOOST_REQUIRE(reader.get_data_set().empty());
+}
+
+BOOST_AUTO_TEST_CASE(InvalidItem)
+{
+    odil::DataSet item;
+    item.add(odil::registry::PatientID, {"1234"});
+    odil::DataSet data_set;
+    data_set.add(odil::registry::ReferencedStudySequence, {item});
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, odil::registry::ExplicitVRLittleEndian);
+    writer.write_data_set(data_set);
+    auto encoded = stream.str();
+    // Replace the Item tag by the Patient ID tag
+    encoded[12] = '\x10'; encoded[13] = '\x00';
+    encoded[14] = '\x20'; encoded[15] = '\x00';
+
+    odil::IncrementalReader reader(odil::registry::ExplicitVRLittleEndian);
+    BOOST_REQUIRE_THROW(
+        reader.feed(encoded.data(), encoded.size()), odil::Exception);
+}
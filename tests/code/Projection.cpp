@@ -0,0 +1,75 @@
+#define BOOST_TEST_MODULE Projection
+#include <boost/test/unit_test.hpp>
+
+#include "odil/Exception.h"
+#include "odil/Projection.h"
+#include "odil/registry.h"
+
+BOOST_AUTO_TEST_CASE(Empty)
+{
+    odil::Projection const projection;
+    BOOST_REQUIRE(projection.empty());
+    BOOST_REQUIRE(!projection.has(odil::registry::PatientName));
+}
+
+BOOST_AUTO_TEST_CASE(Tags)
+{
+    odil::Projection const projection{
+        odil::registry::PatientName, odil::registry::PatientID};
+    BOOST_REQUIRE(!projection.empty());
+    BOOST_REQUIRE(projection.has(odil::registry::PatientName));
+    BOOST_REQUIRE(projection.has(odil::registry::PatientID));
+    BOOST_REQUIRE(!projection.has(odil::registry::StudyDate));
+    BOOST_REQUIRE(projection.get_nested(odil::registry::PatientName) == nullptr);
+    BOOST_REQUIRE_THROW(
+        projection.get_nested(odil::registry::StudyDate), odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(Path)
+{
+    odil::Projection projection;
+    projection.add(odil::Projection::Path{
+        odil::registry::ReferencedStudySequence,
+        odil::registry::ReferencedSOPInstanceUID});
+    projection.add(odil::Projection::Path{
+        odil::registry::ReferencedStudySequence,
+        odil::registry::ReferencedSOPClassUID});
+
+    BOOST_REQUIRE(projection.has(odil::registry::ReferencedStudySequence));
+    auto const nested = projection.get_nested(
+        odil::registry::ReferencedStudySequence);
+    BOOST_REQUIRE(nested != nullptr);
+    BOOST_REQUIRE(nested->has(odil::registry::ReferencedSOPInstanceUID));
+    BOOST_REQUIRE(nested->has(odil::registry::ReferencedSOPClassUID));
+    BOOST_REQUIRE(!nested->has(odil::registry::ReferencedStudySequence));
+}
+
+BOOST_AUTO_TEST_CASE(PathInWholeElement)
+{
+    odil::Projection projection{odil::registry::ReferencedStudySequence};
+    projection.add(odil::Projection::Path{
+        odil::registry::ReferencedStudySequence,
+        odil::registry::ReferencedSOPInstanceUID});
+    BOOST_REQUIRE(
+        projection.get_nested(odil::registry::ReferencedStudySequence)
+        == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(WholeElementOverPath)
+{
+    odil::Projection projection;
+    projection.add(odil::Projection::Path{
+        odil::registry::ReferencedStudySequence,
+        odil::registry::ReferencedSOPInstanceUID});
+    projection.add(odil::registry::ReferencedStudySequence);
+    BOOST_REQUIRE(
+        projection.get_nested(odil::registry::ReferencedStudySequence)
+        == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(EmptyPath)
+{
+    odil::Projection projection;
+    BOOST_REQUIRE_THROW(
+        projection.add(odil::Projection::Path()), odil::Exception);
+}
@@ -1,22 +1,83 @@
 #define BOOST_TEST_MODULE Reader
 #include <boost/test/unit_test.hpp>
 
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <sstream>
+#include <string>
 #include <tuple>
+#include <vector>
 
 #include <dcmtk/config/osconfig.h>
 #include <dcmtk/dcmdata/dctk.h>
 #include <dcmtk/dcmdata/dcostrmb.h>
 
+#include "odil/BinaryBuffer.h"
 #include "odil/endian.h"
 #include "odil/Element.h"
+#include "odil/Exception.h"
+#include "odil/Projection.h"
 #include "odil/registry.h"
 #include "odil/Reader.h"
+#include "odil/StringPool.h"
 #include "odil/VR.h"
+#include "odil/Writer.h"
 #include "odil/dcmtk/conversion.h"
 
 #include "odil/json_converter.h"
 
+/// @brief Size from which allocations are counted.
+std::size_t const large_allocation_size = 100000;
+
+/// @brief Number of allocations of at least large_allocation_size bytes.
+std::size_t large_allocations = 0;
+
+void * operator new(std::size_t size)
+{
+    if(size >= large_allocation_size)
+    {
+        ++large_allocations;
+    }
+    auto const pointer = std::malloc(size);
+    if(pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void * pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void * pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+// Replace the array forms as well: they may not forward to the ones above
+// (e.g. with a sanitizer).
+void * operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void * pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void * pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
 BOOST_AUTO_TEST_CASE(Constructor)
 {
     std::istringstream stream;
@@ -300,6 +361,118 @@ BOOST_AUTO_TEST_CASE(UT)
         {std::string("Foo\\Bar")});
 }
 
+BOOST_AUTO_TEST_CASE(SQUndefinedLengthItem)
+{
+    // Explicit length sequence containing an undefined length item
+    std::string const data(
+        "\x08\x00\x64\x11" "SQ" "\x00\x00" "\x1a\x00\x00\x00"
+            "\xfe\xff\x00\xe0" "\xff\xff\xff\xff"
+                "\x28\x00\x10\x00" "US" "\x02\x00" "\x00\x02"
+            "\xfe\xff\x0d\xe0" "\x00\x00\x00\x00"
+        "\x28\x00\x11\x00" "US" "\x02\x00" "\x00\x01",
+        48);
+    std::istringstream stream(data);
+    odil::Reader const reader(
+        stream, odil::registry::ExplicitVRLittleEndian);
+    auto const data_set = reader.read_data_set();
+
+    BOOST_REQUIRE_EQUAL(data_set.size(), 2);
+    auto const & items = data_set.as_data_set(
+        odil::registry::FrameExtractionSequence);
+    BOOST_REQUIRE_EQUAL(items.size(), 1);
+    BOOST_REQUIRE(items[0].as_int(odil::registry::Rows) == odil::Value::Integers({512}));
+    BOOST_REQUIRE(data_set.as_int(odil::registry::Columns) == odil::Value::Integers({256}));
+}
+
+BOOST_AUTO_TEST_CASE(SQNested)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::Rows, {512});
+    for(int i=0; i<10; ++i)
+    {
+        odil::DataSet parent;
+        parent.add(odil::registry::Rows, {i});
+        parent.add(odil::registry::FrameExtractionSequence, {data_set});
+        data_set = parent;
+    }
+
+    std::stringstream stream;
+    odil::Writer const writer(
+        stream, odil::registry::ExplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength);
+    writer.write_data_set(data_set);
+
+    odil::Reader const reader(
+        stream, odil::registry::ExplicitVRLittleEndian);
+    BOOST_REQUIRE(reader.read_data_set() == data_set);
+}
+
+void do_projection_test(
+    std::string const & transfer_syntax,
+    odil::Writer::ItemEncoding item_encoding)
+{
+    odil::DataSet item;
+    item.add(odil::registry::Rows, {256});
+    item.add(odil::registry::Columns, {128});
+    item.add(odil::registry::PixelSpacing, {0.5, 0.25});
+
+    odil::DataSet data_set;
+    data_set.add(odil::registry::Rows, {512});
+    data_set.add(odil::registry::Columns, {1024});
+    data_set.add(odil::registry::FrameExtractionSequence, {item, item});
+    data_set.add(odil::registry::ReferencedStudySequence, {item});
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    if(transfer_syntax != odil::registry::ImplicitVRLittleEndian)
+    {
+        // Encapsulated pixel data
+        data_set.add(
+            odil::registry::PixelData,
+            odil::Value::Binary({{0x01, 0x02}, {0x03, 0x04, 0x05, 0x06}}),
+            odil::VR::OB);
+    }
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, transfer_syntax, item_encoding);
+    writer.write_data_set(data_set);
+
+    odil::Projection projection{
+        odil::registry::Rows, odil::registry::PatientName};
+    projection.add(odil::Projection::Path{
+        odil::registry::FrameExtractionSequence, odil::registry::Columns});
+
+    odil::Reader const reader(stream, transfer_syntax);
+    auto const projected = reader.read_data_set(projection);
+
+    odil::DataSet projected_item;
+    projected_item.add(odil::registry::Columns, {128});
+
+    odil::DataSet expected;
+    expected.add(odil::registry::Rows, {512});
+    expected.add(
+        odil::registry::FrameExtractionSequence,
+        {projected_item, projected_item});
+    expected.add(odil::registry::PatientName, {"Doe^John"});
+
+    BOOST_REQUIRE(projected == expected);
+    BOOST_REQUIRE(stream.peek() == EOF);
+}
+
+BOOST_AUTO_TEST_CASE(Projection)
+{
+    do_projection_test(
+        odil::registry::ExplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength);
+    do_projection_test(
+        odil::registry::ExplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::UndefinedLength);
+    do_projection_test(
+        odil::registry::ExplicitVRBigEndian_Retired,
+        odil::Writer::ItemEncoding::UndefinedLength);
+    do_projection_test(
+        odil::registry::ImplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength);
+}
+
 void do_file_test(
     odil::DataSet const & odil_data_set, std::string transfer_syntax,
     E_EncodingType item_encoding, E_GrpLenEncoding group_length_encoding)
@@ -400,3 +573,461 @@ BOOST_AUTO_TEST_CASE(File)
 
     do_file_test(odil_data_set);
 }
+
+BOOST_AUTO_TEST_CASE(FilePath)
+{
+    odil::DataSet data_set;
+    data_set.add(
+        odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+    data_set.add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+    data_set.add(
+        odil::registry::PixelData,
+        odil::Value::Binary({{0x01, 0x02, 0x03, 0x04}}), odil::VR::OW);
+
+    {
+        std::ofstream stream("foo.dcm", std::ios::out | std::ios::binary);
+        odil::Writer::write_file(
+            data_set, stream, odil::DataSet(),
+            odil::registry::ExplicitVRBigEndian_Retired);
+    }
+
+    odil::DataSet meta_information, other_data_set;
+    std::tie(meta_information, other_data_set) =
+        odil::Reader::read_file("foo.dcm");
+    BOOST_REQUIRE(other_data_set == data_set);
+    BOOST_REQUIRE(
+        meta_information.as_string(odil::registry::TransferSyntaxUID) ==
+        odil::Value::Strings({odil::registry::ExplicitVRBigEndian_Retired}));
+
+    std::tie(meta_information, other_data_set) = odil::Reader::read_file(
+        "foo.dcm", false,
+        [](odil::Tag const & tag) { return tag == odil::registry::PixelData; });
+    BOOST_REQUIRE(!other_data_set.has(odil::registry::PixelData));
+    BOOST_REQUIRE(other_data_set.has(odil::registry::SOPInstanceUID));
+
+    std::tie(meta_information, other_data_set) = odil::Reader::read_file(
+        "foo.dcm", odil::Projection{odil::registry::SOPInstanceUID});
+    BOOST_REQUIRE_EQUAL(other_data_set.size(), 1);
+    BOOST_REQUIRE(other_data_set.has(odil::registry::SOPInstanceUID));
+    BOOST_REQUIRE(meta_information.has(odil::registry::TransferSyntaxUID));
+
+    std::remove("foo.dcm");
+}
+
+BOOST_AUTO_TEST_CASE(FilePathDeferred)
+{
+    odil::DataSet item;
+    item.add(
+        odil::registry::SelectorOBValue,
+        odil::Value::Binary({{0x05, 0x06, 0x07, 0x08}}), odil::VR::OB);
+
+    odil::DataSet data_set;
+    data_set.add(
+        odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+    data_set.add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+    data_set.add(
+        odil::registry::FrameExtractionSequence,
+        odil::Element({item}, odil::VR::SQ));
+    data_set.add(
+        odil::registry::PixelData,
+        odil::Value::Binary({{0x01, 0x02, 0x03, 0x04}}), odil::VR::OW);
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired})
+    {
+        for(auto const & item_encoding: {
+            odil::Writer::ItemEncoding::ExplicitLength,
+            odil::Writer::ItemEncoding::UndefinedLength})
+        {
+            {
+                std::ofstream stream(
+                    "foo.dcm", std::ios::out | std::ios::binary);
+                odil::Writer::write_file(
+                    data_set, stream, odil::DataSet(), transfer_syntax,
+                    item_encoding);
+            }
+
+            auto const other_data_set =
+                odil::Reader::read_file("foo.dcm", false,
+                    [](odil::Tag const &) { return false; }, 4).second;
+            BOOST_REQUIRE(other_data_set == data_set);
+        }
+    }
+
+    std::remove("foo.dcm");
+}
+
+BOOST_AUTO_TEST_CASE(FilePathDeferredEncapsulated)
+{
+    odil::DataSet data_set;
+    data_set.add(
+        odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+    data_set.add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+    data_set.add(
+        odil::registry::PixelData,
+        odil::Value::Binary({{0x01, 0x02}, {0x0a, 0x0b, 0x0c, 0x0d}}),
+        odil::VR::OB);
+    data_set.add(
+        odil::registry::DataSetTrailingPadding,
+        odil::Value::Binary({{0x00, 0x00}}), odil::VR::OB);
+
+    {
+        std::ofstream stream("foo.dcm", std::ios::out | std::ios::binary);
+        odil::Writer::write_file(data_set, stream);
+    }
+
+    // Too small to be deferred
+    auto const small_data_set = odil::Reader::read_file("foo.dcm", false,
+        [](odil::Tag const &) { return false; }, 1000).second;
+    BOOST_REQUIRE(small_data_set == data_set);
+
+    auto const other_data_set = odil::Reader::read_file("foo.dcm", false,
+        [](odil::Tag const &) { return false; }, 4).second;
+    BOOST_REQUIRE(
+        other_data_set.as_string(odil::registry::SOPInstanceUID)
+        == odil::Value::Strings({"1.2.3.4"}));
+    BOOST_REQUIRE(
+        other_data_set.as_binary(odil::registry::DataSetTrailingPadding)
+        == data_set.as_binary(odil::registry::DataSetTrailingPadding));
+
+    // The fragments are read from the file when first accessed: modify them
+    // in place beforehand.
+    {
+        std::fstream stream(
+            "foo.dcm", std::ios::in | std::ios::out | std::ios::binary);
+        std::string const content{
+            std::istreambuf_iterator<char>(stream),
+            std::istreambuf_iterator<char>()};
+        auto const position = content.find("\x0a\x0b\x0c\x0d");
+        BOOST_REQUIRE(position != std::string::npos);
+        stream.seekp(position);
+        stream.put(0x2a);
+    }
+
+    auto const & pixel_data = other_data_set.as_binary_buffer(
+        odil::registry::PixelData);
+    BOOST_REQUIRE_EQUAL(pixel_data.get_fragments_count(), 2);
+    BOOST_REQUIRE(
+        pixel_data.get_offsets() == std::vector<std::size_t>({0, 2}));
+    BOOST_REQUIRE_EQUAL(pixel_data.data()[1], 0x02);
+    BOOST_REQUIRE_EQUAL(pixel_data.data()[2], 0x2a);
+    BOOST_REQUIRE_EQUAL(pixel_data.data()[5], 0x0d);
+
+    std::remove("foo.dcm");
+}
+
+BOOST_AUTO_TEST_CASE(FilePathBinaryBuffer)
+{
+    odil::DataSet data_set;
+    data_set.add(
+        odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+    data_set.add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+    data_set.add(
+        odil::registry::RedPaletteColorLookupTableData,
+        odil::Value::Binary({{0x01, 0x02, 0x03, 0x04}}), odil::VR::OW);
+    data_set.add(
+        odil::registry::PixelData,
+        odil::Value::Binary({{0x01, 0x02}, {0x03, 0x04, 0x05, 0x06}}),
+        odil::VR::OB);
+
+    {
+        std::ofstream stream("foo.dcm", std::ios::out | std::ios::binary);
+        odil::Writer::write_file(data_set, stream);
+    }
+
+    // Native value: copied from the memory-mapped file by default
+    auto const copied_data_set = odil::Reader::read_file("foo.dcm").second;
+    BOOST_REQUIRE(copied_data_set == data_set);
+    BOOST_REQUIRE(
+        !copied_data_set.as_binary_buffer(
+            odil::registry::RedPaletteColorLookupTableData).is_shared());
+
+    auto const other_data_set = odil::Reader::read_file(
+        "foo.dcm", false, [](odil::Tag const &) { return false; }, 0,
+        true).second;
+    BOOST_REQUIRE(other_data_set == data_set);
+
+    // Native value: shared with the memory-mapped file
+    auto const & lut = other_data_set.as_binary_buffer(
+        odil::registry::RedPaletteColorLookupTableData);
+    BOOST_REQUIRE(lut.is_shared());
+    BOOST_REQUIRE_EQUAL(lut.size(), 4);
+
+    // Encapsulated value: contiguous fragments
+    auto const & pixel_data = other_data_set.as_binary_buffer(
+        odil::registry::PixelData);
+    BOOST_REQUIRE_EQUAL(pixel_data.get_fragments_count(), 2);
+    BOOST_REQUIRE(
+        pixel_data.get_offsets() == std::vector<std::size_t>({0, 2}));
+    BOOST_REQUIRE_EQUAL(pixel_data.data()[5], 0x06);
+
+    std::remove("foo.dcm");
+}
+
+BOOST_AUTO_TEST_CASE(FilePathWriteBack)
+{
+    odil::DataSet data_set;
+    data_set.add(
+        odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+    data_set.add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+    data_set.add(odil::registry::Rows, {2});
+    data_set.add(
+        odil::registry::PixelData,
+        odil::Value::Binary({{0x01, 0x02, 0x03, 0x04}}), odil::VR::OW);
+
+    {
+        std::ofstream stream("foo.dcm", std::ios::out | std::ios::binary);
+        odil::Writer::write_file(data_set, stream);
+    }
+
+    // The values do not refer to the file: it can be overwritten
+    auto other_data_set = odil::Reader::read_file("foo.dcm").second;
+    other_data_set.add(odil::registry::PatientName, {"Doe^John"});
+    {
+        std::ofstream stream("foo.dcm", std::ios::out | std::ios::binary);
+        odil::Writer::write_file(other_data_set, stream);
+    }
+
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    BOOST_REQUIRE(other_data_set == data_set);
+    BOOST_REQUIRE(odil::Reader::read_file("foo.dcm").second == data_set);
+
+    std::remove("foo.dcm");
+}
+
+BOOST_AUTO_TEST_CASE(NativeIntegers)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::SelectorSSValue, {1234, -5678});
+    data_set.add(
+        odil::registry::SelectorULValue,
+        odil::Value::Integers({12345678, 4000000000}));
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired})
+    {
+        std::stringstream stream;
+        odil::Writer const writer(stream, transfer_syntax);
+        writer.write_data_set(data_set);
+
+        odil::Reader const reader(stream, transfer_syntax);
+        auto const other_data_set = reader.read_data_set();
+
+        auto const & ss = other_data_set[odil::registry::SelectorSSValue];
+        BOOST_REQUIRE(ss.get_value().has_native_integers());
+        BOOST_REQUIRE(
+            ss.get_value().get_integer_format()
+            == odil::Value::IntegerFormat::Int16);
+        BOOST_REQUIRE_EQUAL(ss.size(), 2);
+
+        BOOST_REQUIRE(other_data_set == data_set);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(StringPool)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::SOPClassUID, {odil::registry::CTImageStorage});
+    data_set.add(odil::registry::Modality, {"CT"});
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, odil::registry::ExplicitVRLittleEndian);
+    writer.write_data_set(data_set);
+    auto const encoded = stream.str();
+
+    auto const string_pool = std::make_shared<odil::StringPool>();
+    std::vector<odil::DataSet> data_sets;
+    for(int i=0; i<2; ++i)
+    {
+        std::istringstream stream(encoded);
+        odil::Reader reader(stream, odil::registry::ExplicitVRLittleEndian);
+        reader.string_pool = string_pool;
+        data_sets.push_back(reader.read_data_set());
+        BOOST_REQUIRE(data_sets.back() == data_set);
+    }
+
+    BOOST_REQUIRE_EQUAL(string_pool->size(), 2);
+    auto const & const_data_sets = data_sets;
+    BOOST_REQUIRE_EQUAL(
+        &const_data_sets[0].as_string(odil::registry::Modality),
+        &const_data_sets[1].as_string(odil::registry::Modality));
+}
+
+BOOST_AUTO_TEST_CASE(NoCopy)
+{
+    odil::DataSet item;
+    item.add(
+        odil::registry::PixelData,
+        odil::Element(
+            odil::BinaryBuffer(2*large_allocation_size), odil::VR::OB));
+
+    odil::DataSet data_set;
+    data_set.add(
+        odil::registry::PixelData,
+        odil::Element(
+            odil::BinaryBuffer(2*large_allocation_size), odil::VR::OB));
+    data_set.add(
+        odil::registry::TextValue,
+        {std::string(2*large_allocation_size, 'a')}, odil::VR::UT);
+    data_set.add(odil::registry::ContentSequence, {item});
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, odil::registry::ExplicitVRLittleEndian);
+    writer.write_data_set(data_set);
+
+    // Each large value is allocated once, and moved up to the data set
+    odil::Reader const reader(stream, odil::registry::ExplicitVRLittleEndian);
+    large_allocations = 0;
+    auto const other_data_set = reader.read_data_set();
+    BOOST_REQUIRE_EQUAL(large_allocations, 3);
+
+    BOOST_REQUIRE(other_data_set == data_set);
+}
+
+BOOST_AUTO_TEST_CASE(KeepEncodedValues)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::SliceThickness, {1.5});
+    data_set.add(odil::registry::Rows, {512});
+    data_set.add(odil::registry::PixelSpacing, {0.5, 0.25});
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired})
+    {
+        std::stringstream stream;
+        odil::Writer const writer(stream, transfer_syntax);
+        writer.write_data_set(data_set);
+
+        odil::Reader reader(stream, transfer_syntax);
+        reader.keep_encoded_values = true;
+        auto const other_data_set = reader.read_data_set();
+
+        for(auto const & item: other_data_set)
+        {
+            BOOST_REQUIRE(item.second.get_value().is_encoded());
+        }
+
+        BOOST_REQUIRE(other_data_set == data_set);
+        BOOST_REQUIRE(
+            other_data_set.as_string(odil::registry::PatientName, 0)
+            == "Doe^John");
+        BOOST_REQUIRE_EQUAL(
+            other_data_set.as_int(odil::registry::Rows, 0), 512);
+    }
+}
+
+/// @brief Forward-only stream buffer on a string.
+class ForwardBuffer: public std::streambuf
+{
+public:
+    ForwardBuffer(std::string const & data)
+    : _data(data)
+    {
+        this->setg(&this->_data[0], &this->_data[0], &this->_data[0]+this->_data.size());
+    }
+
+private:
+    std::string _data;
+};
+
+BOOST_AUTO_TEST_CASE(NonSeekable)
+{
+    odil::DataSet item;
+    item.add(odil::registry::Rows, {256});
+
+    odil::DataSet data_set;
+    data_set.add(odil::registry::FrameExtractionSequence, {item, item});
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::PixelData, {{0x01, 0x02}}, odil::VR::OB);
+
+    std::ostringstream data;
+    odil::Writer const writer(
+        data, odil::registry::ExplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::UndefinedLength);
+    writer.write_data_set(data_set);
+
+    ForwardBuffer buffer(data.str());
+    std::istream stream(&buffer);
+    BOOST_REQUIRE(stream.tellg() == std::streampos(-1));
+
+    odil::Reader const reader(stream, odil::registry::ExplicitVRLittleEndian);
+    auto const other_data_set = reader.read_data_set(
+        [](odil::Tag const & tag) { return tag == odil::registry::PixelData; });
+    BOOST_REQUIRE(stream.good());
+    BOOST_REQUIRE_EQUAL(other_data_set.size(), 2);
+    BOOST_REQUIRE(
+        other_data_set.as_data_set(odil::registry::FrameExtractionSequence)
+        == data_set.as_data_set(odil::registry::FrameExtractionSequence));
+
+    // The halting tag is kept by the reader
+    BOOST_REQUIRE(reader.read_tag() == odil::registry::PixelData);
+    auto const element = reader.read_element(odil::registry::PixelData);
+    BOOST_REQUIRE(element == data_set[odil::registry::PixelData]);
+}
+
+BOOST_AUTO_TEST_CASE(NonSeekableProjection)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::PatientID, {"DJ1234"});
+    data_set.add(odil::registry::StudyInstanceUID, {"1.2.3"});
+    data_set.add(odil::registry::SeriesInstanceUID, {"1.2.3.4"});
+
+    std::ostringstream data;
+    odil::Writer const writer(data, odil::registry::ExplicitVRLittleEndian);
+    writer.write_data_set(data_set);
+
+    ForwardBuffer buffer(data.str());
+    std::istream stream(&buffer);
+
+    odil::Reader const reader(stream, odil::registry::ExplicitVRLittleEndian);
+    auto const halt = [](odil::Tag const & tag) { return tag.group == 0x0020; };
+    auto const other_data_set = reader.read_data_set(
+        odil::Projection{odil::registry::PatientName}, halt);
+    BOOST_REQUIRE_EQUAL(other_data_set.size(), 1);
+    BOOST_REQUIRE(other_data_set.has(odil::registry::PatientName));
+
+    // The halting tag is kept by the reader, not by the temporary one
+    BOOST_REQUIRE(reader.read_tag() == odil::registry::StudyInstanceUID);
+    auto const element = reader.read_element(
+        odil::registry::StudyInstanceUID);
+    BOOST_REQUIRE(element == data_set[odil::registry::StudyInstanceUID]);
+
+    // A kept tag is handed over to the next temporary reader
+    BOOST_REQUIRE(reader.read_data_set(odil::Projection{}, halt).empty());
+    auto const rest = reader.read_data_set(
+        odil::Projection{odil::registry::SeriesInstanceUID});
+    BOOST_REQUIRE(
+        rest.as_string(odil::registry::SeriesInstanceUID)
+        == odil::Value::Strings({"1.2.3.4"}));
+}
+
+BOOST_AUTO_TEST_CASE(NonSeekableFile)
+{
+    odil::DataSet data_set;
+    data_set.add(
+        odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+    data_set.add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+
+    std::ostringstream data;
+    odil::Writer::write_file(data_set, data);
+
+    ForwardBuffer buffer(data.str());
+    std::istream stream(&buffer);
+    auto const header_and_data_set = odil::Reader::read_file(stream);
+    BOOST_REQUIRE(header_and_data_set.second == data_set);
+    BOOST_REQUIRE(
+        header_and_data_set.first.as_string(
+            odil::registry::MediaStorageSOPInstanceUID)
+        == odil::Value::Strings({"1.2.3.4"}));
+}
+
+BOOST_AUTO_TEST_CASE(FilePathMissing)
+{
+    BOOST_REQUIRE_THROW(
+        odil::Reader::read_file("does_not_exist.dcm"), odil::Exception);
+}
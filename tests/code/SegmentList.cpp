@@ -0,0 +1,88 @@
+#define BOOST_TEST_MODULE SegmentList
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "odil/SegmentList.h"
+
+std::string concatenate(odil::SegmentList const & segments)
+{
+    std::string result;
+    for(auto const & segment: segments.get_segments())
+    {
+        result.append(
+            reinterpret_cast<char const *>(segment.data), segment.size);
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(Constructor)
+{
+    odil::SegmentList const segments;
+    BOOST_REQUIRE_EQUAL(
+        segments.get_threshold(), odil::SegmentList::default_threshold);
+    BOOST_REQUIRE(segments.get_segments().empty());
+    BOOST_REQUIRE_EQUAL(segments.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Stream)
+{
+    odil::SegmentList segments;
+    segments.get_stream() << "foo";
+    segments.get_stream().put('-');
+    segments.get_stream() << "bar";
+
+    // Contiguous stored data is kept in a single segment
+    BOOST_REQUIRE_EQUAL(segments.get_segments().size(), 1);
+    BOOST_REQUIRE_EQUAL(concatenate(segments), "foo-bar");
+}
+
+BOOST_AUTO_TEST_CASE(Reference)
+{
+    std::shared_ptr<uint8_t const> const data(
+        new uint8_t[3]{ 'b', 'a', 'r' }, std::default_delete<uint8_t[]>());
+
+    odil::SegmentList segments(2);
+    segments.get_stream() << "foo";
+    segments.append_reference(data, 3);
+    segments.append_reference(data, 0);
+    segments.get_stream() << "baz";
+
+    auto const list = segments.get_segments();
+    BOOST_REQUIRE_EQUAL(list.size(), 3);
+    BOOST_REQUIRE(list[1].data == data.get());
+    BOOST_REQUIRE_EQUAL(list[1].size, 3);
+    BOOST_REQUIRE_EQUAL(segments.size(), 9);
+    BOOST_REQUIRE_EQUAL(concatenate(segments), "foobarbaz");
+}
+
+BOOST_AUTO_TEST_CASE(ReferenceOwnership)
+{
+    std::weak_ptr<uint8_t const> weak;
+    odil::SegmentList segments(2);
+    {
+        std::shared_ptr<uint8_t const> const data(
+            new uint8_t[3]{ 'b', 'a', 'r' }, std::default_delete<uint8_t[]>());
+        weak = data;
+        segments.append_reference(data, 3);
+    }
+
+    // The list keeps the referenced data alive until it is cleared
+    BOOST_REQUIRE(!weak.expired());
+    BOOST_REQUIRE_EQUAL(concatenate(segments), "bar");
+    segments.clear();
+    BOOST_REQUIRE(weak.expired());
+}
+
+BOOST_AUTO_TEST_CASE(Clear)
+{
+    odil::SegmentList segments;
+    segments.get_stream() << "foo";
+    segments.clear();
+    BOOST_REQUIRE(segments.get_segments().empty());
+
+    segments.get_stream() << "bar";
+    BOOST_REQUIRE_EQUAL(concatenate(segments), "bar");
+}
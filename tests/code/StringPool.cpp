@@ -0,0 +1,83 @@
+#define BOOST_TEST_MODULE StringPool
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include "odil/DataSet.h"
+#include "odil/registry.h"
+#include "odil/StringPool.h"
+#include "odil/Value.h"
+
+BOOST_AUTO_TEST_CASE(Constructor)
+{
+    odil::StringPool const pool;
+    BOOST_REQUIRE_EQUAL(
+        pool.get_max_length(), odil::StringPool::default_max_length);
+    BOOST_REQUIRE_EQUAL(pool.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Intern)
+{
+    odil::StringPool pool;
+    odil::Value const value1 = pool.intern({"1.2.3.4"});
+    odil::Value const value2 = pool.intern({"1.2.3.4"});
+    odil::Value const value3 = pool.intern({"1.2.3.5"});
+
+    BOOST_REQUIRE_EQUAL(pool.size(), 2);
+    BOOST_REQUIRE(value1.as_strings() == odil::Value::Strings({"1.2.3.4"}));
+    BOOST_REQUIRE_EQUAL(&value1.as_strings(), &value2.as_strings());
+    BOOST_REQUIRE_NE(&value1.as_strings(), &value3.as_strings());
+    BOOST_REQUIRE(value1 == value2);
+    BOOST_REQUIRE(value1 != value3);
+}
+
+BOOST_AUTO_TEST_CASE(Modify)
+{
+    odil::StringPool pool;
+    odil::Value value = pool.intern({"CT"});
+    value.as_strings()[0] = "MR";
+
+    odil::Value const other = pool.intern({"CT"});
+    BOOST_REQUIRE(other.as_strings() == odil::Value::Strings({"CT"}));
+}
+
+BOOST_AUTO_TEST_CASE(TooLong)
+{
+    odil::StringPool pool(4);
+    odil::Value const value = pool.intern({"ab", "cde"});
+    BOOST_REQUIRE(value.as_strings() == odil::Value::Strings({"ab", "cde"}));
+    BOOST_REQUIRE_EQUAL(pool.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Clear)
+{
+    odil::StringPool pool;
+    pool.intern({"CT"});
+    pool.clear();
+    BOOST_REQUIRE_EQUAL(pool.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(InternDataSet)
+{
+    odil::DataSet item;
+    item.add(odil::registry::ReferencedSOPClassUID, {"1.2.3"});
+
+    odil::DataSet data_set;
+    data_set.add(odil::registry::SOPClassUID, {"1.2.3"});
+    data_set.add(odil::registry::ReferencedStudySequence, {item});
+    data_set.add(odil::registry::Rows, {256});
+
+    odil::DataSet const expected = data_set;
+
+    odil::StringPool pool;
+    pool.intern(data_set);
+
+    BOOST_REQUIRE(data_set == expected);
+    BOOST_REQUIRE_EQUAL(pool.size(), 1);
+
+    auto const & const_data_set = data_set;
+    BOOST_REQUIRE_EQUAL(
+        &const_data_set.as_string(odil::registry::SOPClassUID),
+        &const_data_set.as_data_set(odil::registry::ReferencedStudySequence)[0]
+            .as_string(odil::registry::ReferencedSOPClassUID));
+}
@@ -0,0 +1,313 @@
+#define BOOST_TEST_MODULE Transcoder
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "odil/DataSet.h"
+#include "odil/Exception.h"
+#include "odil/Reader.h"
+#include "odil/registry.h"
+#include "odil/Transcoder.h"
+#include "odil/Value.h"
+#include "odil/VR.h"
+#include "odil/Writer.h"
+
+odil::DataSet create_data_set()
+{
+    odil::DataSet item;
+    item.add(odil::registry::CodeValue, {"1234"});
+    item.add(odil::registry::CodingSchemeDesignator, {"DCM"});
+
+    odil::DataSet data_set;
+    data_set.add(odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+    data_set.add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::SliceThickness, {1.5});
+    data_set.add(odil::registry::FrameIncrementPointer, {"00181063"});
+    data_set.add(odil::registry::ConceptNameCodeSequence, {item, item});
+    data_set.add(odil::registry::Rows, {4});
+    data_set.add(odil::registry::Columns, {3});
+    data_set.add(odil::registry::BitsAllocated, {16});
+    data_set.add(odil::registry::PixelRepresentation, {1});
+    data_set.add(
+        odil::registry::SmallestImagePixelValue, odil::Value::Integers{-2},
+        odil::VR::SS);
+    data_set.add(odil::registry::FrameTimeVector, {0.5, 12.25});
+    data_set.add(odil::registry::NumberOfWaveformSamples, {123456});
+
+    odil::Value::Binary pixel_data(1);
+    for(unsigned int i=0; i<4*3*2; ++i)
+    {
+        pixel_data[0].push_back(i);
+    }
+    data_set.add(odil::registry::PixelData, pixel_data, odil::VR::OW);
+
+    return data_set;
+}
+
+std::string write(
+    odil::DataSet const & data_set, std::string const & transfer_syntax,
+    odil::Writer::ItemEncoding item_encoding)
+{
+    std::ostringstream stream;
+    odil::Writer const writer(stream, transfer_syntax, item_encoding, true);
+    writer.write_data_set(data_set);
+    return stream.str();
+}
+
+std::string transcode(
+    std::string const & data, std::string const & input_transfer_syntax,
+    std::string const & output_transfer_syntax, std::size_t buffer_size=65536)
+{
+    std::istringstream input(data);
+    std::ostringstream output;
+    odil::Transcoder transcoder(
+        input, input_transfer_syntax, output, output_transfer_syntax,
+        buffer_size);
+    transcoder.transcode_data_set();
+    return output.str();
+}
+
+odil::DataSet read(std::string const & data, std::string const & transfer_syntax)
+{
+    std::istringstream stream(data);
+    odil::Reader const reader(stream, transfer_syntax);
+    return reader.read_data_set();
+}
+
+BOOST_AUTO_TEST_CASE(IsSupported)
+{
+    BOOST_REQUIRE(
+        odil::Transcoder::is_supported(odil::registry::ImplicitVRLittleEndian));
+    BOOST_REQUIRE(
+        odil::Transcoder::is_supported(odil::registry::ExplicitVRLittleEndian));
+    BOOST_REQUIRE(
+        odil::Transcoder::is_supported(
+            odil::registry::ExplicitVRBigEndian_Retired));
+    BOOST_REQUIRE(
+        !odil::Transcoder::is_supported(odil::registry::JPEGBaselineProcess1));
+    BOOST_REQUIRE(
+        !odil::Transcoder::is_supported(
+            odil::registry::DeflatedExplicitVRLittleEndian));
+}
+
+BOOST_AUTO_TEST_CASE(Unsupported)
+{
+    std::istringstream input;
+    std::ostringstream output;
+    BOOST_REQUIRE_THROW(
+        odil::Transcoder(
+            input, odil::registry::JPEGBaselineProcess1,
+            output, odil::registry::ExplicitVRLittleEndian),
+        odil::Exception);
+    BOOST_REQUIRE_THROW(
+        odil::Transcoder(
+            input, odil::registry::ExplicitVRLittleEndian,
+            output, odil::registry::JPEGBaselineProcess1),
+        odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(AllSyntaxes)
+{
+    std::vector<std::string> const transfer_syntaxes{
+        odil::registry::ImplicitVRLittleEndian,
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired};
+    std::vector<odil::Writer::ItemEncoding> const item_encodings{
+        odil::Writer::ItemEncoding::ExplicitLength,
+        odil::Writer::ItemEncoding::UndefinedLength};
+
+    auto const data_set = create_data_set();
+    for(auto const & input_transfer_syntax: transfer_syntaxes)
+    {
+        for(auto const & item_encoding: item_encodings)
+        {
+            auto const input = write(
+                data_set, input_transfer_syntax, item_encoding);
+            for(auto const & output_transfer_syntax: transfer_syntaxes)
+            {
+                auto const output = transcode(
+                    input, input_transfer_syntax, output_transfer_syntax);
+                BOOST_REQUIRE(
+                    read(output, output_transfer_syntax) == data_set);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SameSyntax)
+{
+    // Sequences and items of undefined length, no group length: the
+    // transcoded data is identical to the input
+    auto const data_set = create_data_set();
+    std::ostringstream stream;
+    odil::Writer const writer(
+        stream, odil::registry::ExplicitVRBigEndian_Retired,
+        odil::Writer::ItemEncoding::UndefinedLength);
+    writer.write_data_set(data_set);
+    auto const input = stream.str();
+
+    auto const output = transcode(
+        input, odil::registry::ExplicitVRBigEndian_Retired,
+        odil::registry::ExplicitVRBigEndian_Retired);
+    BOOST_REQUIRE(output == input);
+}
+
+BOOST_AUTO_TEST_CASE(SmallBuffer)
+{
+    auto const data_set = create_data_set();
+    auto const input = write(
+        data_set, odil::registry::ImplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength);
+    auto const output = transcode(
+        input, odil::registry::ImplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired, 8);
+    BOOST_REQUIRE(
+        read(output, odil::registry::ExplicitVRBigEndian_Retired) == data_set);
+}
+
+BOOST_AUTO_TEST_CASE(UndefinedLengthUN)
+{
+    // The content of a UN of undefined length is encoded in Implicit VR
+    // Little Endian, whatever the transfer syntax, PS3.5, 6.2.2
+    odil::DataSet item;
+    item.add(odil::registry::CodeValue, {"1234"});
+    item.add(odil::registry::CodingSchemeDesignator, {"DCM"});
+
+    std::ostringstream content;
+    odil::Writer::write_binary(
+        odil::registry::Item.group, content, odil::ByteOrdering::LittleEndian);
+    odil::Writer::write_binary(
+        odil::registry::Item.element, content,
+        odil::ByteOrdering::LittleEndian);
+    odil::Writer::write_binary(
+        uint32_t(0xffffffff), content, odil::ByteOrdering::LittleEndian);
+    odil::Writer(
+        content, odil::ByteOrdering::LittleEndian, false).write_data_set(item);
+    for(auto const & tag: {
+        odil::registry::ItemDelimitationItem,
+        odil::registry::SequenceDelimitationItem})
+    {
+        odil::Writer::write_binary(
+            tag.group, content, odil::ByteOrdering::LittleEndian);
+        odil::Writer::write_binary(
+            tag.element, content, odil::ByteOrdering::LittleEndian);
+        odil::Writer::write_binary(
+            uint32_t(0), content, odil::ByteOrdering::LittleEndian);
+    }
+
+    odil::DataSet expected;
+    expected.add(odil::registry::ConceptNameCodeSequence, {item});
+    expected.add(odil::registry::PatientName, {"Doe^John"});
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired})
+    {
+        std::ostringstream input;
+        odil::Writer const writer(input, transfer_syntax);
+        writer.write_tag(odil::registry::ConceptNameCodeSequence);
+        input.write("UN\0\0", 4);
+        odil::Writer::write_binary(
+            uint32_t(0xffffffff), input, writer.byte_ordering);
+        input << content.str();
+
+        odil::DataSet patient_name;
+        patient_name.add(odil::registry::PatientName, {"Doe^John"});
+        writer.write_data_set(patient_name);
+
+        auto const output = transcode(
+            input.str(), transfer_syntax,
+            odil::registry::ExplicitVRLittleEndian);
+        BOOST_REQUIRE(
+            read(output, odil::registry::ExplicitVRLittleEndian) == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TooLong)
+{
+    odil::DataSet data_set;
+    data_set.add(
+        odil::registry::RedPaletteColorLookupTableData,
+        odil::Value::Binary{odil::Value::Binary::value_type(70000)},
+        odil::VR::OW);
+    data_set.add(
+        odil::registry::LUTData, odil::Value::Integers(40000), odil::VR::US);
+    auto const input = write(
+        data_set, odil::registry::ImplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength);
+    BOOST_REQUIRE_THROW(
+        transcode(
+            input, odil::registry::ImplicitVRLittleEndian,
+            odil::registry::ExplicitVRLittleEndian),
+        odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(File)
+{
+    auto const data_set = create_data_set();
+    std::stringstream input;
+    odil::Writer::write_file(
+        data_set, input, odil::DataSet(),
+        odil::registry::ImplicitVRLittleEndian);
+
+    std::stringstream output;
+    odil::Transcoder::transcode_file(
+        input, output, odil::registry::ExplicitVRBigEndian_Retired);
+
+    auto const header_and_data_set = odil::Reader::read_file(output);
+    BOOST_REQUIRE(
+        header_and_data_set.first.as_string(
+            odil::registry::TransferSyntaxUID, 0)
+        == odil::registry::ExplicitVRBigEndian_Retired);
+    BOOST_REQUIRE(header_and_data_set.second == data_set);
+}
+
+BOOST_AUTO_TEST_CASE(FilePath)
+{
+    auto const data_set = create_data_set();
+    {
+        std::ofstream stream("transcoder.dcm", std::ios::out | std::ios::binary);
+        odil::Writer::write_file(
+            data_set, stream, odil::DataSet(),
+            odil::registry::ImplicitVRLittleEndian);
+    }
+
+    // Transcoding in place does not truncate the input before reading it
+    odil::Transcoder::transcode_file(
+        "transcoder.dcm", "transcoder.dcm",
+        odil::registry::ExplicitVRBigEndian_Retired);
+
+    auto const header_and_data_set =
+        odil::Reader::read_file("transcoder.dcm");
+    BOOST_REQUIRE(
+        header_and_data_set.first.as_string(
+            odil::registry::TransferSyntaxUID, 0)
+        == odil::registry::ExplicitVRBigEndian_Retired);
+    BOOST_REQUIRE(header_and_data_set.second == data_set);
+
+    std::remove("transcoder.dcm");
+}
+
+BOOST_AUTO_TEST_CASE(FilePathUnsupported)
+{
+    auto const data_set = create_data_set();
+    {
+        std::ofstream stream("transcoder.dcm", std::ios::out | std::ios::binary);
+        odil::Writer::write_file(data_set, stream);
+    }
+
+    // A failed transcoding leaves the output untouched
+    BOOST_REQUIRE_THROW(
+        odil::Transcoder::transcode_file(
+            "transcoder.dcm", "transcoder.dcm",
+            odil::registry::JPEGBaselineProcess1),
+        odil::Exception);
+    BOOST_REQUIRE(odil::Reader::read_file("transcoder.dcm").second == data_set);
+
+    std::remove("transcoder.dcm");
+}
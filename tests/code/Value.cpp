@@ -1,6 +1,14 @@
 #define BOOST_TEST_MODULE Value
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "odil/BinaryBuffer.h"
 #include "odil/DataSet.h"
 #include "odil/Exception.h"
 #include "odil/Value.h"
@@ -99,6 +107,33 @@ void test_equality(
     BOOST_CHECK(value_1 != value_4);
 }
 
+template<typename TContainer>
+void test_copy(
+    TContainer const & contents, odil::Value::Type type,
+    TContainer const & (odil::Value::*getter)() const)
+{
+    odil::Value const value(contents);
+
+    odil::Value const copy(value);
+    test_contents(copy, contents, type, getter);
+
+    // Assignment to a value of another type
+    odil::Value assigned(odil::Value::Strings{"foo"});
+    if(type == odil::Value::Type::Strings)
+    {
+        assigned = odil::Value::Integers{1};
+    }
+    assigned = value;
+    test_contents(assigned, contents, type, getter);
+
+    odil::Value moved(std::move(assigned));
+    test_contents(moved, contents, type, getter);
+
+    odil::Value move_assigned(odil::Value::Reals{1.});
+    move_assigned = std::move(moved);
+    test_contents(move_assigned, contents, type, getter);
+}
+
 struct Visitor
 {
     typedef std::string result_type;
@@ -141,6 +176,8 @@ void test(
 
     test_equality(container, other_container);
 
+    test_copy(container, type, getter);
+
     test_visitor(container);
 }
  
@@ -201,3 +238,523 @@ BOOST_AUTO_TEST_CASE(Binary)
         odil::Value::Type::Binary,
         &odil::Value::as_binary, &odil::Value::as_binary);
 }
+
+BOOST_AUTO_TEST_CASE(BinaryDeferred)
+{
+    unsigned int calls = 0;
+    odil::Value::BinaryLoader const loader = [&calls]()
+    {
+        ++calls;
+        return odil::BinaryBuffer(odil::Value::Binary({{0x1, 0x2}}));
+    };
+
+    odil::Value value(loader);
+    BOOST_CHECK(value.get_type() == odil::Value::Type::Binary);
+    BOOST_CHECK_EQUAL(calls, 0);
+
+    BOOST_CHECK(value.as_binary() == odil::Value::Binary({{0x1, 0x2}}));
+    BOOST_CHECK_EQUAL(value.size(), 1);
+    BOOST_CHECK(value == odil::Value({{0x1, 0x2}}));
+    BOOST_CHECK_EQUAL(calls, 1);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryDeferredClear)
+{
+    unsigned int calls = 0;
+    odil::Value value(
+        [&calls]()
+        {
+            ++calls;
+            return odil::BinaryBuffer(odil::Value::Binary({{0x1, 0x2}}));
+        });
+    value.clear();
+    BOOST_CHECK(value.empty());
+    BOOST_CHECK_EQUAL(calls, 0);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryDeferredCopy)
+{
+    unsigned int calls = 0;
+    odil::Value value(
+        [&calls]()
+        {
+            ++calls;
+            return odil::BinaryBuffer(odil::Value::Binary({{0x1, 0x2}}));
+        });
+
+    odil::Value copy(value);
+    BOOST_CHECK_EQUAL(calls, 0);
+    BOOST_CHECK(copy.as_binary() == odil::Value::Binary({{0x1, 0x2}}));
+    BOOST_CHECK_EQUAL(calls, 1);
+
+    odil::Value moved(std::move(value));
+    BOOST_CHECK_EQUAL(calls, 1);
+    BOOST_CHECK(moved.as_binary() == odil::Value::Binary({{0x1, 0x2}}));
+    BOOST_CHECK_EQUAL(calls, 2);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryDeferredConcurrent)
+{
+    std::atomic<unsigned int> calls(0);
+    odil::Value const value(
+        [&calls]()
+        {
+            ++calls;
+            return odil::BinaryBuffer(odil::Value::Binary({{0x1, 0x2}}));
+        });
+
+    // Concurrent const accesses load the content once, and keep it
+    std::vector<odil::BinaryBuffer const *> buffers(4, nullptr);
+    std::vector<std::thread> threads;
+    for(std::size_t i=0; i<buffers.size(); ++i)
+    {
+        threads.emplace_back(
+            [&value, &buffers, i]() { buffers[i] = &value.as_binary_buffer(); });
+    }
+    for(auto & thread: threads)
+    {
+        thread.join();
+    }
+
+    BOOST_CHECK_EQUAL(calls, 1);
+    for(auto const buffer: buffers)
+    {
+        BOOST_CHECK_EQUAL(buffer, buffers[0]);
+    }
+
+    // Other const accesses do not discard the loaded content
+    BOOST_CHECK(value.as_binary() == odil::Value::Binary({{0x1, 0x2}}));
+    BOOST_CHECK_EQUAL(&value.as_binary_buffer(), buffers[0]);
+    BOOST_CHECK_EQUAL(buffers[0]->data()[1], 0x2);
+    BOOST_CHECK_EQUAL(calls, 1);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryBuffer)
+{
+    odil::BinaryBuffer buffer(odil::Value::Binary({{0x1, 0x2}, {0x3}}));
+    odil::Value value(buffer);
+    BOOST_CHECK(value.get_type() == odil::Value::Type::Binary);
+    BOOST_CHECK(value.has_binary_buffer());
+    BOOST_CHECK_EQUAL(value.size(), 2);
+    BOOST_CHECK(!value.empty());
+    BOOST_CHECK(value.as_binary_buffer() == buffer);
+
+    // Same content in both representations
+    BOOST_CHECK(value == odil::Value({{0x1, 0x2}, {0x3}}));
+    BOOST_CHECK(odil::Value({{0x1, 0x2}, {0x3}}) == value);
+    BOOST_CHECK(value != odil::Value({{0x1, 0x2}, {0x4}}));
+    BOOST_CHECK(value.has_binary_buffer());
+
+    // Conversion to fragments
+    value.as_binary()[1][0] = 0x4;
+    BOOST_CHECK(!value.has_binary_buffer());
+    BOOST_CHECK(value.as_binary() == odil::Value::Binary({{0x1, 0x2}, {0x4}}));
+
+    // Conversion to a buffer
+    auto const & converted = value.as_binary_buffer();
+    BOOST_CHECK(value.has_binary_buffer());
+    BOOST_CHECK_EQUAL(converted.get_fragments_count(), 2);
+    BOOST_CHECK_EQUAL(converted.get_fragment(1)[0], 0x4);
+
+    BOOST_CHECK_THROW(odil::Value({1}).as_binary_buffer(), odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryBufferConstConversion)
+{
+    odil::Value const value(
+        odil::BinaryBuffer(odil::Value::Binary({{0x1, 0x2}, {0x3}})));
+
+    // The references returned by const accessors remain valid
+    auto const & buffer = value.as_binary_buffer();
+    auto const & fragments = value.as_binary();
+    BOOST_CHECK(value.has_binary_buffer());
+    BOOST_CHECK_EQUAL(&value.as_binary_buffer(), &buffer);
+    BOOST_CHECK_EQUAL(&value.as_binary(), &fragments);
+    BOOST_CHECK_EQUAL(buffer.data()[2], 0x3);
+    BOOST_CHECK(fragments == odil::Value::Binary({{0x1, 0x2}, {0x3}}));
+}
+
+BOOST_AUTO_TEST_CASE(BinaryFragmentsConstConversion)
+{
+    odil::Value const value({{0x1, 0x2}, {0x3}});
+
+    auto const & fragments = value.as_binary();
+    auto const & buffer = value.as_binary_buffer();
+    BOOST_CHECK(!value.has_binary_buffer());
+    BOOST_CHECK_EQUAL(&value.as_binary(), &fragments);
+    BOOST_CHECK_EQUAL(&value.as_binary_buffer(), &buffer);
+    BOOST_CHECK(fragments == odil::Value::Binary({{0x1, 0x2}, {0x3}}));
+    BOOST_CHECK_EQUAL(buffer.get_fragments_count(), 2);
+    BOOST_CHECK_EQUAL(buffer.data()[2], 0x3);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryConversionModified)
+{
+    odil::Value value({{0x1, 0x2}});
+    odil::Value const & const_value = value;
+    BOOST_CHECK_EQUAL(const_value.as_binary_buffer().data()[0], 0x1);
+
+    // Non-const accessors discard the converted representation
+    value.as_binary()[0][0] = 0x3;
+    BOOST_CHECK_EQUAL(const_value.as_binary_buffer().data()[0], 0x3);
+    value.clear();
+    BOOST_CHECK(const_value.as_binary_buffer().empty());
+}
+
+BOOST_AUTO_TEST_CASE(BinaryBufferClear)
+{
+    odil::Value value(odil::BinaryBuffer(4));
+    value.clear();
+    BOOST_CHECK(value.empty());
+    BOOST_CHECK(value.get_type() == odil::Value::Type::Binary);
+}
+
+BOOST_AUTO_TEST_CASE(CopyOnWrite)
+{
+    odil::Value const value({1, 2, 3});
+
+    odil::Value copy(value);
+    odil::Value const & const_copy = copy;
+    BOOST_CHECK_EQUAL(&const_copy.as_integers(), &value.as_integers());
+
+    copy.as_integers().push_back(4);
+    BOOST_CHECK(value.as_integers() == odil::Value::Integers({1, 2, 3}));
+    BOOST_CHECK(copy.as_integers() == odil::Value::Integers({1, 2, 3, 4}));
+}
+
+BOOST_AUTO_TEST_CASE(CopyOnWriteExposed)
+{
+    odil::Value value({1, 2, 3});
+    auto & integers = value.as_integers();
+
+    // A reference to the content exists: it is not shared anymore
+    odil::Value const copy(value);
+    BOOST_CHECK_NE(&copy.as_integers(), &value.as_integers());
+
+    integers.push_back(4);
+    BOOST_CHECK(value.as_integers() == odil::Value::Integers({1, 2, 3, 4}));
+    BOOST_CHECK(copy.as_integers() == odil::Value::Integers({1, 2, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(CopyOnWriteReassigned)
+{
+    odil::Value value({1, 2, 3});
+    value.as_integers().push_back(4);
+
+    // The exposed content is replaced: copies share the new content
+    value = odil::Value({5, 6});
+    odil::Value const & const_value = value;
+    odil::Value const copy(value);
+    BOOST_CHECK_EQUAL(&copy.as_integers(), &const_value.as_integers());
+    BOOST_CHECK(copy.as_integers() == odil::Value::Integers({5, 6}));
+}
+
+BOOST_AUTO_TEST_CASE(CopyOnWriteDataSets)
+{
+    odil::DataSet item;
+    item.add("PatientID", {"DJ1234"});
+    odil::Value const value(odil::Value::DataSets{item});
+
+    odil::Value copy(value);
+    copy.as_data_sets()[0].add("PatientName", {"Doe^John"});
+    BOOST_CHECK(!value.as_data_sets()[0].has("PatientName"));
+    BOOST_CHECK(copy.as_data_sets()[0].has("PatientName"));
+}
+
+BOOST_AUTO_TEST_CASE(CopyOnWriteClear)
+{
+    odil::Value const value({1, 2, 3});
+    odil::Value copy(value);
+    copy.clear();
+    BOOST_CHECK(copy.empty());
+    BOOST_CHECK(value.as_integers() == odil::Value::Integers({1, 2, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(NativeIntegers)
+{
+    int16_t const items[] = {1234, -5678};
+    odil::BinaryBuffer buffer(sizeof(items));
+    std::memcpy(buffer.data(), items, sizeof(items));
+
+    odil::Value value(buffer, odil::Value::IntegerFormat::Int16);
+    BOOST_CHECK(value.get_type() == odil::Value::Type::Integers);
+    BOOST_CHECK(value.has_native_integers());
+    BOOST_CHECK(
+        value.get_integer_format() == odil::Value::IntegerFormat::Int16);
+    BOOST_CHECK(value.as_native_integers() == buffer);
+    BOOST_CHECK_EQUAL(value.size(), 2);
+    BOOST_CHECK(!value.empty());
+
+    odil::Value const copy(value);
+    BOOST_CHECK(copy == value);
+    BOOST_CHECK(copy.has_native_integers());
+
+    // Const accesses keep the native integers
+    BOOST_CHECK(value == odil::Value({1234, -5678}));
+    BOOST_CHECK(value.has_native_integers());
+    BOOST_CHECK(copy.as_integers() == odil::Value::Integers({1234, -5678}));
+    BOOST_CHECK(copy.has_native_integers());
+
+    // Widening
+    BOOST_CHECK(value.as_integers() == odil::Value::Integers({1234, -5678}));
+    BOOST_CHECK(!value.has_native_integers());
+    BOOST_CHECK_THROW(value.as_native_integers(), odil::Exception);
+
+    BOOST_CHECK(copy.has_native_integers());
+}
+
+BOOST_AUTO_TEST_CASE(NativeIntegersConstWidening)
+{
+    uint16_t const items[] = {1234, 5678};
+    odil::BinaryBuffer buffer(sizeof(items));
+    std::memcpy(buffer.data(), items, sizeof(items));
+    odil::Value const value(buffer, odil::Value::IntegerFormat::UInt16);
+
+    auto const & native_integers = value.as_native_integers();
+    auto const & integers = value.as_integers();
+    BOOST_CHECK(value.has_native_integers());
+    BOOST_CHECK_EQUAL(&value.as_integers(), &integers);
+    BOOST_CHECK(integers == odil::Value::Integers({1234, 5678}));
+    BOOST_CHECK(native_integers == buffer);
+}
+
+BOOST_AUTO_TEST_CASE(NativeIntegersConcurrentWidening)
+{
+    int32_t const items[] = {1234, -5678, 9012};
+    odil::BinaryBuffer buffer(sizeof(items));
+    std::memcpy(buffer.data(), items, sizeof(items));
+    odil::Value const value(buffer, odil::Value::IntegerFormat::Int32);
+
+    // Concurrent const accesses widen the integers once
+    std::vector<odil::Value::Integers const *> integers(4, nullptr);
+    std::vector<std::thread> threads;
+    for(std::size_t i=0; i<integers.size(); ++i)
+    {
+        threads.emplace_back(
+            [&value, &integers, i]() { integers[i] = &value.as_integers(); });
+    }
+    for(auto & thread: threads)
+    {
+        thread.join();
+    }
+
+    for(auto const item: integers)
+    {
+        BOOST_CHECK_EQUAL(item, integers[0]);
+    }
+    BOOST_CHECK(*integers[0] == odil::Value::Integers({1234, -5678, 9012}));
+    BOOST_CHECK(value.has_native_integers());
+}
+
+BOOST_AUTO_TEST_CASE(NativeIntegersClear)
+{
+    odil::Value value(
+        odil::BinaryBuffer(4), odil::Value::IntegerFormat::UInt32);
+    BOOST_CHECK_EQUAL(value.size(), 1);
+    value.clear();
+    BOOST_CHECK(value.empty());
+    BOOST_CHECK(!value.has_native_integers());
+}
+
+BOOST_AUTO_TEST_CASE(NativeIntegersInvalid)
+{
+    BOOST_CHECK_THROW(
+        odil::Value(odil::BinaryBuffer(3), odil::Value::IntegerFormat::Int16),
+        odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(IntegerFormat)
+{
+    odil::Value::IntegerFormat format;
+    BOOST_CHECK(odil::Value::get_integer_format(odil::VR::UL, format));
+    BOOST_CHECK(format == odil::Value::IntegerFormat::UInt32);
+    BOOST_CHECK(!odil::Value::get_integer_format(odil::VR::IS, format));
+}
+
+BOOST_AUTO_TEST_CASE(Encoded)
+{
+    std::string const encoded("1.2\\-3.4 ");
+    odil::BinaryBuffer buffer(encoded.size());
+    std::memcpy(buffer.data(), encoded.data(), encoded.size());
+
+    odil::Value value(buffer, odil::VR::DS, odil::ByteOrdering::LittleEndian);
+    BOOST_CHECK(value.get_type() == odil::Value::Type::Reals);
+    BOOST_CHECK(value.is_encoded());
+    BOOST_CHECK(value.get_encoded_data() == buffer);
+    BOOST_CHECK(value.get_encoded_vr() == odil::VR::DS);
+    BOOST_CHECK(
+        value.get_encoded_byte_ordering() == odil::ByteOrdering::LittleEndian);
+
+    // Comparing identical encoded forms does not decode them
+    odil::Value const copy(value);
+    BOOST_CHECK(copy == value);
+    BOOST_CHECK(copy.is_encoded());
+    BOOST_CHECK(value.is_encoded());
+
+    // Const accesses keep the encoded form
+    BOOST_CHECK_EQUAL(copy.size(), 2);
+    BOOST_CHECK(copy.as_reals() == odil::Value::Reals({1.2, -3.4}));
+    BOOST_CHECK(copy.is_encoded());
+    BOOST_CHECK(copy.get_encoded_data() == buffer);
+
+    // Decoding
+    BOOST_CHECK(value.as_reals() == odil::Value::Reals({1.2, -3.4}));
+    BOOST_CHECK(!value.is_encoded());
+    BOOST_CHECK_THROW(value.get_encoded_data(), odil::Exception);
+
+    BOOST_CHECK(copy.is_encoded());
+    BOOST_CHECK(copy == value);
+    BOOST_CHECK_EQUAL(copy.get_hash(), value.get_hash());
+}
+
+BOOST_AUTO_TEST_CASE(EncodedConstDecoding)
+{
+    std::string const encoded("foo\\bar ");
+    odil::BinaryBuffer buffer(encoded.size());
+    std::memcpy(buffer.data(), encoded.data(), encoded.size());
+    odil::Value const value(
+        buffer, odil::VR::CS, odil::ByteOrdering::LittleEndian);
+
+    auto const & data = value.get_encoded_data();
+    auto const & strings = value.as_strings();
+    BOOST_CHECK(value.is_encoded());
+    BOOST_CHECK_EQUAL(&value.as_strings(), &strings);
+    BOOST_CHECK(strings == odil::Value::Strings({"foo", "bar"}));
+    BOOST_CHECK(data == buffer);
+}
+
+BOOST_AUTO_TEST_CASE(EncodedDecodingKeepsReferences)
+{
+    uint8_t const data[] = {0x12, 0x34, 0x56, 0x78};
+    odil::BinaryBuffer buffer(sizeof(data));
+    std::memcpy(buffer.data(), data, sizeof(data));
+    odil::Value value(buffer, odil::VR::UL, odil::ByteOrdering::BigEndian);
+    odil::Value const & const_value = value;
+
+    // Decoding adopts the form decoded by the const accessors
+    auto const & integers = const_value.as_integers();
+    BOOST_CHECK_EQUAL(&value.as_integers(), &integers);
+    BOOST_CHECK(!value.is_encoded());
+    BOOST_CHECK(integers == odil::Value::Integers({0x12345678}));
+}
+
+BOOST_AUTO_TEST_CASE(EncodedIntegers)
+{
+    uint8_t const data[] = {0x12, 0x34, 0x56, 0x78};
+    odil::BinaryBuffer buffer(sizeof(data));
+    std::memcpy(buffer.data(), data, sizeof(data));
+
+    odil::Value const value(
+        buffer, odil::VR::US, odil::ByteOrdering::BigEndian);
+    BOOST_CHECK(value.get_type() == odil::Value::Type::Integers);
+    BOOST_CHECK(value.as_integers() == odil::Value::Integers({0x1234, 0x5678}));
+}
+
+BOOST_AUTO_TEST_CASE(EncodedClear)
+{
+    odil::Value value(
+        odil::BinaryBuffer(4), odil::VR::UL, odil::ByteOrdering::LittleEndian);
+    value.clear();
+    BOOST_CHECK(value.empty());
+    BOOST_CHECK(!value.is_encoded());
+    BOOST_CHECK(value.get_type() == odil::Value::Type::Integers);
+}
+
+BOOST_AUTO_TEST_CASE(EncodedInvalid)
+{
+    BOOST_CHECK_THROW(
+        odil::Value(
+            odil::BinaryBuffer(4), odil::VR::OB,
+            odil::ByteOrdering::LittleEndian),
+        odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(Hash)
+{
+    odil::Value const integers({1, 2, 3});
+    BOOST_CHECK_EQUAL(integers.get_hash(), odil::Value({1, 2, 3}).get_hash());
+    BOOST_CHECK_NE(integers.get_hash(), odil::Value({1, 2, 4}).get_hash());
+    BOOST_CHECK_NE(
+        odil::Value(odil::Value::Integers()).get_hash(),
+        odil::Value(odil::Value::Reals()).get_hash());
+
+    BOOST_CHECK_EQUAL(
+        odil::Value({0.}).get_hash(), odil::Value({-0.}).get_hash());
+
+    // Hashes do not depend on the representation
+    int16_t const items[] = {1, 2, 3};
+    odil::BinaryBuffer buffer(sizeof(items));
+    std::memcpy(buffer.data(), items, sizeof(items));
+    odil::Value const native(buffer, odil::Value::IntegerFormat::Int16);
+    BOOST_CHECK_EQUAL(native.get_hash(), integers.get_hash());
+    BOOST_CHECK(native.has_native_integers());
+
+    odil::Value const fragments({{1, 2, 3}});
+    BOOST_CHECK_EQUAL(
+        odil::Value(odil::BinaryBuffer(fragments.as_binary())).get_hash(),
+        fragments.get_hash());
+
+    odil::DataSet data_set;
+    data_set.add("PatientID", {"DJ1234"});
+    BOOST_CHECK_EQUAL(
+        odil::Value({data_set}).get_hash(), odil::Value({data_set}).get_hash());
+}
+
+BOOST_AUTO_TEST_CASE(HashConcurrent)
+{
+    odil::Value const value({"foo", "bar"});
+    auto const expected = odil::Value(value).get_hash();
+
+    std::vector<uint64_t> hashes(4, 0);
+    std::vector<std::thread> threads;
+    for(std::size_t i=0; i<hashes.size(); ++i)
+    {
+        threads.emplace_back(
+            [&value, &hashes, i]() { hashes[i] = value.get_hash(); });
+    }
+    for(auto & thread: threads)
+    {
+        thread.join();
+    }
+
+    for(auto const hash: hashes)
+    {
+        BOOST_CHECK_EQUAL(hash, expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(HashModified)
+{
+    odil::Value value({"foo"});
+    auto const hash = value.get_hash();
+    BOOST_CHECK_EQUAL(odil::Value(value).get_hash(), hash);
+
+    // Modifications through a reference invalidate the memoized hash
+    auto & strings = value.as_strings();
+    strings[0] = "bar";
+    BOOST_CHECK_NE(value.get_hash(), hash);
+    BOOST_CHECK_EQUAL(value.get_hash(), odil::Value({"bar"}).get_hash());
+    strings[0] = "foo";
+    BOOST_CHECK_EQUAL(value.get_hash(), hash);
+
+    value.clear();
+    BOOST_CHECK_EQUAL(value.get_hash(), odil::Value(odil::Value::Strings()).get_hash());
+}
+
+BOOST_AUTO_TEST_CASE(HashEquality)
+{
+    odil::Value const value1({"foo"});
+    odil::Value const value2({"bar"});
+    value1.get_hash();
+    value2.get_hash();
+    BOOST_CHECK(value1 != value2);
+    BOOST_CHECK(value1 == odil::Value({"foo"}));
+}
+
+BOOST_AUTO_TEST_CASE(Size)
+{
+    // Only the active alternative is stored, next to a pointer to the
+    // derived representations
+    BOOST_CHECK_LE(
+        sizeof(odil::Value), sizeof(odil::Value::Binary)+2*sizeof(void*));
+}
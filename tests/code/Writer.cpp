@@ -1,14 +1,23 @@
 #define BOOST_TEST_MODULE Writer
 #include <boost/test/unit_test.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <set>
 #include <sstream>
+#include <streambuf>
+#include <string>
 
 #include <dcmtk/config/osconfig.h>
 #include <dcmtk/dcmdata/dctk.h>
 #include <dcmtk/dcmdata/dcistrmb.h>
 
+#include "odil/BinaryBuffer.h"
 #include "odil/endian.h"
 #include "odil/Element.h"
+#include "odil/Exception.h"
 #include "odil/registry.h"
 #include "odil/Writer.h"
 #include "odil/VR.h"
@@ -114,6 +123,24 @@ BOOST_AUTO_TEST_CASE(DS)
     do_test(odil_data_set);
 }
 
+BOOST_AUTO_TEST_CASE(DSNonFinite)
+{
+    for(auto const value: {
+        std::numeric_limits<double>::quiet_NaN(),
+        std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity()})
+    {
+        odil::DataSet odil_data_set;
+        odil_data_set.add(
+            odil::registry::SelectorDSValue, {1.5, value}, odil::VR::DS);
+
+        std::ostringstream stream;
+        odil::Writer const writer(stream, odil::registry::ExplicitVRLittleEndian);
+        BOOST_REQUIRE_THROW(
+            writer.write_data_set(odil_data_set), odil::Exception);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(FD)
 {
     odil::Element odil_element({1.23, -4.56}, odil::VR::FD);
@@ -174,6 +201,61 @@ BOOST_AUTO_TEST_CASE(OW)
     do_test(odil_data_set);
 }
 
+void do_binary_test(
+    odil::VR vr, odil::ByteOrdering byte_ordering, std::string const & expected)
+{
+    std::ostringstream stream;
+    odil::Writer const writer(stream, byte_ordering, true);
+    odil::Element const element(
+        odil::Value::Binary({{
+            0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+            0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+            0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18}}),
+        vr);
+    writer.write_element(element);
+
+    // Skip VR and VL
+    auto const data = stream.str();
+    BOOST_REQUIRE_EQUAL(data.size(), 8+expected.size());
+    BOOST_REQUIRE(data.substr(8) == expected);
+}
+
+BOOST_AUTO_TEST_CASE(OL)
+{
+    std::string const data(
+        "\x01\x02\x03\x04\x05\x06\x07\x08"
+        "\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10"
+        "\x11\x12\x13\x14\x15\x16\x17\x18", 24);
+    std::string const swapped(
+        "\x04\x03\x02\x01\x08\x07\x06\x05"
+        "\x0c\x0b\x0a\x09\x10\x0f\x0e\x0d"
+        "\x14\x13\x12\x11\x18\x17\x16\x15", 24);
+
+    odil::ByteOrdering const other_byte_ordering =
+        (odil::host_byte_ordering == odil::ByteOrdering::LittleEndian)
+        ?odil::ByteOrdering::BigEndian:odil::ByteOrdering::LittleEndian;
+    do_binary_test(odil::VR::OL, odil::host_byte_ordering, data);
+    do_binary_test(odil::VR::OL, other_byte_ordering, swapped);
+}
+
+BOOST_AUTO_TEST_CASE(OD)
+{
+    std::string const data(
+        "\x01\x02\x03\x04\x05\x06\x07\x08"
+        "\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10"
+        "\x11\x12\x13\x14\x15\x16\x17\x18", 24);
+    std::string const swapped(
+        "\x08\x07\x06\x05\x04\x03\x02\x01"
+        "\x10\x0f\x0e\x0d\x0c\x0b\x0a\x09"
+        "\x18\x17\x16\x15\x14\x13\x12\x11", 24);
+
+    odil::ByteOrdering const other_byte_ordering =
+        (odil::host_byte_ordering == odil::ByteOrdering::LittleEndian)
+        ?odil::ByteOrdering::BigEndian:odil::ByteOrdering::LittleEndian;
+    do_binary_test(odil::VR::OD, odil::host_byte_ordering, data);
+    do_binary_test(odil::VR::OD, other_byte_ordering, swapped);
+}
+
 BOOST_AUTO_TEST_CASE(SL)
 {
     odil::Element odil_element({12345678, -8765432}, odil::VR::SL);
@@ -335,3 +417,321 @@ BOOST_AUTO_TEST_CASE(File)
 
     do_file_test(odil_data_set);
 }
+
+BOOST_AUTO_TEST_CASE(BinaryBuffer)
+{
+    odil::Value::Binary const lut{{0x01, 0x02, 0x03, 0x04}};
+    odil::Value::Binary const pixel_data{{0x01, 0x02}, {0x03, 0x04, 0x05, 0x06}};
+
+    odil::DataSet fragments_data_set;
+    fragments_data_set.add(
+        odil::registry::RedPaletteColorLookupTableData, lut, odil::VR::OW);
+    fragments_data_set.add(odil::registry::PixelData, pixel_data, odil::VR::OB);
+
+    odil::DataSet buffer_data_set;
+    buffer_data_set.add(
+        odil::registry::RedPaletteColorLookupTableData,
+        odil::Element(odil::Value(odil::BinaryBuffer(lut)), odil::VR::OW));
+    buffer_data_set.add(
+        odil::registry::PixelData,
+        odil::Element(odil::Value(odil::BinaryBuffer(pixel_data)), odil::VR::OB));
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired})
+    {
+        std::ostringstream fragments_stream;
+        odil::Writer(fragments_stream, transfer_syntax).write_data_set(
+            fragments_data_set);
+
+        std::ostringstream buffer_stream;
+        odil::Writer(buffer_stream, transfer_syntax).write_data_set(
+            buffer_data_set);
+
+        BOOST_REQUIRE_EQUAL(buffer_stream.str(), fragments_stream.str());
+    }
+
+    // Writing does not convert the values
+    BOOST_REQUIRE(
+        buffer_data_set[odil::registry::PixelData].get_value().has_binary_buffer());
+}
+
+BOOST_AUTO_TEST_CASE(NativeIntegers)
+{
+    uint16_t const items[] = {1234, 5678};
+    odil::BinaryBuffer buffer(sizeof(items));
+    std::memcpy(buffer.data(), items, sizeof(items));
+
+    odil::DataSet native_data_set;
+    native_data_set.add(
+        odil::registry::SelectorUSValue,
+        odil::Element(
+            odil::Value(buffer, odil::Value::IntegerFormat::UInt16),
+            odil::VR::US));
+
+    odil::DataSet wide_data_set;
+    wide_data_set.add(
+        odil::registry::SelectorUSValue, {1234, 5678}, odil::VR::US);
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired})
+    {
+        std::ostringstream native_stream;
+        odil::Writer(native_stream, transfer_syntax).write_data_set(
+            native_data_set);
+
+        std::ostringstream wide_stream;
+        odil::Writer(wide_stream, transfer_syntax).write_data_set(
+            wide_data_set);
+
+        BOOST_REQUIRE_EQUAL(native_stream.str(), wide_stream.str());
+    }
+
+    // Writing does not widen the values
+    BOOST_REQUIRE(
+        native_data_set[odil::registry::SelectorUSValue].get_value()
+            .has_native_integers());
+}
+
+BOOST_AUTO_TEST_CASE(EncodedSize)
+{
+    odil::DataSet item;
+    item.add(odil::registry::Modality, {"CT"});
+    item.add(odil::registry::SliceThickness, {1.25});
+
+    odil::DataSet data_set;
+    data_set.add(odil::registry::CommandDataSetType, {0x0101});
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::StudyID, {"1"});
+    data_set.add(odil::registry::InstanceNumber, {-123});
+    data_set.add(odil::registry::PixelSpacing, {0.5, 1e-7});
+    data_set.add(odil::registry::FrameIncrementPointer, {"00181063"});
+    data_set.add(odil::registry::ContentSequence, {item, odil::DataSet()});
+    data_set.add(
+        odil::registry::PixelData, {{0x01, 0x02, 0x03}, {0x04}}, odil::VR::OB);
+    data_set.add(
+        odil::registry::LargestImagePixelValue,
+        odil::Element(
+            odil::Value(
+                odil::BinaryBuffer(2), odil::Value::IntegerFormat::UInt16),
+            odil::VR::US));
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ImplicitVRLittleEndian,
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired})
+    {
+        for(auto const item_encoding: {
+            odil::Writer::ItemEncoding::ExplicitLength,
+            odil::Writer::ItemEncoding::UndefinedLength})
+        {
+            for(auto const use_group_length: {false, true})
+            {
+                std::ostringstream stream;
+                odil::Writer const writer(
+                    stream, transfer_syntax, item_encoding, use_group_length);
+                writer.write_data_set(data_set);
+
+                BOOST_REQUIRE_EQUAL(
+                    odil::Writer::encoded_size(
+                        data_set, transfer_syntax, item_encoding,
+                        use_group_length),
+                    stream.str().size());
+                BOOST_REQUIRE_EQUAL(
+                    writer.get_encoded_size(data_set), stream.str().size());
+
+                std::ostringstream other_stream;
+                odil::Writer const other_writer(
+                    other_stream, transfer_syntax, item_encoding,
+                    use_group_length);
+                auto const lengths = other_writer.get_lengths(data_set);
+                BOOST_REQUIRE_EQUAL(lengths.size, stream.str().size());
+                other_writer.write_data_set(data_set, lengths);
+                BOOST_REQUIRE(other_stream.str() == stream.str());
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Segments)
+{
+    odil::BinaryBuffer pixel_data(10000);
+    std::memset(pixel_data.data(), 0x42, pixel_data.size());
+
+    odil::DataSet item;
+    item.add(odil::registry::PixelData, odil::Element(pixel_data, odil::VR::OB));
+
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::IconImageSequence, {item});
+    data_set.add(
+        odil::registry::PixelData, odil::Element(pixel_data, odil::VR::OW));
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired})
+    {
+        std::ostringstream stream;
+        odil::Writer(stream, transfer_syntax).write_data_set(data_set);
+
+        odil::SegmentList segments;
+        odil::Writer(segments, transfer_syntax).write_data_set(data_set);
+
+        auto const & const_data_set = data_set;
+        auto const & const_item =
+            const_data_set.as_data_set(odil::registry::IconImageSequence, 0);
+        std::set<uint8_t const *> const pixel_data_addresses{
+            const_data_set.as_binary_buffer(odil::registry::PixelData).data(),
+            const_item.as_binary_buffer(odil::registry::PixelData).data()};
+
+        std::string data;
+        std::size_t references = 0;
+        for(auto const & segment: segments.get_segments())
+        {
+            data.append(
+                reinterpret_cast<char const *>(segment.data), segment.size);
+            references += pixel_data_addresses.count(segment.data);
+        }
+        BOOST_REQUIRE(data == stream.str());
+
+        // Swapped OW pixel data cannot be referenced
+        BOOST_REQUIRE_EQUAL(
+            references,
+            (transfer_syntax == odil::registry::ExplicitVRLittleEndian)?2:1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SegmentsOwnership)
+{
+    odil::SegmentList segments;
+    std::string expected;
+    {
+        odil::BinaryBuffer pixel_data(10000);
+        std::memset(pixel_data.data(), 0x42, pixel_data.size());
+
+        odil::DataSet data_set;
+        data_set.add(
+            odil::registry::PixelData, odil::Element(pixel_data, odil::VR::OB));
+
+        std::ostringstream stream;
+        odil::Writer(stream, odil::registry::ExplicitVRLittleEndian)
+            .write_data_set(data_set);
+        expected = stream.str();
+
+        odil::Writer(segments, odil::registry::ExplicitVRLittleEndian)
+            .write_data_set(data_set);
+
+        // Converting or modifying the values does not alter the segments
+        auto const & const_data_set = data_set;
+        const_data_set.as_binary(odil::registry::PixelData);
+        data_set.as_binary(odil::registry::PixelData)[0][0] = 0x00;
+        std::memset(pixel_data.data(), 0x00, pixel_data.size());
+    }
+
+    // The segments keep the referenced data alive
+    std::string data;
+    for(auto const & segment: segments.get_segments())
+    {
+        data.append(reinterpret_cast<char const *>(segment.data), segment.size);
+    }
+    BOOST_REQUIRE(data == expected);
+}
+
+/// @brief Non-seekable stream buffer appending to a string.
+class SinkBuffer: public std::streambuf
+{
+public:
+    std::string data;
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if(c != traits_type::eof())
+        {
+            this->data.push_back(traits_type::to_char_type(c));
+        }
+        return c;
+    }
+
+    std::streamsize xsputn(char const * s, std::streamsize n) override
+    {
+        this->data.append(s, n);
+        return n;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(NestedLengths)
+{
+    odil::DataSet item;
+    item.add(odil::registry::Modality, {"CT"});
+
+    odil::DataSet data_set;
+    data_set.add(odil::registry::ContentSequence, {item});
+
+    // Lengths are computed before writing: the stream is never sought.
+    SinkBuffer buffer;
+    std::ostream stream(&buffer);
+    odil::Writer const writer(
+        stream, odil::registry::ExplicitVRLittleEndian,
+        odil::Writer::ItemEncoding::ExplicitLength, true);
+    writer.write_data_set(data_set);
+
+    std::string const expected(
+        "\x40\x00\x00\x00" "UL" "\x04\x00" "\x2a\x00\x00\x00"
+        "\x40\x00\x30\xa7" "SQ" "\x00\x00" "\x1e\x00\x00\x00"
+            "\xfe\xff\x00\xe0" "\x16\x00\x00\x00"
+                "\x08\x00\x00\x00" "UL" "\x04\x00" "\x0a\x00\x00\x00"
+                "\x08\x00\x60\x00" "CS" "\x02\x00" "CT",
+        54);
+    BOOST_REQUIRE(buffer.data == expected);
+}
+
+BOOST_AUTO_TEST_CASE(Encoded)
+{
+    // Values encoded in big endian, re-encoded in both byte orderings
+    uint8_t const us[] = {0x12, 0x34, 0x56, 0x78};
+    odil::BinaryBuffer us_buffer(sizeof(us));
+    std::memcpy(us_buffer.data(), us, sizeof(us));
+
+    std::string const cs("CT");
+    odil::BinaryBuffer cs_buffer(cs.size());
+    std::memcpy(cs_buffer.data(), cs.data(), cs.size());
+
+    odil::DataSet encoded_data_set;
+    encoded_data_set.add(
+        odil::registry::Modality,
+        odil::Element(
+            odil::Value(cs_buffer, odil::VR::CS, odil::ByteOrdering::BigEndian),
+            odil::VR::CS));
+    encoded_data_set.add(
+        odil::registry::SelectorUSValue,
+        odil::Element(
+            odil::Value(us_buffer, odil::VR::US, odil::ByteOrdering::BigEndian),
+            odil::VR::US));
+
+    odil::DataSet decoded_data_set;
+    decoded_data_set.add(odil::registry::Modality, {"CT"});
+    decoded_data_set.add(
+        odil::registry::SelectorUSValue, {0x1234, 0x5678}, odil::VR::US);
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ExplicitVRBigEndian_Retired})
+    {
+        std::ostringstream encoded_stream;
+        odil::Writer(encoded_stream, transfer_syntax).write_data_set(
+            encoded_data_set);
+
+        std::ostringstream decoded_stream;
+        odil::Writer(decoded_stream, transfer_syntax).write_data_set(
+            decoded_data_set);
+
+        BOOST_REQUIRE_EQUAL(encoded_stream.str(), decoded_stream.str());
+    }
+
+    // Writing does not decode the values
+    BOOST_REQUIRE(
+        encoded_data_set[odil::registry::SelectorUSValue].get_value()
+            .is_encoded());
+}
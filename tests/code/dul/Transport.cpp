@@ -2,9 +2,14 @@
 #include <boost/test/unit_test.hpp>
 
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
 #include <boost/asio.hpp>
 
 #include "odil/Exception.h"
+#include "odil/SegmentList.h"
 #include "odil/dul/Transport.h"
 
 BOOST_AUTO_TEST_CASE(Constructor)
@@ -35,10 +40,49 @@ BOOST_AUTO_TEST_CASE(Connect)
     BOOST_REQUIRE(!transport.is_open());
 }
 
+BOOST_AUTO_TEST_CASE(WriteSegments)
+{
+    // Local peer, receiving until the connection is closed
+    boost::asio::io_service service;
+    boost::asio::ip::tcp::acceptor acceptor(
+        service, boost::asio::ip::tcp::endpoint(
+            boost::asio::ip::address_v4::loopback(), 0));
+    std::string received;
+    std::thread peer([&]() {
+        boost::asio::ip::tcp::socket socket(service);
+        acceptor.accept(socket);
+        boost::asio::streambuf buffer;
+        boost::system::error_code error;
+        boost::asio::read(socket, buffer, error);
+        received.assign(
+            boost::asio::buffers_begin(buffer.data()),
+            boost::asio::buffers_end(buffer.data()));
+    });
+
+    std::shared_ptr<uint8_t const> const reference(
+        new uint8_t[3]{'b', 'a', 'r'}, std::default_delete<uint8_t[]>());
+
+    odil::SegmentList segments(2);
+    segments.get_stream() << "foo";
+    segments.append_reference(reference, 3);
+    segments.get_stream() << "baz";
+    BOOST_REQUIRE_EQUAL(segments.get_segments().size(), 3);
+
+    odil::dul::Transport transport;
+    transport.connect(acceptor.local_endpoint());
+    transport.write(segments);
+    transport.close();
+
+    peer.join();
+    BOOST_REQUIRE_EQUAL(received, "foobarbaz");
+}
+
 BOOST_AUTO_TEST_CASE(NotConnected)
 {
     odil::dul::Transport transport;
 
     BOOST_REQUIRE_THROW(transport.write("..."), odil::Exception);
+    BOOST_REQUIRE_THROW(
+        transport.write(odil::SegmentList()), odil::Exception);
     BOOST_REQUIRE_THROW(transport.read(1), odil::Exception);
 }
@@ -1,8 +1,13 @@
 #define BOOST_TEST_MODULE endian
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <string>
+
 #include "odil/endian.h"
+#include "odil/Exception.h"
 
 BOOST_AUTO_TEST_CASE(ToLittleEndian16)
 {
@@ -87,3 +92,45 @@ BOOST_AUTO_TEST_CASE(FromBigEndian32)
         expected
     );
 }
+
+void check_swap_bytes(std::size_t item_size)
+{
+    // Not a multiple of the SIMD block size, to exercise the tail
+    std::string input(item_size*19, '\0');
+    for(std::size_t i=0; i<input.size(); ++i)
+    {
+        input[i] = char(i);
+    }
+    std::string expected(input.size(), '\0');
+    for(std::size_t i=0; i<input.size(); i+=item_size)
+    {
+        std::reverse_copy(
+            input.begin()+i, input.begin()+i+item_size, expected.begin()+i);
+    }
+
+    std::string output(input.size(), '\0');
+    odil::swap_bytes(&input[0], &output[0], input.size(), item_size);
+    BOOST_REQUIRE(output == expected);
+
+    odil::swap_bytes(&input[0], &input[0], input.size(), item_size);
+    BOOST_REQUIRE(input == expected);
+}
+
+BOOST_AUTO_TEST_CASE(SwapBytes)
+{
+    check_swap_bytes(1);
+    check_swap_bytes(2);
+    check_swap_bytes(4);
+    check_swap_bytes(8);
+}
+
+BOOST_AUTO_TEST_CASE(SwapBytesWrongSize)
+{
+    std::string data(6, '\0');
+    BOOST_REQUIRE_THROW(
+        odil::swap_bytes(&data[0], &data[0], data.size(), 4),
+        odil::Exception);
+    BOOST_REQUIRE_THROW(
+        odil::swap_bytes(&data[0], &data[0], data.size(), 3),
+        odil::Exception);
+}
@@ -0,0 +1,26 @@
+#define BOOST_TEST_MODULE hash
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <string>
+
+#include "odil/hash.h"
+
+BOOST_AUTO_TEST_CASE(Bytes)
+{
+    std::string const data("foobar");
+    // Reference value of FNV-1a
+    BOOST_CHECK_EQUAL(
+        odil::hash_bytes(data.data(), data.size()), 0x85944171f73967e8ULL);
+    BOOST_CHECK_EQUAL(odil::hash_bytes(nullptr, 0), odil::hash_seed);
+}
+
+BOOST_AUTO_TEST_CASE(Combine)
+{
+    auto const a = odil::hash_combine(odil::hash_seed, 1);
+    auto const b = odil::hash_combine(odil::hash_seed, 2);
+    BOOST_CHECK_NE(a, b);
+
+    // Order matters
+    BOOST_CHECK_NE(odil::hash_combine(a, 2), odil::hash_combine(b, 1));
+}
@@ -50,6 +50,18 @@ BOOST_AUTO_TEST_CASE(ConstructorPDV)
     BOOST_REQUIRE(pdu.get_pdv_items() == pdv_items);
 }
 
+BOOST_AUTO_TEST_CASE(ConstructorPDVOffset)
+{
+    std::string const buffer = "\x01\x02\x03\x04\x05\x06\x07\x08";
+    odil::pdu::PDataTF::PresentationDataValueItem const item(
+        1, 0x00, buffer, 3, 4);
+    BOOST_REQUIRE(item.get_fragment() == "\x04\x05\x06\x07");
+
+    odil::pdu::PDataTF::PresentationDataValueItem const last(
+        1, 0x02, buffer, 6, 4);
+    BOOST_REQUIRE(last.get_fragment() == "\x07\x08");
+}
+
 BOOST_AUTO_TEST_CASE(ConstructorStream)
 {
     std::istringstream stream(data);
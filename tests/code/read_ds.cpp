@@ -0,0 +1,111 @@
+#define BOOST_TEST_MODULE read_ds
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "odil/Exception.h"
+#include "odil/read_ds.h"
+#include "odil/Value.h"
+
+odil::Value::Reals parse_ds(std::string const & string)
+{
+    odil::Value::Reals values;
+    odil::read_ds(string.data(), string.data()+string.size(), values);
+    return values;
+}
+
+odil::Value::Integers parse_is(std::string const & string)
+{
+    odil::Value::Integers values;
+    odil::read_is(string.data(), string.data()+string.size(), values);
+    return values;
+}
+
+BOOST_AUTO_TEST_CASE(DSSingle)
+{
+    BOOST_REQUIRE(parse_ds("1.5") == odil::Value::Reals({1.5}));
+}
+
+BOOST_AUTO_TEST_CASE(DSMultiple)
+{
+    BOOST_REQUIRE(
+        parse_ds("1.5\\-2\\+0.25\\.5\\3.") ==
+        odil::Value::Reals({1.5, -2, 0.25, 0.5, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(DSPadding)
+{
+    BOOST_REQUIRE(
+        parse_ds(" 1.5 \\ -2 ") == odil::Value::Reals({1.5, -2}));
+    BOOST_REQUIRE(parse_ds(std::string("1.5\0", 4)) == odil::Value::Reals({1.5}));
+}
+
+BOOST_AUTO_TEST_CASE(DSExponent)
+{
+    BOOST_REQUIRE(
+        parse_ds("1.5e3\\-2E-2\\1e+300\\1e-300") ==
+        odil::Value::Reals({1500, -0.02, 1e300, 1e-300}));
+}
+
+BOOST_AUTO_TEST_CASE(DSLongMantissa)
+{
+    BOOST_REQUIRE(
+        parse_ds("1234567890123456\\0.1234567890123456") ==
+        odil::Value::Reals({1234567890123456., 0.1234567890123456}));
+}
+
+BOOST_AUTO_TEST_CASE(DSInvalid)
+{
+    BOOST_REQUIRE_THROW(parse_ds("foo"), odil::Exception);
+    BOOST_REQUIRE_THROW(parse_ds("1.5\\"), odil::Exception);
+    BOOST_REQUIRE_THROW(parse_ds("1.5x"), odil::Exception);
+    BOOST_REQUIRE_THROW(parse_ds("1 5"), odil::Exception);
+    BOOST_REQUIRE_THROW(parse_ds("1e"), odil::Exception);
+    BOOST_REQUIRE_THROW(parse_ds("-"), odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(DSRoundTrip)
+{
+    // Compare to the C library for random values of various precisions
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> mantissa(-10, 10);
+    std::uniform_int_distribution<int> exponent(-30, 30);
+    char buffer[64];
+    for(int i=0; i<10000; ++i)
+    {
+        double const value = mantissa(generator)*std::pow(10, exponent(generator));
+        std::snprintf(buffer, sizeof(buffer), "%.*g", 1+i%17, value);
+        BOOST_REQUIRE_EQUAL(parse_ds(buffer)[0], std::strtod(buffer, nullptr));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ISMultiple)
+{
+    BOOST_REQUIRE(
+        parse_is(" 12\\-34 \\+56") == odil::Value::Integers({12, -34, 56}));
+}
+
+BOOST_AUTO_TEST_CASE(ISLimits)
+{
+    BOOST_REQUIRE(
+        parse_is("9223372036854775807\\-9223372036854775808") ==
+        odil::Value::Integers({
+            std::numeric_limits<int64_t>::max(),
+            std::numeric_limits<int64_t>::min()}));
+    BOOST_REQUIRE_THROW(parse_is("9223372036854775808"), odil::Exception);
+    BOOST_REQUIRE_THROW(parse_is("-9223372036854775809"), odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(ISInvalid)
+{
+    BOOST_REQUIRE_THROW(parse_is("1.5"), odil::Exception);
+    BOOST_REQUIRE_THROW(parse_is("12\\"), odil::Exception);
+    BOOST_REQUIRE_THROW(parse_is("-"), odil::Exception);
+    BOOST_REQUIRE_THROW(parse_is("1 2"), odil::Exception);
+}
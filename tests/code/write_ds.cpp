@@ -0,0 +1,234 @@
+#define BOOST_TEST_MODULE write_ds
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "odil/Exception.h"
+#include "odil/read_ds.h"
+#include "odil/Value.h"
+#include "odil/write_ds.h"
+
+std::string format_ds(double value)
+{
+    char buffer[16+1];
+    odil::write_ds(value, buffer);
+    return buffer;
+}
+
+std::string format_is(odil::Value::Integer value)
+{
+    char buffer[21];
+    odil::write_is(value, buffer);
+    return buffer;
+}
+
+double parse_ds(std::string const & string)
+{
+    odil::Value::Reals values;
+    odil::read_ds(string.data(), string.data()+string.size(), values);
+    return values.at(0);
+}
+
+BOOST_AUTO_TEST_CASE(DSShortest)
+{
+    BOOST_REQUIRE_EQUAL(format_ds(0), "0");
+    BOOST_REQUIRE_EQUAL(format_ds(-0.), "-0");
+    BOOST_REQUIRE_EQUAL(format_ds(1), "1");
+    BOOST_REQUIRE_EQUAL(format_ds(100), "100");
+    BOOST_REQUIRE_EQUAL(format_ds(1.5), "1.5");
+    BOOST_REQUIRE_EQUAL(format_ds(-4.56), "-4.56");
+    BOOST_REQUIRE_EQUAL(format_ds(0.1), ".1");
+    BOOST_REQUIRE_EQUAL(format_ds(0.1+0.2), ".3");
+    BOOST_REQUIRE_EQUAL(format_ds(0.001), ".001");
+    BOOST_REQUIRE_EQUAL(format_ds(24.5282145946261), "24.5282145946261");
+    BOOST_REQUIRE_EQUAL(format_ds(1e15), "1000000000000000");
+}
+
+BOOST_AUTO_TEST_CASE(DSExponent)
+{
+    BOOST_REQUIRE_EQUAL(format_ds(0.0001), "1e-4");
+    BOOST_REQUIRE_EQUAL(format_ds(-2.5e-5), "-2.5e-5");
+    BOOST_REQUIRE_EQUAL(format_ds(1e16), "1e16");
+    BOOST_REQUIRE_EQUAL(format_ds(1e20), "1e20");
+    BOOST_REQUIRE_EQUAL(format_ds(1e-300), "1e-300");
+    BOOST_REQUIRE_EQUAL(
+        format_ds(std::numeric_limits<double>::denorm_min()), "5e-324");
+}
+
+BOOST_AUTO_TEST_CASE(DSRounded)
+{
+    BOOST_REQUIRE_EQUAL(format_ds(0.12345678901234568), ".123456789012346");
+    BOOST_REQUIRE_EQUAL(format_ds(-0.12345678901234568), "-.12345678901235");
+    BOOST_REQUIRE_EQUAL(format_ds(123456789.12345679), "123456789.123457");
+    BOOST_REQUIRE_EQUAL(format_ds(1.2345678901234568e18), "1.23456789012e18");
+    BOOST_REQUIRE_EQUAL(format_ds(999999999999999.9), "1000000000000000");
+    BOOST_REQUIRE_EQUAL(
+        format_ds(std::numeric_limits<double>::max()), "1.7976931349e308");
+    // The shortest digits end with 5, but the value is below the midpoint
+    BOOST_REQUIRE_EQUAL(format_ds(506688.16120903048), "506688.16120903");
+}
+
+BOOST_AUTO_TEST_CASE(DSSize)
+{
+    BOOST_REQUIRE_EQUAL(format_ds(1e15), "1000000000000000");
+    char buffer[8+1];
+    odil::write_ds(1e15, buffer, 8);
+    BOOST_REQUIRE_EQUAL(buffer, "1e15");
+    odil::write_ds(3.14159265, buffer, 8);
+    BOOST_REQUIRE_EQUAL(buffer, "3.141593");
+}
+
+BOOST_AUTO_TEST_CASE(DSNonFinite)
+{
+    char buffer[16+1];
+    for(auto const value: {
+        std::numeric_limits<double>::quiet_NaN(),
+        std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity()})
+    {
+        BOOST_REQUIRE_THROW(odil::write_ds(value, buffer), odil::Exception);
+    }
+}
+
+/**
+ * @brief Value, formatted value and, when it differs, output of the previous
+ * sprintf-based formatter.
+ */
+struct Formatted
+{
+    double value;
+    char const * ds;
+    char const * previous_ds;
+};
+
+BOOST_AUTO_TEST_CASE(DSPreviousFormatter)
+{
+    Formatted const corpus[] = {
+        {0, "0", ""},
+        {-0., "-0", ""},
+        {1, "1", ""},
+        {-1, "-1", ""},
+        {0.5, ".5", ""},
+        {0.1, ".1", ""},
+        {0.1+0.2, ".3", ""},
+        {1./3., ".333333333333333", ""},
+        {2./3., ".666666666666667", ".666666666666666"},
+        {-1./3., "-.33333333333333", ""},
+        {3.1415926535897931, "3.14159265358979", ""},
+        {2.7182818284590451, "2.71828182845905", ""},
+        {1.4142135623730951, "1.4142135623731", ""},
+        {0.0001, "1e-4", ""},
+        {0.00012345, "1.2345e-4", ""},
+        {1e-10, "1e-10", ""},
+        {1e15, "1000000000000000", ""},
+        {1e16, "1e16", ""},
+        {1e100, "1e100", ""},
+        {1e-100, "1e-100", ""},
+        {123.456, "123.456", ""},
+        {-123.456, "-123.456", ""},
+        {0.625, ".625", ""},
+        {1.7976931348623157e308, "1.7976931349e308", ""},
+        {2.2250738585072014e-308, "2.225073859e-308", ""},
+        {4.9406564584124654e-324, "5e-324", "4.940656458e-324"},
+        {999999999999999.88, "1000000000000000", "1e15"},
+        {9999999999999998, "9999999999999998", ""},
+        {0.99999999999999989, "1", ".999999999999999"},
+        {506688.16120903048, "506688.16120903", ""},
+        {0.12345678901234568, ".123456789012346", ".123456789012345"},
+        {123456789.12345679, "123456789.123457", ""},
+        {1.2345678901234568e18, "1.23456789012e18", ""},
+        {1.0000000000000002, "1", ""},
+        {99.999999999999986, "100", ""},
+        {1.0049999999999999, "1.005", ""},
+        {2.6749999999999998, "2.675", ""},
+        {-0.0005, "-5e-4", ""},
+        {0.00055, "5.5e-4", ""},
+        {27025.1964, "27025.1964", ""},
+        {-18866.0438, "-18866.0438", ""},
+        {8238.966, "8238.966", ""},
+        {7.2112706729580454e19, "7.21127067296e19", ""},
+        {908103626213.87158, "908103626213.872", ""},
+        {1.0097082860448966e-10, "1.009708286e-10", ""},
+        {0.022330344855677503, ".022330344855678", ".022330344855677"},
+        {1.1593397714467904e-06, "1.15933977145e-6", ""},
+        {0.00085232069820677446, "8.52320698207e-4", ""},
+        {342680814619177.62, "342680814619178", ""},
+        {3.1973218613667325e-21, "3.1973218614e-21", ""},
+    };
+
+    for(auto const & item: corpus)
+    {
+        BOOST_REQUIRE_EQUAL(format_ds(item.value), item.ds);
+        if(std::strlen(item.previous_ds) != 0)
+        {
+            // Differences with the previous formatter never lose precision
+            BOOST_REQUIRE_NE(
+                std::string(item.ds), std::string(item.previous_ds));
+            BOOST_REQUIRE_LE(
+                std::fabs(parse_ds(item.ds)-item.value),
+                std::fabs(parse_ds(item.previous_ds)-item.value));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(DSRandom)
+{
+    std::mt19937_64 generator(0);
+    for(int i=0; i<100000; ++i)
+    {
+        double value;
+        if(i%2 == 0)
+        {
+            // Any finite double
+            uint64_t bits;
+            do
+            {
+                bits = generator();
+                std::memcpy(&value, &bits, sizeof(value));
+            }
+            while(!std::isfinite(value));
+        }
+        else
+        {
+            // Decimal numbers of usual magnitudes
+            value = double(int64_t(generator()%2000000001)-1000000000)/1e4;
+        }
+
+        auto const string = format_ds(value);
+        BOOST_REQUIRE_LE(string.size(), 16);
+        BOOST_REQUIRE_EQUAL(
+            string.find_first_not_of("0123456789+-eE."), std::string::npos);
+
+        auto const parsed = parse_ds(string);
+        if(i%2 == 1)
+        {
+            // The shortest representation fits: the item is read back exactly
+            BOOST_REQUIRE_EQUAL(parsed, value);
+        }
+        else
+        {
+            // Items which do not fit are rounded to at least 9 significant
+            // digits
+            BOOST_REQUIRE_LE(std::fabs(parsed-value), 1e-8*std::fabs(value));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(IS)
+{
+    BOOST_REQUIRE_EQUAL(format_is(0), "0");
+    BOOST_REQUIRE_EQUAL(format_is(7), "7");
+    BOOST_REQUIRE_EQUAL(format_is(-10), "-10");
+    BOOST_REQUIRE_EQUAL(format_is(1234567890), "1234567890");
+    BOOST_REQUIRE_EQUAL(
+        format_is(std::numeric_limits<odil::Value::Integer>::max()),
+        "9223372036854775807");
+    BOOST_REQUIRE_EQUAL(
+        format_is(std::numeric_limits<odil::Value::Integer>::min()),
+        "-9223372036854775808");
+}
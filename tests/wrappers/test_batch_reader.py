@@ -0,0 +1,55 @@
+import os
+import tempfile
+import unittest
+
+import odil
+
+class TestBatchReader(unittest.TestCase):
+    def setUp(self):
+        self.data_sets = []
+        self.paths = []
+        for index in range(4):
+            data_set = odil.DataSet()
+            data_set.add("SOPClassUID", [odil.registry.RawDataStorage])
+            data_set.add("SOPInstanceUID", ["1.2.3.{}".format(index)])
+            self.data_sets.append(data_set)
+
+            fd, path = tempfile.mkstemp()
+            os.close(fd)
+            odil.write(data_set, path)
+            self.paths.append(path)
+
+    def tearDown(self):
+        for path in self.paths:
+            os.remove(path)
+
+    def test_ordered(self):
+        reader = odil.BatchReader(2, True)
+        reader.start(self.paths)
+        results = list(reader)
+        self.assertEqual(len(results), len(self.paths))
+        for (path, header, data_set), expected_path, expected_data_set in zip(
+                results, self.paths, self.data_sets):
+            self.assertEqual(path, expected_path)
+            self.assertSequenceEqual(
+                header.as_string("TransferSyntaxUID"),
+                [odil.registry.ExplicitVRLittleEndian])
+            self.assertEqual(data_set, expected_data_set)
+
+    def test_unordered(self):
+        reader = odil.BatchReader(threads_count=2)
+        reader.start(self.paths)
+        results = {path: data_set for path, _, data_set in reader}
+        self.assertEqual(
+            results, dict(zip(self.paths, self.data_sets)))
+
+    def test_error(self):
+        with open(self.paths[0], "wb") as fd:
+            fd.write(b"foo")
+        reader = odil.BatchReader(ordered=True)
+        reader.start(self.paths)
+        with self.assertRaises(odil.Exception):
+            next(reader)
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,44 @@
+import os
+import tempfile
+import unittest
+
+import odil
+
+class TestRead(unittest.TestCase):
+    def setUp(self):
+        fd, self.path = tempfile.mkstemp()
+        os.close(fd)
+
+    def tearDown(self):
+        os.remove(self.path)
+
+    def test_read(self):
+        data_set = odil.DataSet()
+        data_set.add("SOPClassUID", [odil.registry.RawDataStorage])
+        data_set.add("SOPInstanceUID", ["1.2.3.4"])
+        data_set.add("PatientName", ["Foo^Bar"])
+        odil.write(data_set, self.path)
+
+        header, other_data_set = odil.read(self.path)
+        self.assertSequenceEqual(
+            header.as_string("TransferSyntaxUID"),
+            [odil.registry.ExplicitVRLittleEndian])
+        self.assertEqual(other_data_set, data_set)
+
+    def test_read_write_in_place(self):
+        data_set = odil.DataSet()
+        data_set.add("SOPClassUID", [odil.registry.RawDataStorage])
+        data_set.add("SOPInstanceUID", ["1.2.3.4"])
+        data_set.add("PixelData", [bytearray([1, 2, 3, 4])], odil.VR.OW)
+        odil.write(data_set, self.path)
+
+        _, other_data_set = odil.read(self.path)
+        other_data_set.add("PatientName", ["Foo^Bar"])
+        odil.write(other_data_set, self.path)
+
+        data_set.add("PatientName", ["Foo^Bar"])
+        self.assertEqual(other_data_set, data_set)
+        self.assertEqual(odil.read(self.path)[1], data_set)
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,58 @@
+import os
+import sys
+import tempfile
+import unittest
+
+import odil
+
+sys.path.append(
+    os.path.join(
+        os.path.dirname(os.path.dirname(os.path.dirname(
+            os.path.abspath(__file__)))),
+        "applications"))
+import transcode
+
+class TestTranscode(unittest.TestCase):
+    def setUp(self):
+        fd, self.path = tempfile.mkstemp()
+        os.close(fd)
+
+        self.data_set = odil.DataSet()
+        self.data_set.add("SOPClassUID", [odil.registry.RawDataStorage])
+        self.data_set.add("SOPInstanceUID", ["1.2.3.4"])
+        self.data_set.add("PatientName", ["Foo^Bar"])
+        self.data_set.add("PixelData", [bytearray([1, 2, 3, 4])], odil.VR.OW)
+        odil.write(self.data_set, self.path)
+
+    def tearDown(self):
+        os.remove(self.path)
+
+    def _check(self, path, transfer_syntax):
+        header, data_set = odil.read(path)
+        self.assertSequenceEqual(
+            header.as_string("TransferSyntaxUID"), [transfer_syntax])
+        self.assertEqual(data_set, self.data_set)
+
+    def test_transcode(self):
+        fd, output = tempfile.mkstemp()
+        os.close(fd)
+        try:
+            odil.transcode(
+                self.path, output, odil.registry.ExplicitVRBigEndian_Retired)
+            self._check(output, odil.registry.ExplicitVRBigEndian_Retired)
+        finally:
+            os.remove(output)
+
+    def test_transcode_in_place(self):
+        odil.transcode(
+            self.path, self.path, odil.registry.ExplicitVRBigEndian_Retired)
+        self._check(self.path, odil.registry.ExplicitVRBigEndian_Retired)
+
+    def test_application_in_place(self):
+        transcode.transcode(
+            self.path, self.path, "binary", "ExplicitVRBigEndian_Retired",
+            False)
+        self._check(self.path, odil.registry.ExplicitVRBigEndian_Retired)
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,77 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <boost/python.hpp>
+
+#include "odil/BatchReader.h"
+
+namespace
+{
+
+void start(
+    odil::BatchReader & reader, boost::python::object const & paths_python)
+{
+    std::vector<std::string> paths_cpp(boost::python::len(paths_python));
+    for(int i = 0; i<boost::python::len(paths_python); ++i)
+    {
+        paths_cpp[i] = boost::python::extract<std::string>(paths_python[i]);
+    }
+    reader.start(paths_cpp);
+}
+
+boost::python::tuple next(odil::BatchReader & reader)
+{
+    odil::BatchReader::Result result;
+    if(!reader.next(result))
+    {
+        PyErr_SetNone(PyExc_StopIteration);
+        boost::python::throw_error_already_set();
+    }
+    if(result.error)
+    {
+        std::rethrow_exception(result.error);
+    }
+
+    return boost::python::make_tuple(
+        result.path, result.header, result.data_set);
+}
+
+boost::python::object iter(boost::python::object const & reader)
+{
+    return reader;
+}
+
+}
+
+void wrap_BatchReader()
+{
+    using namespace boost::python;
+
+    // The halt condition and the projection are not wrapped: they would be
+    // called from the reading threads.
+    class_<odil::BatchReader, boost::noncopyable>(
+            "BatchReader",
+            init<unsigned int, bool>(
+                (arg("threads_count")=0, arg("ordered")=false)))
+        .def_readwrite("threads_count", &odil::BatchReader::threads_count)
+        .def_readwrite("queue_size", &odil::BatchReader::queue_size)
+        .def_readwrite("ordered", &odil::BatchReader::ordered)
+        .def_readwrite(
+            "keep_group_length", &odil::BatchReader::keep_group_length)
+        .def("start", start)
+        .def("stop", &odil::BatchReader::stop)
+        // Iterate over (path, header, data set) tuples
+        .def("__iter__", iter)
+        .def("__next__", next)
+        .def("next", next)
+    ;
+}
@@ -88,7 +88,9 @@ void wrap_Reader()
         .def("read_tag", &Reader::read_tag)
         .def("read_length", &Reader::read_length)
         .def(
-            "read_element", &Reader::read_element, (
+            "read_element",
+            static_cast<Element (Reader::*)(Tag const &, DataSet const &) const>(
+                &Reader::read_element), (
                 arg("tag")=Tag(0xffff, 0xffff), arg("data_set")=DataSet()
         ))
         .def(
@@ -88,7 +88,10 @@ void wrap_Writer()
                 arg("stream"), arg("transfer_syntax"),
                 arg("item_encoding")=static_cast<int>(Writer::ItemEncoding::ExplicitLength),
                 arg("use_group_length")=false)))
-        .def("write_data_set", &Writer::write_data_set)
+        .def(
+            "write_data_set",
+            static_cast<void (Writer::*)(DataSet const &) const>(
+                &Writer::write_data_set))
         .def("write_tag", &Writer::write_tag)
         .def("write_element", &Writer::write_element)
         .def(
@@ -14,6 +14,7 @@ void wrap_std_vector();
 void wrap_Association();
 void wrap_AssociationParameters();
 void wrap_BasicDirectoryCreator();
+void wrap_BatchReader();
 void wrap_DataSet();
 void wrap_EchoSCP();
 void wrap_EchoSCU();
@@ -37,6 +38,7 @@ void wrap_SCPDispatcher();
 void wrap_StoreSCU();
 void wrap_StoreSCP();
 void wrap_Tag();
+void wrap_transcode();
 void wrap_uid();
 void wrap_UIDsDictionary();
 void wrap_Value();
@@ -78,6 +80,7 @@ BOOST_PYTHON_MODULE(odil)
     wrap_Association();
     wrap_AssociationParameters();
     wrap_BasicDirectoryCreator();
+    wrap_BatchReader();
     wrap_DataSet();
     wrap_EchoSCP();
     wrap_EchoSCU();
@@ -112,6 +115,7 @@ BOOST_PYTHON_MODULE(odil)
     wrap_registry();
 
     wrap_read();
+    wrap_transcode();
     wrap_write();
 
     wrap_Message();
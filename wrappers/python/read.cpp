@@ -6,7 +6,6 @@
  * for details.
  ************************************************************************/
 
-#include <fstream>
 #include <string>
 
 #include <boost/python.hpp>
@@ -23,12 +22,6 @@ read(
     std::string const & path, bool keep_group_length, 
     boost::python::object const & halt_condition)
 {
-    std::ifstream stream(path);
-    if(!stream)
-    {
-        throw odil::Exception("Could not open "+path);
-    }
-
     std::function<bool(odil::Tag const &)> halt_condition_cpp = 
         [](odil::Tag const &) { return false;};
     if(halt_condition)
@@ -40,8 +33,10 @@ read(
             };
     }
 
+    // Values are copied from the file instead of sharing its memory, so
+    // that scripts may write the data set back to the same file.
     auto const header_and_data_set = odil::Reader::read_file(
-            stream, keep_group_length, halt_condition_cpp);
+            path, keep_group_length, halt_condition_cpp, 0, false);
 
     return boost::python::make_tuple(
         header_and_data_set.first, header_and_data_set.second);
@@ -0,0 +1,40 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include <string>
+
+#include <boost/python.hpp>
+
+#include "odil/Transcoder.h"
+
+namespace
+{
+
+void
+transcode(
+    std::string const & input_path, std::string const & output_path,
+    std::string const & transfer_syntax)
+{
+    // The output may be the input file: don't truncate it before reading it.
+    odil::Transcoder::transcode_file(
+        input_path, output_path, transfer_syntax);
+}
+
+}
+
+void wrap_transcode()
+{
+    using namespace boost::python;
+
+    def(
+        "transcode", transcode,
+        (arg("input"), arg("output"), arg("transfer_syntax")));
+    def(
+        "is_transcodable", &odil::Transcoder::is_supported,
+        arg("transfer_syntax"));
+}